@@ -29,7 +29,7 @@
 import m5
 from m5.objects import *
 from m5.defines import buildEnv
-from m5.util import addToPath
+from m5.util import addToPath, convert
 import os, optparse, sys
 
 addToPath('../')
@@ -135,6 +135,9 @@ for ruby_port in system.ruby._cpu_ports:
      # Tie the cpu test ports to the ruby cpu port
      #
      cpus[i].test = ruby_port.slave
+     # and keep them on the same event queue
+     if options.garnet_tiles > 1:
+         cpus[i].eventq_index = ruby_port.eventq_index
      i += 1
 
 # -----------------------
@@ -147,6 +150,12 @@ root.system.mem_mode = 'timing'
 # Not much point in this being higher than the L1 latency
 m5.ticks.setGlobalFrequency('1ns')
 
+# Tiles run apart by less than the latency of the links between them
+if options.garnet_tiles > 1:
+    root.sim_quantum = max(1, int(options.link_latency *
+                                  convert.anyToLatency(options.ruby_clock) *
+                                  m5.ticks.tps) - 1)
+
 # instantiate configuration
 m5.instantiate()
 
@@ -41,8 +41,8 @@ def define_options(parser):
     parser.add_option("--mesh-rows", type="int", default=0,
                       help="the number of rows in the mesh topology")
     parser.add_option("--network", type="choice", default="simple",
-                      choices=['simple', 'garnet2.0'],
-                      help="'simple'|'garnet2.0'")
+                      choices=['simple', 'garnet2.0', 'analytical'],
+                      help="'simple'|'garnet2.0'|'analytical'")
     parser.add_option("--router-latency", action="store", type="int",
                       default=1,
                       help="""number of pipeline stages in the garnet router.
@@ -50,7 +50,8 @@ def define_options(parser):
                             Can be over-ridden on a per router basis
                             in the topology file.""")
     parser.add_option("--link-latency", action="store", type="int", default=1,
-                      help="""latency of each link the simple/garnet networks.
+                      help="""latency of each link the simple/garnet/analytical
+                            networks.
                             Has to be >= 1.
                             Can be over-ridden on a per link basis
                             in the topology file.""")
@@ -65,7 +66,10 @@ def define_options(parser):
                       help="""routing algorithm in network.
                             0: weight-based table
                             1: XY (for Mesh. see garnet2.0/RoutingUnit.cc)
-                            2: Custom (see garnet2.0/RoutingUnit.cc""")
+                            2: Custom (see garnet2.0/RoutingUnit.cc)
+                            3: West-first adaptive (for Mesh)
+                            4: Odd-even adaptive (for Mesh)
+                            5: Escape VC fully adaptive (for Mesh)""")
     parser.add_option("--network-fault-model", action="store_true",
                       default=False,
                       help="""enable network fault model:
@@ -73,6 +77,26 @@ def define_options(parser):
     parser.add_option("--garnet-deadlock-threshold", action="store",
                       type="int", default=50000,
                       help="network-level deadlock threshold.")
+    parser.add_option("--garnet-tiles", action="store", type="int",
+                      default=1,
+                      help="""number of tiles the garnet2.0 routers, network
+                            interfaces and their controllers are split into,
+                            each simulated on its own event queue.
+                            Meshes are cut into bands of rows.""")
+    parser.add_option("--garnet-trace-capture", action="store", type="string",
+                      default="",
+                      help="""file in the output directory to capture the
+                            packets injected into garnet2.0 to.""")
+    parser.add_option("--garnet-trace-replay", action="store", type="string",
+                      default="",
+                      help="""garnet2.0 network trace to replay instead of
+                            the traffic of the controllers, which are
+                            still simulated.""")
+    parser.add_option("--garnet-power-table", action="store", type="string",
+                      default="",
+                      help="""per-event energy table written by
+                            util/garnet-power-table.py, reports the power
+                            of garnet2.0 with the stats.""")
 
 
 def create_network(options, ruby):
@@ -85,6 +109,13 @@ def create_network(options, ruby):
         RouterClass = GarnetRouter
         InterfaceClass = GarnetNetworkInterface
 
+    elif options.network == "analytical":
+        NetworkClass = AnalyticalNetwork
+        IntLinkClass = BasicIntLink
+        ExtLinkClass = BasicExtLink
+        RouterClass = BasicRouter
+        InterfaceClass = None
+
     else:
         NetworkClass = SimpleNetwork
         IntLinkClass = SimpleIntLink
@@ -107,6 +138,9 @@ def init_network(options, network, InterfaceClass):
         network.ni_flit_size = options.link_width_bits / 8
         network.routing_algorithm = options.routing_algorithm
         network.garnet_deadlock_threshold = options.garnet_deadlock_threshold
+        network.trace_capture = options.garnet_trace_capture
+        network.trace_replay = options.garnet_trace_replay
+        network.power_table = options.garnet_power_table
 
     if options.network == "simple":
         network.setup_buffers()
@@ -116,7 +150,43 @@ def init_network(options, network, InterfaceClass):
                   for (i,n) in enumerate(network.ext_links)]
         network.netifs = netifs
 
+    if options.network == "garnet2.0" and options.garnet_tiles > 1:
+        partition_network(options, network)
+
     if options.network_fault_model:
         assert(options.network == "garnet2.0")
         network.enable_fault_model = True
         network.fault_model = FaultModel()
+
+def partition_network(options, network):
+    tiles = options.garnet_tiles
+    num_routers = len(network.routers)
+
+    if options.mesh_rows > 0:
+        if tiles > options.mesh_rows:
+            fatal("Cannot split a mesh of %d rows into %d tiles" % \
+                  (options.mesh_rows, tiles))
+        num_cols = num_routers / options.mesh_rows
+        tile = lambda router: \
+            (router.router_id / num_cols) * tiles / options.mesh_rows
+    else:
+        tile = lambda router: router.router_id * tiles / num_routers
+
+    for router in network.routers:
+        router.eventq_index = tile(router)
+
+    # A link runs on the tile of the unit feeding it, i.e., the source
+    # router for flits and the destination router for credits. Links
+    # between tiles need a latency longer than the simulation quantum.
+    for link in network.int_links:
+        link.network_link.eventq_index = tile(link.src_node)
+        link.credit_link.eventq_index = tile(link.dst_node)
+
+    # Network interfaces, their links and controllers go with the router
+    # they are attached to
+    for (i, link) in enumerate(network.ext_links):
+        link.eventq_index = tile(link.int_node)
+        network.netifs[i].eventq_index = link.eventq_index
+        link.ext_node.eventq_index = link.eventq_index
+        if hasattr(link.ext_node, 'sequencer'):
+            link.ext_node.sequencer.eventq_index = link.eventq_index
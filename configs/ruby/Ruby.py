@@ -76,6 +76,12 @@ def define_options(parser):
     parser.add_option("--recycle-latency", type="int", default=10,
                       help="Recycle latency for ruby controller input buffers")
 
+    parser.add_option("--ruby-hot-lines", action="store_true", default=False,
+                      help="Profile the hottest blocks, PCs and sharer "
+                           "patterns, dumped with the stats")
+    parser.add_option("--ruby-hot-lines-entries", type="int", default=100,
+                      help="Number of hottest entries profiled")
+
     protocol = buildEnv['PROTOCOL']
     exec "import %s" % protocol
     eval("%s.define_options(parser)" % protocol)
@@ -149,6 +155,8 @@ def create_system(options, full_system, system, piobus = None, dma_ports = []):
 
     system.ruby = RubySystem()
     ruby = system.ruby
+    ruby.hot_lines = options.ruby_hot_lines
+    ruby.hot_lines_entries = options.ruby_hot_lines_entries
 
     # Create the network object
     (network, IntLinkClass, ExtLinkClass, RouterClass, InterfaceClass) = \
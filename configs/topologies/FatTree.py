@@ -0,0 +1,104 @@
+# Copyright (c) 2026 agent
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# Authors: agent
+
+from m5.params import *
+from m5.objects import *
+
+from math import sqrt
+
+from BaseTopology import SimpleTopology
+
+# Creates a two level fat tree (a folded Clos network). There is one leaf
+# router per cpu, with the controllers distributed over the leaves as in
+# Mesh_XY, and roughly sqrt(leaves) spine routers. Every leaf connects to
+# every spine, so there are as many minimal paths between two leaves as
+# there are spines.
+
+class FatTree(SimpleTopology):
+    description='FatTree'
+
+    def __init__(self, controllers):
+        self.nodes = controllers
+
+    def makeTopology(self, options, network, IntLink, ExtLink, Router):
+        nodes = self.nodes
+
+        num_leaves = options.num_cpus
+        num_spines = max(1, int(sqrt(num_leaves)))
+
+        link_latency = options.link_latency # used by simple and garnet
+        router_latency = options.router_latency # only used by garnet
+
+        cntrls_per_router, remainder = divmod(len(nodes), num_leaves)
+
+        # Leaves are routers [0, num_leaves), the spines follow
+        routers = [Router(router_id=i, latency = router_latency) \
+            for i in range(num_leaves + num_spines)]
+        network.routers = routers
+
+        leaves = routers[:num_leaves]
+        spines = routers[num_leaves:]
+
+        # link counter to set unique link ids
+        link_count = 0
+
+        # Connect the controllers to the leaves, the remainder (DMA) nodes
+        # to leaf 0
+        ext_links = []
+        for (i, n) in enumerate(nodes):
+            if i < len(nodes) - remainder:
+                cntrl_level, router_id = divmod(i, num_leaves)
+                assert(cntrl_level < cntrls_per_router)
+            else:
+                assert(n.type == 'DMA_Controller')
+                router_id = 0
+            ext_links.append(ExtLink(link_id=link_count, ext_node=n,
+                                    int_node=leaves[router_id],
+                                    latency = link_latency))
+            link_count += 1
+
+        network.ext_links = ext_links
+
+        # Up and down links between every leaf and every spine
+        int_links = []
+        for leaf in leaves:
+            for spine in spines:
+                int_links.append(IntLink(link_id=link_count,
+                                         src_node=leaf,
+                                         dst_node=spine,
+                                         latency = link_latency,
+                                         weight=1))
+                link_count += 1
+                int_links.append(IntLink(link_id=link_count,
+                                         src_node=spine,
+                                         dst_node=leaf,
+                                         latency = link_latency,
+                                         weight=1))
+                link_count += 1
+
+        network.int_links = int_links
@@ -31,6 +31,8 @@
 #ifndef __BASE_REFCNT_HH__
 #define __BASE_REFCNT_HH__
 
+#include <utility>
+
 /**
  * @file base/refcnt.hh
  *
@@ -163,6 +165,15 @@ class RefCountingPtr
     /// one.  Adds a reference.
     RefCountingPtr(const RefCountingPtr &r) { copy(r.data); }
 
+    /// Create a new reference counting pointer by copying one to a
+    /// derived class.  Adds a reference.
+    template <class U>
+    RefCountingPtr(const RefCountingPtr<U> &r) { copy(r.get()); }
+
+    /// Take over the reference held by another pointer without
+    /// touching the reference count.
+    RefCountingPtr(RefCountingPtr &&r) : data(r.data) { r.data = 0; }
+
     /// Destroy the pointer and any reference it may hold.
     ~RefCountingPtr() { del(); }
 
@@ -186,6 +197,11 @@ class RefCountingPtr
     const RefCountingPtr &operator=(const RefCountingPtr &r)
     { return operator=(r.data); }
 
+    /// Take over the reference held by another RefCountingPtr, the
+    /// reference previously held is dropped when r goes away
+    const RefCountingPtr &operator=(RefCountingPtr &&r)
+    { std::swap(data, r.data); return *this; }
+
     /// Check if the pointer is empty
     bool operator!() const { return data == 0; }
 
@@ -345,6 +345,11 @@ KvmVM::delayedStartup()
     const std::vector<BackingStoreEntry> &memories(
         system->getPhysMem().getBackingStore());
 
+    // The guest writes the backing store without the memories marking
+    // the pages it dirties, so a delta checkpoint would miss them
+    fatal_if(system->getPhysMem().isStoreDelta(),
+             "Delta checkpoints (store_delta) are not supported with KVM\n");
+
     DPRINTF(Kvm, "Mapping %i memory region(s)\n", memories.size());
     for (int slot(0); slot < memories.size(); ++slot) {
         if (!memories[slot].kvmMap) {
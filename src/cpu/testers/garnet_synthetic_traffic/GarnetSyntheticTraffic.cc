@@ -36,6 +36,7 @@
 #include <string>
 #include <vector>
 
+#include "base/intmath.hh"
 #include "base/misc.hh"
 #include "base/random.hh"
 #include "base/statistics.hh"
@@ -105,6 +106,7 @@ GarnetSyntheticTraffic::GarnetSyntheticTraffic(const Params *p)
     traffic = trafficStringToEnum[trafficType];
 
     id = TESTER_NETWORK++;
+    rng.init(random_mt.random<uint32_t>());
     DPRINTF(GarnetSyntheticTraffic,"Config Created: Name = %s , and id = %d\n",
             name(), id);
 }
@@ -122,6 +124,18 @@ void
 GarnetSyntheticTraffic::init()
 {
     numPacketsSent = 0;
+
+    // All testers stop at the first clock edge at or after simCycles.
+    // The exit is requested up front, as a request made while running
+    // only takes effect a simulation quantum later.
+    if (id == 0) {
+        Tick exit_tick = divCeil(simCycles, clockPeriod()) * clockPeriod();
+        fatal_if(exit_tick < simQuantum,
+                 "%s: sim_cycles %d is shorter than the simulation "
+                 "quantum %d\n", name(), simCycles, simQuantum);
+        exitSimLoop("Network Tester completed simCycles", 0,
+                    exit_tick - simQuantum);
+    }
 }
 
 
@@ -155,7 +169,7 @@ GarnetSyntheticTraffic::tick()
     // - send pkt if this number is < injRate*(10^precision)
     bool sendAllowedThisCycle;
     double injRange = pow((double) 10, (double) precision);
-    unsigned trySending = random_mt.random<unsigned>(0, (int) injRange);
+    unsigned trySending = rng.random<unsigned>(0, (int) injRange);
     if (trySending < injRate*injRange)
         sendAllowedThisCycle = true;
     else
@@ -175,13 +189,9 @@ GarnetSyntheticTraffic::tick()
             generatePkt();
     }
 
-    // Schedule wakeup
-    if (curTick() >= simCycles)
-        exitSimLoop("Network Tester completed simCycles");
-    else {
-        if (!tickEvent.scheduled())
-            schedule(tickEvent, clockEdge(Cycles(1)));
-    }
+    // Schedule wakeup, the simulation ends at simCycles (see init())
+    if (curTick() < simCycles && !tickEvent.scheduled())
+        schedule(tickEvent, clockEdge(Cycles(1)));
 }
 
 void
@@ -200,7 +210,7 @@ GarnetSyntheticTraffic::generatePkt()
     {
         destination = singleDest;
     } else if (traffic == UNIFORM_RANDOM_) {
-        destination = random_mt.random<unsigned>(0, num_destinations - 1);
+        destination = rng.random<unsigned>(0, num_destinations - 1);
     } else if (traffic == BIT_COMPLEMENT_) {
         dest_x = radix - src_x - 1;
         dest_y = radix - src_y - 1;
@@ -289,7 +299,7 @@ GarnetSyntheticTraffic::generatePkt()
     if (injReqType < 0 || injReqType > 2)
     {
         // randomly inject in any vnet
-        injReqType = random_mt.random(0, 2);
+        injReqType = rng.random(0, 2);
     }
 
     if (injReqType == 0) {
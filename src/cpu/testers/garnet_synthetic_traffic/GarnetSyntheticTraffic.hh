@@ -33,6 +33,7 @@
 
 #include <set>
 
+#include "base/random.hh"
 #include "base/statistics.hh"
 #include "mem/mem_object.hh"
 #include "mem/port.hh"
@@ -148,6 +149,10 @@ class GarnetSyntheticTraffic : public MemObject
 
     MasterID masterId;
 
+    // Traffic is drawn from a generator private to this tester, so that
+    // testers on different event queues do not share random_mt
+    Random rng;
+
     void completeRequest(PacketPtr pkt);
 
     void generatePkt();
@@ -100,3 +100,27 @@ class CommMonitor(MemObject):
     read_addr_mask = Param.Addr(MaxAddr, "Address mask for read address")
     write_addr_mask = Param.Addr(MaxAddr, "Address mask for write address")
     disable_addr_dists = Param.Bool(True, "Disable address distributions")
+
+    # to reduce the overhead, only a sample of the read and write
+    # transactions can be recorded in the histograms, latencies and
+    # trace, either one in every N transactions, or the transactions
+    # in a window at the start of each sample period, or both; the
+    # transaction, bandwidth and outstanding request counts always
+    # include all transactions
+    sample_interval = Param.Unsigned(1, "Sample one in every N transactions")
+    sample_window = Param.Latency('0ns', "Only sample in a window at the " \
+                                      "start of each sample period, 0 for " \
+                                      "the whole period")
+
+    # request-to-response latencies are tracked in a fixed-size ring
+    # of outstanding sampled requests, where the oldest is evicted
+    # when the ring wraps around
+    latency_table_size = Param.Unsigned(1024, "Entries in the latency " \
+                                            "table, power of two")
+
+    # optionally stream the sampled transactions as fixed-size binary
+    # records to a ring buffer in a file, keeping the most recent ones
+    # (see util/decode_monitor_trace.py)
+    trace_file = Param.String("", "Ring buffer file for transactions, " \
+                                  "empty to disable")
+    trace_records = Param.Unsigned(1 << 20, "Records in the ring buffer")
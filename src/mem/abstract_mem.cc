@@ -57,6 +57,7 @@ using namespace std;
 
 AbstractMemory::AbstractMemory(const Params *p) :
     MemObject(p), range(params()->range), pmemAddr(NULL),
+    dirtyMap(NULL), dirtyPageShift(0),
     confTableReported(p->conf_table_reported), inAddrMap(p->in_addr_map),
     kvmMap(p->kvm_map), _system(NULL)
 {
@@ -348,6 +349,7 @@ AbstractMemory::access(PacketPtr pkt)
             if (pmemAddr) {
                 memcpy(pkt->getPtr<uint8_t>(), hostAddr, pkt->getSize());
                 (*(pkt->getAtomicOp()))(hostAddr);
+                markDirty(pkt);
             }
         } else {
             std::vector<uint8_t> overwrite_val(pkt->getSize());
@@ -377,8 +379,10 @@ AbstractMemory::access(PacketPtr pkt)
                     panic("Invalid size for conditional read/write\n");
             }
 
-            if (overwrite_mem)
+            if (overwrite_mem) {
                 std::memcpy(hostAddr, &overwrite_val[0], pkt->getSize());
+                markDirty(pkt);
+            }
 
             assert(!pkt->req->isInstFetch());
             TRACE_PACKET("Read/Write");
@@ -407,6 +411,7 @@ AbstractMemory::access(PacketPtr pkt)
         if (writeOK(pkt)) {
             if (pmemAddr) {
                 memcpy(hostAddr, pkt->getConstPtr<uint8_t>(), pkt->getSize());
+                markDirty(pkt);
                 DPRINTF(MemoryAccess, "%s wrote %i bytes to address %x\n",
                         __func__, pkt->getSize(), pkt->getAddr());
             }
@@ -438,8 +443,10 @@ AbstractMemory::functionalAccess(PacketPtr pkt)
         TRACE_PACKET("Read");
         pkt->makeResponse();
     } else if (pkt->isWrite()) {
-        if (pmemAddr)
+        if (pmemAddr) {
             memcpy(hostAddr, pkt->getConstPtr<uint8_t>(), pkt->getSize());
+            markDirty(pkt);
+        }
         TRACE_PACKET("Write");
         pkt->makeResponse();
     } else if (pkt->isPrint()) {
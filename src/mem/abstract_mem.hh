@@ -110,6 +110,24 @@ class AbstractMemory : public MemObject
     // Pointer to host memory used to implement this memory
     uint8_t* pmemAddr;
 
+    // Byte per host page of the backing store marking the pages
+    // written since the last checkpoint, or NULL if not tracked
+    uint8_t* dirtyMap;
+
+    // Log2 of the page size used by the dirty map
+    unsigned dirtyPageShift;
+
+    // Mark the pages written by a packet as dirty, if we are
+    // tracking dirty pages
+    void markDirty(PacketPtr pkt) {
+        if (dirtyMap) {
+            Addr offset = pkt->getAddr() - range.start();
+            Addr last = (offset + pkt->getSize() - 1) >> dirtyPageShift;
+            for (Addr p = offset >> dirtyPageShift; p <= last; ++p)
+                dirtyMap[p] = 1;
+        }
+    }
+
     // Enable specific memories to be reported to the configuration table
     const bool confTableReported;
 
@@ -218,6 +236,20 @@ class AbstractMemory : public MemObject
      */
     void setBackingStore(uint8_t* pmem_addr);
 
+    /**
+     * Set the map used to track pages written since the last
+     * checkpoint. The map covers the whole backing store, and is
+     * indexed by page offset from the start of the backing store.
+     *
+     * @param dirty_map Byte per page of the backing store, or NULL
+     * @param page_shift Log2 of the page size of the map
+     */
+    void setDirtyMap(uint8_t* dirty_map, unsigned page_shift)
+    {
+        dirtyMap = dirty_map;
+        dirtyPageShift = page_shift;
+    }
+
     /**
      * Get the list of locked addresses to allow checkpointing.
      */
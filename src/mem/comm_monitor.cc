@@ -40,6 +40,13 @@
 
 #include "mem/comm_monitor.hh"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include "base/intmath.hh"
 #include "base/trace.hh"
 #include "debug/CommMonitor.hh"
 #include "sim/stats.hh"
@@ -53,11 +60,63 @@ CommMonitor::CommMonitor(Params* params)
       samplePeriod(params->sample_period / SimClock::Float::s),
       readAddrMask(params->read_addr_mask),
       writeAddrMask(params->write_addr_mask),
+      sampleInterval(params->sample_interval),
+      sampleWindowTicks(params->sample_window),
+      transSinceSample(0), periodStart(0),
+      latencyTable(params->latency_table_size, LatencyEntry{0, 0}),
+      latencySeq(0),
+      traceHeader(nullptr), traceRecords(nullptr), traceMapSize(0),
       stats(params)
 {
     DPRINTF(CommMonitor,
             "Created monitor %s with sample period %d ticks (%f ms)\n",
             name(), samplePeriodTicks, samplePeriod * 1E3);
+
+    fatal_if(sampleInterval == 0, "%s: sample interval must be non-zero\n",
+             name());
+    fatal_if(sampleWindowTicks > samplePeriodTicks,
+             "%s: sample window is longer than the sample period\n",
+             name());
+    fatal_if(!isPowerOf2(latencyTable.size()),
+             "%s: latency table size must be a power of two\n", name());
+
+    // map the trace ring buffer once and for all, so that recording a
+    // transaction is nothing more than a store to memory
+    if (!params->trace_file.empty()) {
+        const uint32_t capacity = params->trace_records;
+        fatal_if(capacity == 0, "%s: trace ring buffer is empty\n", name());
+
+        traceMapSize = sizeof(TraceHeader) +
+            (size_t)capacity * sizeof(TraceRecord);
+        int fd = open(params->trace_file.c_str(),
+                      O_CREAT | O_TRUNC | O_RDWR, 0664);
+        if (fd == -1 || ftruncate(fd, traceMapSize))
+            fatal("%s: can't create trace file '%s'\n", name(),
+                  params->trace_file);
+
+        void* trace = mmap(NULL, traceMapSize, PROT_READ | PROT_WRITE,
+                           MAP_SHARED, fd, 0);
+        close(fd);
+        if (trace == MAP_FAILED)
+            fatal("%s: can't map trace file '%s'\n", name(),
+                  params->trace_file);
+
+        traceHeader = static_cast<TraceHeader*>(trace);
+        traceRecords = reinterpret_cast<TraceRecord*>(traceHeader + 1);
+        memcpy(traceHeader->magic, "gem5cmr1", sizeof(traceHeader->magic));
+        traceHeader->recordSize = sizeof(TraceRecord);
+        traceHeader->capacity = capacity;
+        traceHeader->written = 0;
+    }
+}
+
+CommMonitor::~CommMonitor()
+{
+    if (traceHeader)
+        munmap(traceHeader, traceMapSize);
+
+    for (auto state : senderStateFreeList)
+        delete state;
 }
 
 CommMonitor*
@@ -144,30 +203,52 @@ CommMonitor::recvTimingReq(PacketPtr pkt)
 
     const bool is_read = pkt->isRead();
     const bool is_write = pkt->isWrite();
-    const bool expects_response(
-        pkt->needsResponse() && !pkt->cacheResponding());
+    const MasterID master_id = pkt->req->masterId();
 
     // If a cache miss is served by a cache, a monitor near the memory
     // would see a request which needs a response, but this response
     // would not come back from the memory. Therefore we additionally
     // have to check the cacheResponding flag
+    const bool expects_response(
+        pkt->needsResponse() && !pkt->cacheResponding());
+
+    CommMonitorSenderState* state = nullptr;
     if (expects_response && !stats.disableLatencyHists) {
-        pkt->pushSenderState(new CommMonitorSenderState(curTick()));
+        state = allocSenderState();
+        pkt->pushSenderState(state);
     }
 
     // Attempt to send the packet
     bool successful = masterPort.sendTimingReq(pkt);
 
-    // If not successful, restore the sender state
-    if (!successful && expects_response && !stats.disableLatencyHists) {
-        delete pkt->popSenderState();
+    if (!successful) {
+        if (state) {
+            pkt->popSenderState();
+            freeSenderState(state);
+        }
+        return false;
+    }
+
+    ppPktReq->notify(pkt_info);
+
+    if (!is_read && !is_write) {
+        DPRINTF(CommMonitor, "Forwarded non read/write request\n");
+        return true;
     }
 
-    if (successful) {
-        ppPktReq->notify(pkt_info);
+    // the counters are cheap and always updated, the rest only for
+    // the sampled transactions
+    const bool sampled = sampleTransaction();
+
+    if (sampled && state) {
+        state->seq = ++latencySeq;
+        insertLatency(state->seq);
     }
 
-    if (successful && is_read) {
+    if (sampled)
+        traceTransaction(pkt_info, master_id, 0, false);
+
+    if (is_read) {
         DPRINTF(CommMonitor, "Forwarded read request\n");
 
         // Increment number of observed read transactions
@@ -176,12 +257,12 @@ CommMonitor::recvTimingReq(PacketPtr pkt)
         }
 
         // Get sample of burst length
-        if (!stats.disableBurstLengthHists) {
+        if (sampled && !stats.disableBurstLengthHists) {
             stats.readBurstLengthHist.sample(pkt_info.size);
         }
 
         // Sample the masked address
-        if (!stats.disableAddrDists) {
+        if (sampled && !stats.disableAddrDists) {
             stats.readAddrDist.sample(pkt_info.addr & readAddrMask);
         }
 
@@ -192,19 +273,21 @@ CommMonitor::recvTimingReq(PacketPtr pkt)
         }
 
         if (!stats.disableITTDists) {
-            // Sample value of read-read inter transaction time
-            if (stats.timeOfLastRead != 0) {
+            // Sample value of read-read inter transaction time, the
+            // time of the last transaction is tracked for all
+            // transactions to keep the sampled values accurate
+            if (sampled && stats.timeOfLastRead != 0) {
                 stats.ittReadRead.sample(curTick() - stats.timeOfLastRead);
             }
             stats.timeOfLastRead = curTick();
 
             // Sample value of req-req inter transaction time
-            if (stats.timeOfLastReq != 0) {
+            if (sampled && stats.timeOfLastReq != 0) {
                 stats.ittReqReq.sample(curTick() - stats.timeOfLastReq);
             }
             stats.timeOfLastReq = curTick();
         }
-    } else if (successful && is_write) {
+    } else {
         DPRINTF(CommMonitor, "Forwarded write request\n");
 
         // Same as for reads
@@ -212,7 +295,7 @@ CommMonitor::recvTimingReq(PacketPtr pkt)
             ++stats.writeTrans;
         }
 
-        if (!stats.disableBurstLengthHists) {
+        if (sampled && !stats.disableBurstLengthHists) {
             stats.writeBurstLengthHist.sample(pkt_info.size);
         }
 
@@ -223,7 +306,7 @@ CommMonitor::recvTimingReq(PacketPtr pkt)
         }
 
         // Sample the masked write address
-        if (!stats.disableAddrDists) {
+        if (sampled && !stats.disableAddrDists) {
             stats.writeAddrDist.sample(pkt_info.addr & writeAddrMask);
         }
 
@@ -233,22 +316,20 @@ CommMonitor::recvTimingReq(PacketPtr pkt)
 
         if (!stats.disableITTDists) {
             // Sample value of write-to-write inter transaction time
-            if (stats.timeOfLastWrite != 0) {
+            if (sampled && stats.timeOfLastWrite != 0) {
                 stats.ittWriteWrite.sample(curTick() - stats.timeOfLastWrite);
             }
             stats.timeOfLastWrite = curTick();
 
             // Sample value of req-to-req inter transaction time
-            if (stats.timeOfLastReq != 0) {
+            if (sampled && stats.timeOfLastReq != 0) {
                 stats.ittReqReq.sample(curTick() - stats.timeOfLastReq);
             }
             stats.timeOfLastReq = curTick();
         }
-    } else if (successful) {
-        DPRINTF(CommMonitor, "Forwarded non read/write request\n");
     }
 
-    return successful;
+    return true;
 }
 
 bool
@@ -263,41 +344,48 @@ CommMonitor::recvTimingResp(PacketPtr pkt)
 
     bool is_read = pkt->isRead();
     bool is_write = pkt->isWrite();
-    Tick latency = 0;
-    CommMonitorSenderState* received_state =
-        dynamic_cast<CommMonitorSenderState*>(pkt->senderState);
+    const MasterID master_id = pkt->req->masterId();
 
+    CommMonitorSenderState* received_state = nullptr;
     if (!stats.disableLatencyHists) {
+        received_state =
+            dynamic_cast<CommMonitorSenderState*>(pkt->senderState);
+
         // Restore initial sender state
-        if (received_state == NULL)
+        if (received_state == nullptr)
             panic("Monitor got a response without monitor sender state\n");
 
-        // Restore the sate
         pkt->senderState = received_state->predecessor;
     }
 
     // Attempt to send the packet
     bool successful = slavePort.sendTimingResp(pkt);
 
-    if (!stats.disableLatencyHists) {
-        // If packet successfully send, sample value of latency,
-        // afterwards delete sender state, otherwise restore state
-        if (successful) {
-            latency = curTick() - received_state->transmitTime;
-            DPRINTF(CommMonitor, "Latency: %d\n", latency);
-            delete received_state;
-        } else {
-            // Don't delete anything and let the packet look like we
-            // did not touch it
+    if (!successful) {
+        // If packet successfully send, sender state would have been
+        // deleted, so only restore it here
+        if (received_state)
             pkt->senderState = received_state;
-        }
+        return false;
     }
 
-    if (successful) {
-        ppPktResp->notify(pkt_info);
+    ppPktResp->notify(pkt_info);
+
+    // only the sampled requests are in the latency table
+    Tick transmit_time;
+    const bool sampled = received_state && received_state->seq != 0 &&
+        removeLatency(received_state->seq, transmit_time);
+    const Tick latency = sampled ? curTick() - transmit_time : 0;
+
+    if (received_state)
+        freeSenderState(received_state);
+
+    if (sampled) {
+        DPRINTF(CommMonitor, "Latency: %d\n", latency);
+        traceTransaction(pkt_info, master_id, latency, true);
     }
 
-    if (successful && is_read) {
+    if (is_read) {
         // Decrement number of outstanding read requests
         DPRINTF(CommMonitor, "Received read response\n");
         if (!stats.disableOutstandingHists) {
@@ -305,7 +393,7 @@ CommMonitor::recvTimingResp(PacketPtr pkt)
             --stats.outstandingReadReqs;
         }
 
-        if (!stats.disableLatencyHists) {
+        if (sampled) {
             stats.readLatencyHist.sample(latency);
         }
 
@@ -315,7 +403,7 @@ CommMonitor::recvTimingResp(PacketPtr pkt)
             stats.totalReadBytes += pkt_info.size;
         }
 
-    } else if (successful && is_write) {
+    } else if (is_write) {
         // Decrement number of outstanding write requests
         DPRINTF(CommMonitor, "Received write response\n");
         if (!stats.disableOutstandingHists) {
@@ -323,13 +411,90 @@ CommMonitor::recvTimingResp(PacketPtr pkt)
             --stats.outstandingWriteReqs;
         }
 
-        if (!stats.disableLatencyHists) {
+        if (sampled) {
             stats.writeLatencyHist.sample(latency);
         }
-    } else if (successful) {
+    } else {
         DPRINTF(CommMonitor, "Received non read/write response\n");
     }
-    return successful;
+    return true;
+}
+
+bool
+CommMonitor::sampleTransaction()
+{
+    if (sampleWindowTicks != 0 && curTick() - periodStart >= sampleWindowTicks)
+        return false;
+
+    if (++transSinceSample < sampleInterval)
+        return false;
+
+    transSinceSample = 0;
+    ++stats.sampledTrans;
+    return true;
+}
+
+void
+CommMonitor::insertLatency(uint64_t seq)
+{
+    LatencyEntry& entry = latencyTable[seq & (latencyTable.size() - 1)];
+
+    // the request a full table ago is still outstanding, give up on
+    // it rather than letting stale entries build up
+    if (entry.seq != 0)
+        ++stats.latencyTableFull;
+
+    entry.seq = seq;
+    entry.transmitTime = curTick();
+}
+
+bool
+CommMonitor::removeLatency(uint64_t seq, Tick &transmit_time)
+{
+    LatencyEntry& entry = latencyTable[seq & (latencyTable.size() - 1)];
+    if (entry.seq != seq)
+        return false;
+
+    transmit_time = entry.transmitTime;
+    entry.seq = 0;
+    return true;
+}
+
+CommMonitor::CommMonitorSenderState*
+CommMonitor::allocSenderState()
+{
+    if (senderStateFreeList.empty())
+        return new CommMonitorSenderState();
+
+    CommMonitorSenderState* state = senderStateFreeList.back();
+    senderStateFreeList.pop_back();
+    state->seq = 0;
+    return state;
+}
+
+void
+CommMonitor::freeSenderState(CommMonitorSenderState* state)
+{
+    senderStateFreeList.push_back(state);
+}
+
+void
+CommMonitor::traceTransaction(const ProbePoints::PacketInfo& pkt_info,
+                              MasterID master_id, Tick latency,
+                              bool is_response)
+{
+    if (!traceHeader)
+        return;
+
+    TraceRecord& r =
+        traceRecords[traceHeader->written++ % traceHeader->capacity];
+    r.tick = curTick();
+    r.addr = pkt_info.addr;
+    r.latency = latency;
+    r.size = pkt_info.size;
+    r.masterId = master_id;
+    r.cmd = pkt_info.cmd.toInt();
+    r.isResponse = is_response;
 }
 
 void
@@ -508,6 +673,16 @@ CommMonitor::regStats()
         .name(name() + ".writeAddrDist")
         .desc("Write address distribution")
         .flags(stats.disableAddrDists ? nozero : pdf);
+
+    stats.sampledTrans
+        .name(name() + ".sampledTrans")
+        .desc("Number of read and write transactions sampled");
+
+    stats.latencyTableFull
+        .name(name() + ".latencyTableFull")
+        .desc("Number of sampled transactions evicted from the latency "
+              "table before their response")
+        .flags(nozero);
 }
 
 void
@@ -545,11 +720,13 @@ CommMonitor::samplePeriodic()
     stats.readBytes = 0;
     stats.writtenBytes = 0;
 
+    periodStart = curTick();
     schedule(samplePeriodicEvent, curTick() + samplePeriodTicks);
 }
 
 void
 CommMonitor::startup()
 {
+    periodStart = curTick();
     schedule(samplePeriodicEvent, curTick() + samplePeriodTicks);
 }
@@ -56,6 +56,15 @@
  * (read-read, write-write, read/write-read/write). Furthermore it allows
  * to capture the number of accesses to an address over time ("heat map").
  * All stats can be disabled from Python.
+ *
+ * To keep the overhead low enough for the monitor to always be
+ * enabled, the histograms can be limited to a sample of the
+ * transactions, either one in every N transactions, or the
+ * transactions in a window at the start of each sample period. The
+ * latencies are tracked in a fixed-size table rather than by
+ * annotating the packets, and the sampled transactions can also be
+ * streamed as fixed-size binary records to a ring buffer in a file,
+ * for offline analysis.
  */
 class CommMonitor : public MemObject
 {
@@ -74,6 +83,9 @@ class CommMonitor : public MemObject
      */
     CommMonitor(Params* params);
 
+    /** Unmap the trace ring buffer, if any */
+    ~CommMonitor();
+
     void init() override;
     void regStats() override;
     void startup() override;
@@ -89,30 +101,64 @@ class CommMonitor : public MemObject
   private:
 
     /**
-     * Sender state class for the monitor so that we can annotate
-     * packets with a transmit time and receive time.
+     * Sender state pushed on every request that expects a response,
+     * so that the response can be matched up with its request. The
+     * sequence number identifies a sampled transaction in the
+     * latency table, and is 0 for the transactions not sampled. The
+     * states are recycled by the monitor rather than freed.
      */
     class CommMonitorSenderState : public Packet::SenderState
     {
-
       public:
+        CommMonitorSenderState() : seq(0) { }
 
-        /**
-         * Construct a new sender state and store the time so we can
-         * calculate round-trip latency.
-         *
-         * @param _transmitTime Time of packet transmission
-         */
-        CommMonitorSenderState(Tick _transmitTime)
-            : transmitTime(_transmitTime)
-        { }
-
-        /** Destructor */
-        ~CommMonitorSenderState() { }
+        uint64_t seq;
+    };
 
-        /** Tick when request is transmitted */
+    /**
+     * Entry in the table of outstanding sampled requests, used to
+     * calculate the round-trip latency. A sequence number of 0 marks
+     * an invalid entry.
+     */
+    struct LatencyEntry
+    {
+        uint64_t seq;
         Tick transmitTime;
+    };
 
+    /**
+     * Fixed-size binary record describing a monitored transaction,
+     * as written to the trace ring buffer.
+     */
+    struct TraceRecord
+    {
+        /** Tick when the packet was forwarded */
+        uint64_t tick;
+        /** Address of the packet */
+        uint64_t addr;
+        /** Request-to-response latency, 0 for requests */
+        uint64_t latency;
+        /** Size of the packet in bytes */
+        uint32_t size;
+        /** Master id of the request */
+        uint16_t masterId;
+        /** Command of the packet */
+        uint8_t cmd;
+        /** Set for responses */
+        uint8_t isResponse;
+    };
+
+    /**
+     * Header of the trace ring buffer file. The header is followed by
+     * the records, and the total number of records ever written
+     * determines the position of the next one.
+     */
+    struct TraceHeader
+    {
+        char magic[8];
+        uint32_t recordSize;
+        uint32_t capacity;
+        uint64_t written;
     };
 
     /**
@@ -357,6 +403,16 @@ class CommMonitor : public MemObject
         /** Disable flag for address distributions. */
         bool disableAddrDists;
 
+        /** Number of transactions sampled */
+        Stats::Scalar sampledTrans;
+
+        /**
+         * Number of sampled transactions without a latency sample
+         * due to being evicted from the latency table before their
+         * response arrived
+         */
+        Stats::Scalar latencyTableFull;
+
         /**
          * Histogram of number of read accesses to addresses over
          * time.
@@ -390,6 +446,46 @@ class CommMonitor : public MemObject
 
     };
 
+    /**
+     * Decide if the transaction of a request is to be sampled. All
+     * transactions update the cheap counters, but only the sampled
+     * ones are recorded in the histograms, the latency table and the
+     * trace.
+     *
+     * @return true if the transaction is to be sampled
+     */
+    bool sampleTransaction();
+
+    /**
+     * Record the transmit time of a sampled request, evicting the
+     * oldest outstanding one if its slot is still in use.
+     *
+     * @param seq Sequence number identifying the transaction
+     */
+    void insertLatency(uint64_t seq);
+
+    /**
+     * Look up and invalidate the transmit time of a request.
+     *
+     * @param seq Sequence number identifying the transaction
+     * @param transmit_time Returns the transmit time if found
+     * @return true if the request was still in the table
+     */
+    bool removeLatency(uint64_t seq, Tick &transmit_time);
+
+    /** Get a sender state from the free list, or a new one */
+    CommMonitorSenderState* allocSenderState();
+
+    /** Return a sender state to the free list */
+    void freeSenderState(CommMonitorSenderState* state);
+
+    /**
+     * Append a record to the trace ring buffer, if enabled.
+     */
+    void traceTransaction(const ProbePoints::PacketInfo& pkt_info,
+                          MasterID master_id, Tick latency,
+                          bool is_response);
+
     /** This function is called periodically at the end of each time bin */
     void samplePeriodic();
 
@@ -412,8 +508,44 @@ class CommMonitor : public MemObject
     /** Address mask for sources of write accesses to be captured */
     const Addr writeAddrMask;
 
+    /** Sample one in every sampleInterval transactions */
+    const unsigned sampleInterval;
+
+    /**
+     * Only sample transactions in a window of this length at the
+     * start of each sample period, 0 to sample the whole period
+     */
+    const Tick sampleWindowTicks;
+
     /** @} */
 
+    /** Transactions seen since the last sampled one */
+    unsigned transSinceSample;
+
+    /** Start of the current sample period */
+    Tick periodStart;
+
+    /**
+     * Ring of outstanding sampled requests indexed by the sequence
+     * number, sized once at construction. Requests still waiting
+     * when their slot comes round again are evicted, so stale
+     * entries never accumulate.
+     */
+    std::vector<LatencyEntry> latencyTable;
+
+    /** Sequence number of the last sampled request, 0 for none */
+    uint64_t latencySeq;
+
+    /** Sender states recycled so tracking latencies never allocates */
+    std::vector<CommMonitorSenderState*> senderStateFreeList;
+
+    /** Trace ring buffer header and records, mapped from a file */
+    TraceHeader* traceHeader;
+    TraceRecord* traceRecords;
+
+    /** Size of the mapped trace file */
+    size_t traceMapSize;
+
     /** Instantiate stats */
     MonitorStats stats;
 
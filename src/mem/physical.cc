@@ -41,17 +41,27 @@
 
 #include <fcntl.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/user.h>
 #include <unistd.h>
 #include <zlib.h>
 
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
 #include <cerrno>
 #include <climits>
 #include <cstdio>
+#include <cstring>
 #include <iostream>
 #include <string>
+#include <thread>
 
+#include "base/intmath.hh"
 #include "base/trace.hh"
 #include "debug/AddrRanges.hh"
 #include "debug/Checkpoint.hh"
@@ -69,17 +79,254 @@
 #endif
 #endif
 
+/**
+ * Huge page backed mappings and NUMA memory policies are only
+ * available on Linux. Elsewhere the flags are simply 0 and we fall
+ * back to normal pages and first-touch placement.
+ */
+#ifndef MAP_HUGETLB
+#define MAP_HUGETLB 0
+#endif
+
+#if defined(__linux__) && defined(SYS_mbind)
+// Avoid depending on libnuma for the only constant we need
+#define GEM5_MPOL_BIND 2
+#endif
+
 using namespace std;
 
+namespace {
+
+/**
+ * Magic number at the start of a chunked memory store file.
+ */
+const char chunkedStoreMagic[8] = { 'g', 'e', 'm', '5', 'p', 'm', 'c', '1' };
+
+/**
+ * Header of a chunked memory store file. The header is followed by
+ * the path of the parent store for a delta, the page bitmap, the
+ * chunk offset table, and finally the page-aligned data.
+ */
+struct ChunkedStoreHeader
+{
+    char magic[8];
+    uint64_t rangeSize;
+    uint64_t pageSize;
+    uint64_t chunkSize;
+    uint64_t dataOffset;
+    int32_t compressionLevel;
+    uint32_t parentLength;
+};
+
+/**
+ * Path helpers used to refer from a delta store to its parent.
+ */
+string
+absolutePath(const string &path)
+{
+    char *resolved = realpath(path.c_str(), NULL);
+    if (!resolved)
+        fatal("Can't resolve path '%s'\n", path);
+    string result(resolved);
+    free(resolved);
+    return result;
+}
+
+string
+dirName(const string &path)
+{
+    size_t pos = path.find_last_of('/');
+    if (pos == string::npos)
+        return ".";
+    return pos == 0 ? "/" : path.substr(0, pos);
+}
+
+/**
+ * Express an absolute path relative to an absolute directory, so
+ * that a set of checkpoints can be moved together.
+ */
+string
+relativePath(const string &from_dir, const string &to_path)
+{
+    auto split = [](const string &path) {
+        vector<string> parts;
+        size_t start = 0;
+        while (start < path.size()) {
+            size_t end = path.find('/', start);
+            if (end == string::npos)
+                end = path.size();
+            if (end != start)
+                parts.push_back(path.substr(start, end - start));
+            start = end + 1;
+        }
+        return parts;
+    };
+
+    vector<string> from = split(from_dir);
+    vector<string> to = split(to_path);
+    size_t common = 0;
+    while (common < from.size() && common < to.size() &&
+           from[common] == to[common])
+        ++common;
+
+    string result;
+    for (size_t i = common; i < from.size(); ++i)
+        result += "../";
+    for (size_t i = common; i < to.size(); ++i)
+        result += to[i] + (i + 1 < to.size() ? "/" : "");
+    return result;
+}
+
+/**
+ * Apply a function to all indices in [begin, end) using a number of
+ * host threads, handing out the indices dynamically as the workers
+ * become available.
+ *
+ * @return false if the function failed for any of the indices
+ */
+template <typename F>
+bool
+parallelFor(unsigned threads, uint64_t begin, uint64_t end, F f)
+{
+    atomic<uint64_t> next(begin);
+    atomic<bool> success(true);
+
+    auto worker = [&]() {
+        for (uint64_t i = next++; i < end && success; i = next++) {
+            if (!f(i))
+                success = false;
+        }
+    };
+
+    vector<thread> workers;
+    for (unsigned t = 1; t < min<uint64_t>(threads, end - begin); ++t)
+        workers.emplace_back(worker);
+    worker();
+    for (auto& w : workers)
+        w.join();
+
+    return success;
+}
+
+/**
+ * Write or read a buffer at an offset, restarting after partial
+ * transfers.
+ */
+bool
+pwriteAll(int fd, const void *buf, uint64_t len, uint64_t offset)
+{
+    const uint8_t *p = (const uint8_t *)buf;
+    while (len) {
+        ssize_t n = pwrite(fd, p, min<uint64_t>(len, INT_MAX), offset);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        p += n; offset += n; len -= n;
+    }
+    return true;
+}
+
+bool
+preadAll(int fd, void *buf, uint64_t len, uint64_t offset)
+{
+    uint8_t *p = (uint8_t *)buf;
+    while (len) {
+        ssize_t n = pread(fd, p, min<uint64_t>(len, INT_MAX), offset);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        p += n; offset += n; len -= n;
+    }
+    return true;
+}
+
+/**
+ * Check if a page only contains zeros.
+ */
+bool
+isZeroPage(const uint8_t *page, uint64_t len)
+{
+    uint64_t i = 0;
+    for (; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, page + i, sizeof(word));
+        if (word)
+            return false;
+    }
+    for (; i < len; ++i) {
+        if (page[i])
+            return false;
+    }
+    return true;
+}
+
+}
+
 PhysicalMemory::PhysicalMemory(const string& _name,
                                const vector<AbstractMemory*>& _memories,
-                               bool mmap_using_noreserve) :
+                               bool mmap_using_noreserve,
+                               bool mmap_using_hugepages,
+                               const string& shared_backstore,
+                               bool shared_backstore_keep,
+                               const vector<int>& numa_nodes,
+                               Enums::MemoryStoreFormat store_format,
+                               uint64_t store_chunk_size,
+                               int store_compression_level,
+                               unsigned store_threads,
+                               bool store_delta) :
     _name(_name), rangeCache(addrMap.end()), size(0),
-    mmapUsingNoReserve(mmap_using_noreserve)
+    mmapUsingNoReserve(mmap_using_noreserve),
+    mmapUsingHugePages(mmap_using_hugepages),
+    sharedBackstore(shared_backstore),
+    sharedBackstoreKeep(shared_backstore_keep), sharedBackstoreFd(-1),
+    sharedBackstoreSize(0), numaNodes(numa_nodes),
+    storeFormat(store_format), storeChunkSize(store_chunk_size),
+    storeCompressionLevel(store_compression_level),
+    storeThreads(store_threads ? store_threads :
+                 max(thread::hardware_concurrency(), 1u)),
+    storeDelta(store_delta)
 {
     if (mmap_using_noreserve)
         warn("Not reserving swap space. May cause SIGSEGV on actual usage\n");
 
+    // each chunk covers whole bytes of the page bitmap, which lets
+    // the workers update it without any synchronisation
+    const uint64_t page_size = sysconf(_SC_PAGESIZE);
+    fatal_if(storeFormat == Enums::chunked &&
+             (storeChunkSize == 0 || storeChunkSize % (8 * page_size)),
+             "Store chunk size %d must be a multiple of %d bytes\n",
+             storeChunkSize, 8 * page_size);
+    fatal_if(storeCompressionLevel < 0 || storeCompressionLevel > 9,
+             "Store compression level %d is not in the range 0-9\n",
+             storeCompressionLevel);
+    fatal_if(storeDelta && storeFormat != Enums::chunked,
+             "Delta checkpoints require the chunked store format\n");
+
+    if (!sharedBackstore.empty()) {
+        // a portable shared memory object name is a single path
+        // component, optionally preceded by a slash
+        const size_t name_start = sharedBackstore[0] == '/' ? 1 : 0;
+        const string name = sharedBackstore.substr(name_start);
+        fatal_if(name.empty() || name.find('/') != string::npos ||
+                 name.size() > NAME_MAX,
+                 "Shared backing store name '%s' is not valid, it has to "
+                 "be a name of at most %d characters without a '/', "
+                 "optionally preceded by one\n", sharedBackstore,
+                 NAME_MAX);
+
+        // truncate any image left behind by an earlier run, as the
+        // stores are expected to start out zeroed
+        sharedBackstoreFd = shm_open(sharedBackstore.c_str(),
+                                     O_CREAT | O_RDWR | O_TRUNC, 0666);
+        if (sharedBackstoreFd == -1) {
+            perror("shm_open");
+            fatal("Could not open shared backing store '%s'\n",
+                  sharedBackstore);
+        }
+    }
+
     // add the memories from the system to the address map as
     // appropriate
     for (const auto& m : _memories) {
@@ -195,35 +442,149 @@ PhysicalMemory::createBackingStore(AddrRange range,
     // perform the actual mmap
     DPRINTF(AddrRanges, "Creating backing store for range %s with size %d\n",
             range.to_string(), range.size());
-    int map_flags = MAP_ANON | MAP_PRIVATE;
 
-    // to be able to simulate very large memories, the user can opt to
-    // pass noreserve to mmap
-    if (mmapUsingNoReserve) {
-        map_flags |= MAP_NORESERVE;
-    }
+    uint64_t shm_offset = 0;
+    uint8_t* pmem = mapBackingStore(range.size(), shm_offset);
 
-    uint8_t* pmem = (uint8_t*) mmap(NULL, range.size(),
-                                    PROT_READ | PROT_WRITE,
-                                    map_flags, -1, 0);
-
-    if (pmem == (uint8_t*) MAP_FAILED) {
-        perror("mmap");
-        fatal("Could not mmap %d bytes for range %s!\n", range.size(),
-              range.to_string());
-    }
+    // place the store on the host node closest to the thread
+    // serving it before anyone touches the pages
+    bindBackingStore(pmem, range.size(), _memories.front());
 
     // remember this backing store so we can checkpoint it and unmap
     // it appropriately
     backingStore.emplace_back(range, pmem,
                               conf_table_reported, in_addr_map, kvm_map);
+    backingStore.back().shmOffset = shm_offset;
+
+    // track the pages written since the last checkpoint if we are
+    // going to write deltas
+    uint8_t* dirty_map = nullptr;
+    const uint64_t page_size = sysconf(_SC_PAGESIZE);
+    if (storeDelta) {
+        dirtyMaps.emplace_back(divCeil(range.size(), page_size), 0);
+        dirty_map = dirtyMaps.back().data();
+    } else {
+        dirtyMaps.emplace_back();
+    }
+    lastStorePaths.emplace_back();
 
     // point the memories to their backing store
     for (const auto& m : _memories) {
         DPRINTF(AddrRanges, "Mapping memory %s to backing store\n",
                 m->name());
         m->setBackingStore(pmem);
+        m->setDirtyMap(dirty_map, floorLog2(page_size));
+    }
+}
+
+uint8_t*
+PhysicalMemory::mapBackingStore(uint64_t size, uint64_t &shm_offset)
+{
+    int map_flags;
+    int fd = -1;
+    off_t offset = 0;
+
+    if (sharedBackstoreFd != -1) {
+        // stores are laid out back to back in the shared memory
+        // object, so grow it to fit this one as well
+        shm_offset = sharedBackstoreSize;
+        offset = shm_offset;
+        fatal_if(shm_offset % sysconf(_SC_PAGESIZE),
+                 "Shared backing store '%s' offset %#x is not page "
+                 "aligned, all memory sizes must be a multiple of the "
+                 "host page size\n", sharedBackstore, shm_offset);
+        if (ftruncate(sharedBackstoreFd, shm_offset + size)) {
+            perror("ftruncate");
+            fatal("Could not grow shared backing store '%s' to %d bytes\n",
+                  sharedBackstore, shm_offset + size);
+        }
+        sharedBackstoreSize += size;
+
+        DPRINTF(AddrRanges, "Sharing backing store as %s at offset %#x\n",
+                sharedBackstore, shm_offset);
+
+        fd = sharedBackstoreFd;
+        map_flags = MAP_SHARED;
+    } else {
+        map_flags = MAP_ANON | MAP_PRIVATE;
+    }
+
+    // to be able to simulate very large memories, the user can opt to
+    // pass noreserve to mmap
+    if (mmapUsingNoReserve) {
+        map_flags |= MAP_NORESERVE;
+    }
+
+    uint8_t* pmem = (uint8_t*) MAP_FAILED;
+
+    // explicit huge pages come from the host hugetlbfs pool and only
+    // apply to anonymous mappings, so try those first and fall back
+    // on normal pages if the pool is too small
+    if (mmapUsingHugePages && MAP_HUGETLB && fd == -1) {
+        pmem = (uint8_t*) mmap(NULL, size, PROT_READ | PROT_WRITE,
+                               map_flags | MAP_HUGETLB, fd, offset);
+        if (pmem == (uint8_t*) MAP_FAILED)
+            warn("Could not mmap %d bytes using huge pages, falling back "
+                 "on transparent huge pages\n", size);
     }
+
+    if (pmem == (uint8_t*) MAP_FAILED) {
+        pmem = (uint8_t*) mmap(NULL, size, PROT_READ | PROT_WRITE,
+                               map_flags, fd, offset);
+
+        if (pmem == (uint8_t*) MAP_FAILED) {
+            perror("mmap");
+            fatal("Could not mmap %d bytes for backing store!\n", size);
+        }
+
+#if defined(MADV_HUGEPAGE)
+        // ask for transparent huge pages, this is merely a hint and
+        // failure is not fatal
+        if (mmapUsingHugePages && madvise(pmem, size, MADV_HUGEPAGE))
+            warn("Transparent huge pages not available for backing "
+                 "store\n");
+#endif
+    }
+
+    return pmem;
+}
+
+void
+PhysicalMemory::bindBackingStore(uint8_t* pmem, uint64_t size,
+                                 const AbstractMemory* mem) const
+{
+    if (numaNodes.empty())
+        return;
+
+    // the store is served by the event queue of its (first) memory
+    uint32_t eventq_index = mem->params()->eventq_index;
+    fatal_if(eventq_index >= numaNodes.size(),
+             "No host NUMA node given for event queue %d of %s\n",
+             eventq_index, mem->name());
+    int node = numaNodes[eventq_index];
+
+    // a negative node means leave the placement to the host
+    if (node < 0)
+        return;
+
+#if defined(GEM5_MPOL_BIND)
+    const unsigned long bits_per_long = sizeof(unsigned long) * CHAR_BIT;
+    vector<unsigned long> nodemask(node / bits_per_long + 1, 0);
+    nodemask[node / bits_per_long] |= 1UL << (node % bits_per_long);
+
+    DPRINTF(AddrRanges, "Binding backing store of %s to host node %d\n",
+            mem->name(), node);
+
+    if (syscall(SYS_mbind, pmem, size, GEM5_MPOL_BIND, nodemask.data(),
+                nodemask.size() * bits_per_long + 1, 0)) {
+        perror("mbind");
+        warn("Could not bind backing store of %s to host node %d\n",
+             mem->name(), node);
+    }
+#else
+    warn_once("Host NUMA binding of the backing store is not supported "
+              "on this platform\n");
+#endif
 }
 
 PhysicalMemory::~PhysicalMemory()
@@ -231,6 +592,15 @@ PhysicalMemory::~PhysicalMemory()
     // unmap the backing store
     for (auto& s : backingStore)
         munmap((char*)s.pmem, s.range.size());
+
+    for (auto& i : lazyImages)
+        close(i.fd);
+
+    if (sharedBackstoreFd != -1) {
+        close(sharedBackstoreFd);
+        if (!sharedBackstoreKeep)
+            shm_unlink(sharedBackstore.c_str());
+    }
 }
 
 bool
@@ -338,6 +708,10 @@ PhysicalMemory::serialize(CheckpointOut &cp) const
     SERIALIZE_CONTAINER(lal_addr);
     SERIALIZE_CONTAINER(lal_cid);
 
+    // anything read from a changed image would end up in the
+    // checkpoint
+    checkLazyImages();
+
     // serialize the backing stores
     unsigned int nbr_of_stores = backingStore.size();
     SERIALIZE_SCALAR(nbr_of_stores);
@@ -358,6 +732,7 @@ PhysicalMemory::serializeStore(CheckpointOut &cp, unsigned int store_id,
     // memories that are not part of the address map can overlap
     string filename = name() + ".store" + to_string(store_id) + ".pmem";
     long range_size = range.size();
+    string format = Enums::MemoryStoreFormatStrings[storeFormat];
 
     DPRINTF(Checkpoint, "Serializing physical memory %s with size %d\n",
             filename, range_size);
@@ -365,9 +740,16 @@ PhysicalMemory::serializeStore(CheckpointOut &cp, unsigned int store_id,
     SERIALIZE_SCALAR(store_id);
     SERIALIZE_SCALAR(filename);
     SERIALIZE_SCALAR(range_size);
+    SERIALIZE_SCALAR(format);
 
     // write memory file
     string filepath = CheckpointIn::dir() + "/" + filename.c_str();
+
+    if (storeFormat == Enums::chunked) {
+        serializeStoreChunked(filepath, store_id, range_size, pmem);
+        return;
+    }
+
     gzFile compressed_mem = gzopen(filepath.c_str(), "wb");
     if (compressed_mem == NULL)
         fatal("Can't open physical memory checkpoint file '%s'\n",
@@ -396,6 +778,168 @@ PhysicalMemory::serializeStore(CheckpointOut &cp, unsigned int store_id,
 
 }
 
+void
+PhysicalMemory::serializeStoreChunked(const string &filepath,
+                                      unsigned int store_id,
+                                      uint64_t range_size,
+                                      uint8_t* pmem) const
+{
+    ChunkedStoreHeader header;
+    memcpy(header.magic, chunkedStoreMagic, sizeof(header.magic));
+    header.rangeSize = range_size;
+    header.pageSize = sysconf(_SC_PAGESIZE);
+    header.chunkSize = storeChunkSize;
+    header.compressionLevel = storeCompressionLevel;
+
+    const uint64_t page_size = header.pageSize;
+    const uint64_t nbr_pages = divCeil(range_size, page_size);
+    const uint64_t nbr_chunks = divCeil(range_size, storeChunkSize);
+    const uint64_t pages_per_chunk = storeChunkSize / page_size;
+
+    // a delta only holds the pages written since the previous
+    // checkpoint, which it refers to relative to its own directory,
+    // unless we are about to replace that checkpoint
+    const vector<uint8_t> *dirty_map = nullptr;
+    string parent;
+    const string dir = absolutePath(dirName(filepath));
+    const string path = dir + filepath.substr(filepath.find_last_of('/'));
+    if (storeDelta && !lastStorePaths[store_id].empty() &&
+        lastStorePaths[store_id] != path) {
+        dirty_map = &dirtyMaps[store_id];
+        parent = relativePath(dir, lastStorePaths[store_id]);
+        DPRINTF(Checkpoint, "Writing %s as a delta against %s\n",
+                filepath, parent);
+    }
+    header.parentLength = parent.size();
+
+    // the bitmap and offset table sizes are known up front, so the
+    // data can be written before them
+    vector<uint8_t> page_map(divCeil(nbr_pages, 8), 0);
+    vector<uint64_t> chunk_offsets(nbr_chunks + 1, 0);
+    const uint64_t page_map_offset = sizeof(header) + parent.size();
+    const uint64_t chunk_offsets_offset = page_map_offset + page_map.size();
+    header.dataOffset = roundUp(chunk_offsets_offset +
+                                chunk_offsets.size() * sizeof(uint64_t),
+                                page_size);
+
+    // the file may be the image a lazy restore mapped, e.g. when
+    // checkpointing into the directory we restored from, so replace it
+    // rather than truncate it underneath the mapping
+    unlink(filepath.c_str());
+    int fd = open(filepath.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0664);
+    if (fd == -1)
+        fatal("Can't open physical memory checkpoint file '%s'\n",
+              filepath);
+
+    // find the pages of a chunk to store and mark them in the bitmap,
+    // for a delta these are the dirty pages, even if they are zero
+    auto scan_chunk = [&](uint64_t c, vector<uint64_t> &pages) {
+        uint64_t first_page = c * pages_per_chunk;
+        uint64_t last_page = min(first_page + pages_per_chunk, nbr_pages);
+        for (uint64_t p = first_page; p < last_page; ++p) {
+            uint64_t len = min(page_size, range_size - p * page_size);
+            if (dirty_map ? (*dirty_map)[p] :
+                !isZeroPage(pmem + p * page_size, len)) {
+                page_map[p / 8] |= 1 << (p % 8);
+                pages.push_back(p);
+            }
+        }
+    };
+
+    bool success = true;
+    if (storeCompressionLevel == 0) {
+        // write the stored pages in place, leaving holes for the
+        // rest, and make sure the file covers the whole range
+        success = parallelFor(storeThreads, 0, nbr_chunks, [&](uint64_t c) {
+            vector<uint64_t> pages;
+            scan_chunk(c, pages);
+            for (auto p : pages) {
+                uint64_t len = min(page_size, range_size - p * page_size);
+                if (!pwriteAll(fd, pmem + p * page_size, len,
+                               header.dataOffset + p * page_size))
+                    return false;
+            }
+            return true;
+        }) && ftruncate(fd, header.dataOffset + range_size) == 0;
+    } else {
+        // compress a window of chunks in parallel and then append
+        // them to the file in order, to bound the memory we use
+        const uint64_t window = 4 * storeThreads;
+        vector<vector<uint8_t>> compressed(window);
+        uint64_t curr_offset = 0;
+        for (uint64_t first = 0; success && first < nbr_chunks;
+             first += window) {
+            uint64_t last = min(first + window, nbr_chunks);
+            success = parallelFor(storeThreads, first, last,
+                                  [&](uint64_t c) {
+                vector<uint64_t> pages;
+                scan_chunk(c, pages);
+                vector<uint8_t> &out = compressed[c - first];
+                out.clear();
+                if (pages.empty())
+                    return true;
+
+                // gather the pages unless they are contiguous
+                const uint8_t *src = pmem + pages.front() * page_size;
+                uint64_t src_len = min(pages.size() * page_size,
+                                       range_size - pages.front() *
+                                       page_size);
+                vector<uint8_t> gathered;
+                if (pages.size() != pages.back() - pages.front() + 1) {
+                    for (auto p : pages) {
+                        uint64_t len = min(page_size,
+                                           range_size - p * page_size);
+                        gathered.insert(gathered.end(),
+                                        pmem + p * page_size,
+                                        pmem + p * page_size + len);
+                    }
+                    src = gathered.data();
+                    src_len = gathered.size();
+                }
+
+                uLongf out_len = compressBound(src_len);
+                out.resize(out_len);
+                if (compress2(out.data(), &out_len, src, src_len,
+                              storeCompressionLevel) != Z_OK)
+                    return false;
+                out.resize(out_len);
+                return true;
+            });
+
+            for (uint64_t c = first; success && c < last; ++c) {
+                auto &out = compressed[c - first];
+                chunk_offsets[c] = curr_offset;
+                success = pwriteAll(fd, out.data(), out.size(),
+                                    header.dataOffset + curr_offset);
+                curr_offset += out.size();
+            }
+        }
+        chunk_offsets[nbr_chunks] = curr_offset;
+    }
+
+    success = success &&
+        pwriteAll(fd, &header, sizeof(header), 0) &&
+        pwriteAll(fd, parent.data(), parent.size(), sizeof(header)) &&
+        pwriteAll(fd, page_map.data(), page_map.size(), page_map_offset) &&
+        pwriteAll(fd, chunk_offsets.data(),
+                  chunk_offsets.size() * sizeof(uint64_t),
+                  chunk_offsets_offset);
+
+    if (!success)
+        fatal("Write failed on physical memory checkpoint file '%s'\n",
+              filepath);
+
+    if (close(fd))
+        fatal("Close failed on physical memory checkpoint file '%s'\n",
+              filepath);
+
+    // the next delta is relative to this checkpoint
+    if (storeDelta) {
+        lastStorePaths[store_id] = absolutePath(filepath);
+        fill(dirtyMaps[store_id].begin(), dirtyMaps[store_id].end(), 0);
+    }
+}
+
 void
 PhysicalMemory::unserialize(CheckpointIn &cp)
 {
@@ -433,6 +977,17 @@ PhysicalMemory::unserializeStore(CheckpointIn &cp)
     UNSERIALIZE_SCALAR(filename);
     string filepath = cp.cptDir + "/" + filename;
 
+    // checkpoints predating the chunked format do not record it
+    string format = "gzip";
+    optParamIn(cp, "format", format, false);
+    if (format == "chunked") {
+        unserializeStoreChunked(cp, filepath, store_id);
+        return;
+    } else if (format != "gzip") {
+        fatal("Unknown format '%s' of physical memory checkpoint file "
+              "'%s'\n", format, filename);
+    }
+
     // mmap memoryfile
     gzFile compressed_mem = gzopen(filepath.c_str(), "rb");
     if (compressed_mem == NULL)
@@ -480,3 +1035,205 @@ PhysicalMemory::unserializeStore(CheckpointIn &cp)
         fatal("Close failed on physical memory checkpoint file '%s'\n",
               filename);
 }
+
+void
+PhysicalMemory::unserializeStoreChunked(CheckpointIn &cp,
+                                        const string &filepath,
+                                        unsigned int store_id)
+{
+    // we've already got the actual backing store mapped
+    uint8_t* pmem = backingStore[store_id].pmem;
+    AddrRange range = backingStore[store_id].range;
+
+    long range_size;
+    UNSERIALIZE_SCALAR(range_size);
+
+    if (range_size != range.size())
+        fatal("Memory range size has changed! Saw %lld, expected %lld\n",
+              range_size, range.size());
+
+    restoreChunkedStore(filepath, pmem, range_size);
+
+    // restoring does not dirty any pages, and the next delta is
+    // relative to the checkpoint we restored from
+    if (storeDelta)
+        lastStorePaths[store_id] = absolutePath(filepath);
+}
+
+void
+PhysicalMemory::restoreChunkedStore(const string &filepath, uint8_t* pmem,
+                                    uint64_t range_size)
+{
+    int fd = open(filepath.c_str(), O_RDONLY);
+    if (fd == -1)
+        fatal("Can't open physical memory checkpoint file '%s'\n",
+              filepath);
+
+    ChunkedStoreHeader header;
+    if (!preadAll(fd, &header, sizeof(header), 0) ||
+        memcmp(header.magic, chunkedStoreMagic, sizeof(header.magic)))
+        fatal("Physical memory checkpoint file '%s' is corrupt\n",
+              filepath);
+
+    if (header.rangeSize != range_size)
+        fatal("Memory range size of '%s' has changed! Saw %lld, "
+              "expected %lld\n", filepath, header.rangeSize, range_size);
+
+    if (header.pageSize == 0 || header.chunkSize < header.pageSize ||
+        header.chunkSize % header.pageSize != 0)
+        fatal("Physical memory checkpoint file '%s' is corrupt, chunk "
+              "size %lld is not a multiple of page size %lld\n", filepath,
+              header.chunkSize, header.pageSize);
+
+    struct stat st;
+    if (fstat(fd, &st))
+        fatal("Can't stat physical memory checkpoint file '%s'\n",
+              filepath);
+    const uint64_t file_size = st.st_size;
+
+    const uint64_t page_size = header.pageSize;
+    const uint64_t nbr_pages = divCeil(range_size, page_size);
+    const uint64_t nbr_chunks = divCeil(range_size, header.chunkSize);
+    const uint64_t pages_per_chunk = header.chunkSize / page_size;
+
+    string parent(header.parentLength, '\0');
+    vector<uint8_t> page_map(divCeil(nbr_pages, 8));
+    vector<uint64_t> chunk_offsets(nbr_chunks + 1);
+    const uint64_t page_map_offset = sizeof(header) + parent.size();
+    if (!preadAll(fd, &parent[0], parent.size(), sizeof(header)) ||
+        !preadAll(fd, page_map.data(), page_map.size(), page_map_offset) ||
+        !preadAll(fd, chunk_offsets.data(),
+                  chunk_offsets.size() * sizeof(uint64_t),
+                  page_map_offset + page_map.size()))
+        fatal("Physical memory checkpoint file '%s' is corrupt\n",
+              filepath);
+
+    // the compressed chunks are stored back to back, and have to lie
+    // within the file
+    if (header.compressionLevel != 0) {
+        for (uint64_t c = 0; c < nbr_chunks; ++c) {
+            if (chunk_offsets[c + 1] < chunk_offsets[c])
+                fatal("Physical memory checkpoint file '%s' is corrupt, "
+                      "offset of chunk %d is out of order\n", filepath,
+                      c + 1);
+        }
+        if (header.dataOffset > file_size ||
+            chunk_offsets[nbr_chunks] > file_size - header.dataOffset)
+            fatal("Physical memory checkpoint file '%s' is corrupt, its "
+                  "chunks end past the end of the file\n", filepath);
+    }
+
+    // a delta is applied on top of its parent, which in turn may be
+    // a delta itself
+    if (!parent.empty()) {
+        if (parent[0] != '/')
+            parent = dirName(filepath) + "/" + parent;
+        DPRINTF(Checkpoint, "Restoring %s on top of %s\n", filepath, parent);
+        restoreChunkedStore(parent, pmem, range_size);
+    }
+
+    DPRINTF(Checkpoint, "Unserializing chunked physical memory %s with "
+            "size %d\n", filepath, range_size);
+
+    auto page_present = [&](uint64_t p) {
+        return page_map[p / 8] & (1 << (p % 8));
+    };
+
+    bool success = true;
+    bool mapped = false;
+    if (header.compressionLevel == 0) {
+        // The image is page aligned, so if the host agrees on the
+        // page size we simply map it privately on top of the backing
+        // store and let the host fault pages in as they are
+        // touched. This only works for the base of a chain of deltas,
+        // and not for stores using huge pages, shared stores or stores
+        // bound to a NUMA node, as the mapping would replace them and
+        // their memory policy. The pages not yet touched are those of
+        // the file, so it must be left unchanged while we run.
+        uint64_t host_page_size = sysconf(_SC_PAGESIZE);
+        if (parent.empty() && !mmapUsingHugePages &&
+            sharedBackstoreFd == -1 && numaNodes.empty() &&
+            header.dataOffset % host_page_size == 0) {
+            // touching a page past the end of the file would raise
+            // SIGBUS rather than fail here
+            if (file_size < header.dataOffset + range_size)
+                fatal("Physical memory checkpoint file '%s' is truncated, "
+                      "expected %lld bytes of data\n", filepath,
+                      range_size);
+
+            DPRINTF(Checkpoint, "Mapping %s for lazy restore\n", filepath);
+            void *addr = mmap(pmem, range_size, PROT_READ | PROT_WRITE,
+                              MAP_PRIVATE | MAP_FIXED, fd, header.dataOffset);
+            success = mapped = addr == pmem;
+        } else {
+            success = parallelFor(storeThreads, 0, nbr_pages,
+                                  [&](uint64_t p) {
+                if (!page_present(p))
+                    return true;
+                uint64_t len = min(page_size, range_size - p * page_size);
+                return preadAll(fd, pmem + p * page_size, len,
+                                header.dataOffset + p * page_size);
+            });
+        }
+    } else {
+        success = parallelFor(storeThreads, 0, nbr_chunks, [&](uint64_t c) {
+            uint64_t in_len = chunk_offsets[c + 1] - chunk_offsets[c];
+            if (in_len == 0)
+                return true;
+
+            vector<uint8_t> in(in_len);
+            if (!preadAll(fd, in.data(), in_len,
+                          header.dataOffset + chunk_offsets[c]))
+                return false;
+
+            uint64_t first_page = c * pages_per_chunk;
+            uint64_t last_page = min(first_page + pages_per_chunk,
+                                     nbr_pages);
+            vector<uint8_t> out(header.chunkSize);
+            uLongf out_len = out.size();
+            if (uncompress(out.data(), &out_len, in.data(), in_len) != Z_OK)
+                return false;
+
+            // scatter the pages, anything not present is either zero
+            // in a freshly mapped backing store, or already restored
+            // from the parent
+            uint64_t pos = 0;
+            for (uint64_t p = first_page; p < last_page; ++p) {
+                if (!page_present(p))
+                    continue;
+                uint64_t len = min(page_size, range_size - p * page_size);
+                if (pos + len > out_len)
+                    return false;
+                memcpy(pmem + p * page_size, out.data() + pos, len);
+                pos += len;
+            }
+            return pos == out_len;
+        });
+    }
+
+    if (!success)
+        fatal("Read failed on physical memory checkpoint file '%s'\n",
+              filepath);
+
+    if (mapped) {
+        lazyImages.push_back({filepath, fd, st.st_size, st.st_mtime});
+        return;
+    }
+
+    if (close(fd))
+        fatal("Close failed on physical memory checkpoint file '%s'\n",
+              filepath);
+}
+
+void
+PhysicalMemory::checkLazyImages() const
+{
+    for (const auto& i : lazyImages) {
+        struct stat st;
+        if (fstat(i.fd, &st) || st.st_size != i.size ||
+            st.st_mtime != i.mtime)
+            fatal("Physical memory checkpoint file '%s' changed after it "
+                  "was mapped for a lazy restore, guest memory is no "
+                  "longer that of the checkpoint\n", i.path);
+    }
+}
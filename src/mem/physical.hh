@@ -40,7 +40,10 @@
 #ifndef __MEM_PHYSICAL_HH__
 #define __MEM_PHYSICAL_HH__
 
+#include <sys/types.h>
+
 #include "base/addr_range_map.hh"
+#include "enums/MemoryStoreFormat.hh"
 #include "mem/packet.hh"
 
 /**
@@ -62,7 +65,7 @@ class BackingStoreEntry
     BackingStoreEntry(AddrRange range, uint8_t* pmem,
                       bool conf_table_reported, bool in_addr_map, bool kvm_map)
         : range(range), pmem(pmem), confTableReported(conf_table_reported),
-          inAddrMap(in_addr_map), kvmMap(kvm_map)
+          inAddrMap(in_addr_map), kvmMap(kvm_map), shmOffset(0)
         {}
 
     /**
@@ -91,6 +94,11 @@ class BackingStoreEntry
       * acceleration.
       */
      bool kvmMap;
+
+     /**
+      * Offset of this range in the shared backing store, if any.
+      */
+     uint64_t shmOffset;
 };
 
 /**
@@ -133,6 +141,59 @@ class PhysicalMemory : public Serializable
     // Let the user choose if we reserve swap space when calling mmap
     const bool mmapUsingNoReserve;
 
+    // Let the user choose if the backing store uses huge pages
+    const bool mmapUsingHugePages;
+
+    // Name of the shared memory object backing the stores, if any
+    const std::string sharedBackstore;
+
+    // Leave the shared memory object in place when we exit
+    const bool sharedBackstoreKeep;
+
+    // File descriptor and current size of the shared backing store
+    int sharedBackstoreFd;
+    uint64_t sharedBackstoreSize;
+
+    // Host NUMA node for each event queue, empty if no binding is done
+    const std::vector<int> numaNodes;
+
+    // Format used when serializing the backing stores
+    const Enums::MemoryStoreFormat storeFormat;
+
+    // Chunk size, zlib level and number of host threads used for the
+    // chunked store format
+    const uint64_t storeChunkSize;
+    const int storeCompressionLevel;
+    const unsigned storeThreads;
+
+    // Write chunked stores as deltas against the previous checkpoint
+    const bool storeDelta;
+
+    // For each store, a byte per host page marking the pages written
+    // since the last checkpoint, empty unless we are writing deltas
+    mutable std::vector<std::vector<uint8_t>> dirtyMaps;
+
+    // For each store, the path of the last checkpoint written or
+    // restored, which is the parent of the next delta
+    mutable std::vector<std::string> lastStorePaths;
+
+    /**
+     * An uncompressed checkpoint file mapped in place of a backing
+     * store. Pages are read from the file as the simulation first
+     * touches them, so it must not change while we run.
+     */
+    struct LazyImage
+    {
+        std::string path;
+        int fd;
+        off_t size;
+        time_t mtime;
+    };
+
+    // The checkpoint files mapped by a lazy restore, kept open so we
+    // can check that they are left alone
+    std::vector<LazyImage> lazyImages;
+
     // The physical memory used to provide the memory in the simulated
     // system
     std::vector<BackingStoreEntry> backingStore;
@@ -157,14 +218,57 @@ class PhysicalMemory : public Serializable
                             bool conf_table_reported,
                             bool in_addr_map, bool kvm_map);
 
+    /**
+     * Map the host memory for a backing store, either anonymously or
+     * as part of the shared backing store, and using huge pages if
+     * requested.
+     *
+     * @param size The size of the region in bytes
+     * @param shm_offset Returns the offset in the shared backing store
+     * @return Pointer to the mapped host memory
+     */
+    uint8_t* mapBackingStore(uint64_t size, uint64_t &shm_offset);
+
+    /**
+     * Bind a backing store to the host NUMA node of the event queue
+     * serving the given memory. This is a no-op unless a node mapping
+     * is provided, and on hosts without NUMA support.
+     *
+     * @param pmem The host pointer to the backing store
+     * @param size The size of the backing store in bytes
+     * @param mem The memory serving the backing store
+     */
+    void bindBackingStore(uint8_t* pmem, uint64_t size,
+                          const AbstractMemory* mem) const;
+
   public:
 
     /**
      * Create a physical memory object, wrapping a number of memories.
+     *
+     * @param mmap_using_noreserve Do not reserve swap for the store
+     * @param mmap_using_hugepages Back the store using huge pages
+     * @param shared_backstore Shared memory object name, or empty
+     * @param shared_backstore_keep Leave the shared object on exit
+     * @param numa_nodes Host NUMA node for each event queue
+     * @param store_format Format used when serializing the stores
+     * @param store_chunk_size Chunk size of the chunked format
+     * @param store_compression_level zlib level of the chunked format
+     * @param store_threads Host threads used by the chunked format
+     * @param store_delta Write deltas against the previous checkpoint
      */
     PhysicalMemory(const std::string& _name,
                    const std::vector<AbstractMemory*>& _memories,
-                   bool mmap_using_noreserve);
+                   bool mmap_using_noreserve,
+                   bool mmap_using_hugepages,
+                   const std::string& shared_backstore,
+                   bool shared_backstore_keep,
+                   const std::vector<int>& numa_nodes,
+                   Enums::MemoryStoreFormat store_format,
+                   uint64_t store_chunk_size,
+                   int store_compression_level,
+                   unsigned store_threads,
+                   bool store_delta);
 
     /**
      * Unmap all the backing store we have used.
@@ -211,13 +315,23 @@ class PhysicalMemory : public Serializable
      * that memories that are null are not present, and that the
      * backing store may also contain memories that are not part of
      * the OS-visible global address map and thus are allowed to
-     * overlap.
+     * overlap. Writes through these pointers are not seen by delta
+     * checkpoints, see isStoreDelta().
      *
      * @return Pointers to the memory backing store
      */
     std::vector<BackingStoreEntry> getBackingStore() const
     { return backingStore; }
 
+    /**
+     * Are the stores checkpointed as deltas? The deltas rely on the
+     * memories marking the pages they write, so the backing store
+     * must not be written directly.
+     *
+     * @return true if the stores are checkpointed as deltas
+     */
+    bool isStoreDelta() const { return storeDelta; }
+
     /**
      * Perform an untimed memory access and update all the state
      * (e.g. locked addresses) and statistics accordingly. The packet
@@ -257,6 +371,26 @@ class PhysicalMemory : public Serializable
     void serializeStore(CheckpointOut &cp, unsigned int store_id,
                         AddrRange range, uint8_t* pmem) const;
 
+    /**
+     * Write a backing store using the chunked format. The file starts
+     * with a header and a bitmap of the stored pages, followed by a
+     * table of chunk offsets, and the page-aligned chunk data. Only
+     * non-zero pages are stored, and each chunk is compressed
+     * independently so that chunks can be processed in
+     * parallel. Without compression, the data is a sparse image of
+     * the store, with holes for the pages not stored. When writing
+     * deltas, only the pages written since the previous checkpoint
+     * are stored, and the file refers to the previous one.
+     *
+     * @param filepath Path of the file to create
+     * @param store_id Unique identifier of this backing store
+     * @param range_size The size of this backing store
+     * @param pmem The host pointer to this backing store
+     */
+    void serializeStoreChunked(const std::string &filepath,
+                               unsigned int store_id,
+                               uint64_t range_size, uint8_t* pmem) const;
+
     /**
      * Unserialize the memories in the system. As with the
      * serialization, this action is independent of how the address
@@ -269,6 +403,36 @@ class PhysicalMemory : public Serializable
      */
     void unserializeStore(CheckpointIn &cp);
 
+    /**
+     * Read a backing store written using the chunked format. An
+     * uncompressed image is mapped copy-on-write straight on top of
+     * the backing store when possible, so that pages are only read on
+     * first touch.
+     *
+     * @param filepath Path of the file to read
+     * @param store_id Unique identifier of this backing store
+     */
+    void unserializeStoreChunked(CheckpointIn &cp,
+                                 const std::string &filepath,
+                                 unsigned int store_id);
+
+    /**
+     * Restore a chunked store file, after first restoring its parent
+     * if the file is a delta.
+     *
+     * @param filepath Path of the file to read
+     * @param pmem The host pointer to the backing store
+     * @param range_size The size of the backing store
+     */
+    void restoreChunkedStore(const std::string &filepath, uint8_t* pmem,
+                             uint64_t range_size);
+
+    /**
+     * Check that the files mapped by a lazy restore still have the
+     * size and modification time they had when they were mapped.
+     */
+    void checkLazyImages() const;
+
 };
 
 #endif //__MEM_PHYSICAL_HH__
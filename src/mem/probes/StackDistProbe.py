@@ -62,3 +62,13 @@ class StackDistProbe(BaseMemProbe):
     # logarithmic histogram bins and enable/disable
     log_hist_bins = Param.Unsigned('32', "Bins in logarithmic histograms")
     disable_log_hists = Param.Bool(False, "Disable logarithmic histograms")
+
+    # spatially sample the cache lines (SHARDS), only tracking lines
+    # whose hashed address falls below the sampling rate, and scaling
+    # the stack distances accordingly
+    sampling_rate = Param.Float(1.0, "Fraction of cache lines to sample")
+
+    # miss-ratio curve of a fully-associative LRU cache for all sizes
+    # from one line up to 2^(mrc_bins - 1) lines, in powers of two
+    mrc_bins = Param.Unsigned('24', "Cache sizes in the miss-ratio curve")
+    disable_mrc = Param.Bool(False, "Disable the miss-ratio curve")
@@ -39,19 +39,48 @@
 
 #include "mem/probes/stack_dist.hh"
 
+#include "base/intmath.hh"
 #include "params/StackDistProbe.hh"
 #include "sim/system.hh"
 
+namespace {
+
+// Resolution of the hash used for spatial sampling
+const unsigned samplingHashBits = 24;
+
+}
+
 StackDistProbe::StackDistProbe(StackDistProbeParams *p)
     : BaseMemProbe(p),
       lineSize(p->line_size),
       disableLinearHists(p->disable_linear_hists),
       disableLogHists(p->disable_log_hists),
+      samplingRate(p->sampling_rate),
+      samplingThreshold(p->sampling_rate * (1ULL << samplingHashBits)),
+      disableMRC(p->disable_mrc),
       calc(p->verify)
 {
     fatal_if(p->system->cacheLineSize() > p->line_size,
              "The stack distance probe must use a cache line size that is "
              "larger or equal to the system's cahce line size.");
+    fatal_if(samplingRate <= 0 || samplingRate > 1,
+             "The stack distance probe sampling rate must be in (0, 1].");
+}
+
+bool
+StackDistProbe::isSampled(Addr aligned_addr) const
+{
+    if (samplingRate == 1)
+        return true;
+
+    // mix the line address so that the sample is spread uniformly
+    // across the address space (splitmix64 finalizer)
+    uint64_t h = aligned_addr / lineSize;
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+    h = h ^ (h >> 31);
+
+    return (h & ((1ULL << samplingHashBits) - 1)) < samplingThreshold;
 }
 
 void
@@ -93,6 +122,30 @@ StackDistProbe::regStats()
         .name(name() + ".infinity")
         .desc("Number of requests with infinite stack distance")
         .flags(nozero);
+
+    mrcAccesses
+        .name(name() + ".mrcAccesses")
+        .desc("Number of sampled requests in the miss-ratio curve")
+        .flags(nozero);
+
+    mrcMisses
+        .init(p->mrc_bins)
+        .name(name() + ".mrcMisses")
+        .desc("Misses of a fully-associative LRU cache per size (bytes)")
+        .flags(disableMRC ? nozero : pdf);
+
+    missRatioCurve
+        .name(name() + ".missRatioCurve")
+        .desc("Miss ratio of a fully-associative LRU cache per size (bytes)")
+        .flags(disableMRC ? nozero : pdf);
+
+    for (int i = 0; i < p->mrc_bins; ++i) {
+        const std::string size = csprintf("%d", (uint64_t)lineSize << i);
+        mrcMisses.subname(i, size);
+        missRatioCurve.subname(i, size);
+    }
+
+    missRatioCurve = mrcMisses / mrcAccesses;
 }
 
 void
@@ -106,8 +159,29 @@ StackDistProbe::handleRequest(const ProbePoints::PacketInfo &pkt_info)
     // Align the address to a cache line size
     const Addr aligned_addr(roundDown(pkt_info.addr, lineSize));
 
-    // Calculate the stack distance
-    const uint64_t sd(calc.calcStackDistAndUpdate(aligned_addr).first);
+    // Only track the lines in the spatial sample
+    if (!isSampled(aligned_addr))
+        return;
+
+    // Calculate the stack distance, and scale it to compensate for
+    // the lines that are not sampled
+    const uint64_t sampled_sd(
+        calc.calcStackDistAndUpdate(aligned_addr).first);
+    const uint64_t sd(sampled_sd == StackDistCalc::Infinity ?
+                      sampled_sd : sampled_sd / samplingRate);
+
+    // A fully-associative LRU cache of N lines misses if the stack
+    // distance is N or more, so count a miss for all sizes up to
+    // the stack distance
+    if (!disableMRC) {
+        ++mrcAccesses;
+        const unsigned bins = mrcMisses.size();
+        const unsigned miss_bins = sd == StackDistCalc::Infinity ? bins :
+            sd == 0 ? 0 : std::min<unsigned>(floorLog2(sd) + 1, bins);
+        for (unsigned i = 0; i < miss_bins; ++i)
+            mrcMisses[i]++;
+    }
+
     if (sd == StackDistCalc::Infinity) {
         infiniteSD++;
         return;
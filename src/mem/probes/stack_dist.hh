@@ -57,6 +57,15 @@ class StackDistProbe : public BaseMemProbe
   protected:
     void handleRequest(const ProbePoints::PacketInfo &pkt_info) override;
 
+    /**
+     * Decide if a cache line is part of the spatial sample, based on
+     * a hash of its address.
+     *
+     * @param aligned_addr Address of the cache line
+     * @return true if the line is sampled
+     */
+    bool isSampled(Addr aligned_addr) const;
+
   protected:
     // Cache line size to simulate
     const unsigned lineSize;
@@ -67,6 +76,15 @@ class StackDistProbe : public BaseMemProbe
     // Disable the logarithmic histograms
     const bool disableLogHists;
 
+    // Fraction of the cache lines that are sampled
+    const double samplingRate;
+
+    // Sampled lines have a hash below this threshold
+    const uint64_t samplingThreshold;
+
+    // Disable the miss-ratio curve
+    const bool disableMRC;
+
   protected:
     // Reads linear histogram
     Stats::Histogram readLinearHist;
@@ -83,6 +101,15 @@ class StackDistProbe : public BaseMemProbe
     // Writes logarithmic histogram
     Stats::Scalar infiniteSD;
 
+    // Sampled accesses contributing to the miss-ratio curve
+    Stats::Scalar mrcAccesses;
+
+    // Sampled accesses missing in an LRU cache of each size
+    Stats::Vector mrcMisses;
+
+    // Miss ratio of an LRU cache of each size
+    Stats::Formula missRatioCurve;
+
   protected:
     StackDistCalc calc;
 };
@@ -28,26 +28,74 @@
 
 #include "mem/ruby/common/Consumer.hh"
 
+#include <algorithm>
+#include <cassert>
+
 using namespace std;
 
+Consumer::Consumer(ClockedObject *_em)
+    : em(_em), m_last_wakeup(MaxTick)
+{
+}
+
+Consumer::~Consumer()
+{
+    for (auto evt : m_scheduled_events) {
+        em->deschedule(evt);
+        delete evt;
+    }
+    for (auto evt : m_free_events)
+        delete evt;
+}
+
 void
 Consumer::scheduleEvent(Cycles timeDelta)
 {
     scheduleEventAbsolute(em->clockEdge(timeDelta));
 }
 
+bool
+Consumer::alreadyScheduled(Tick time) const
+{
+    if (time == m_last_wakeup)
+        return true;
+    for (auto evt : m_scheduled_events) {
+        if (evt->when() == time)
+            return true;
+    }
+    return false;
+}
+
 void
 Consumer::scheduleEventAbsolute(Tick evt_time)
 {
-    if (!alreadyScheduled(evt_time)) {
-        // This wakeup is not redundant
-        ConsumerEvent *evt = new ConsumerEvent(this);
-        em->schedule(evt, evt_time);
-        insertScheduledWakeupTime(evt_time);
+    if (alreadyScheduled(evt_time)) {
+        // This wakeup is redundant
+        return;
     }
 
-    Tick t = em->clockEdge();
-    set<Tick>::iterator bit = m_scheduled_wakeups.begin();
-    set<Tick>::iterator eit = m_scheduled_wakeups.lower_bound(t);
-    m_scheduled_wakeups.erase(bit,eit);
+    ConsumerEvent *evt;
+    if (m_free_events.empty()) {
+        evt = new ConsumerEvent(this);
+    } else {
+        evt = m_free_events.back();
+        m_free_events.pop_back();
+    }
+    em->schedule(evt, evt_time);
+    m_scheduled_events.push_back(evt);
+}
+
+void
+Consumer::processWakeup(ConsumerEvent *evt)
+{
+    m_last_wakeup = curTick();
+
+    auto it = find(m_scheduled_events.begin(), m_scheduled_events.end(),
+                   evt);
+    assert(it != m_scheduled_events.end());
+    *it = m_scheduled_events.back();
+    m_scheduled_events.pop_back();
+    m_free_events.push_back(evt);
+
+    wakeup();
 }
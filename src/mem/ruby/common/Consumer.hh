@@ -30,66 +30,72 @@
  * This is the virtual base class of all classes that can be the
  * targets of wakeup events.  There is only two methods, wakeup() and
  * print() and no data members.
+ *
+ * Every consumer keeps a small pool of wakeup events that are reused
+ * rather than allocated for each wakeup. Requests for a tick that is
+ * already pending are coalesced, whichever port they come from; any
+ * other tick gets an event from the pool, scheduled right away so
+ * that wakeups sharing a tick run in the order they were requested.
  */
 
 #ifndef __MEM_RUBY_COMMON_CONSUMER_HH__
 #define __MEM_RUBY_COMMON_CONSUMER_HH__
 
 #include <iostream>
-#include <set>
+#include <vector>
 
 #include "sim/clocked_object.hh"
 
 class Consumer
 {
   public:
-    Consumer(ClockedObject *_em)
-        : em(_em)
-    {
-    }
+    Consumer(ClockedObject *_em);
 
-    virtual
-    ~Consumer()
-    { }
+    virtual ~Consumer();
 
     virtual void wakeup() = 0;
     virtual void print(std::ostream& out) const = 0;
     virtual void storeEventInfo(int info) {}
 
-    bool
-    alreadyScheduled(Tick time)
-    {
-        return m_scheduled_wakeups.find(time) != m_scheduled_wakeups.end();
-    }
-
-    void
-    insertScheduledWakeupTime(Tick time)
-    {
-        m_scheduled_wakeups.insert(time);
-    }
+    bool alreadyScheduled(Tick time) const;
 
     void scheduleEventAbsolute(Tick timeAbs);
 
+    //! Event queue the wakeups, and thus this consumer, run on
+    EventQueue *wakeupEventQueue() const { return em->eventQueue(); }
+
   protected:
     void scheduleEvent(Cycles timeDelta);
 
   private:
-    std::set<Tick> m_scheduled_wakeups;
+    class ConsumerEvent;
+
+    void processWakeup(ConsumerEvent *evt);
+
     ClockedObject *em;
 
     class ConsumerEvent : public Event
     {
       public:
           ConsumerEvent(Consumer* _consumer)
-              : Event(Default_Pri, AutoDelete), m_consumer_ptr(_consumer)
+              : Event(Default_Pri), m_consumer_ptr(_consumer)
           {
           }
 
-          void process() { m_consumer_ptr->wakeup(); }
+          void process() { m_consumer_ptr->processWakeup(this); }
 
       private:
           Consumer* m_consumer_ptr;
     };
+
+    //! Tick of the last wakeup, further requests for it are dropped
+    Tick m_last_wakeup;
+
+    //! Events of the pending wakeups, one per tick
+    std::vector<ConsumerEvent*> m_scheduled_events;
+
+    //! Events that have fired, to be reused
+    std::vector<ConsumerEvent*> m_free_events;
 };
 
 inline std::ostream&
@@ -29,25 +29,132 @@
 #include "mem/ruby/common/NetDest.hh"
 
 #include <algorithm>
+#include <cstring>
+
+#include "base/bitfield.hh"
 
 NetDest::NetDest()
+    : m_words(m_inline), m_num_words(0), m_capacity(NETDEST_INLINE_WORDS)
+{
+    resize();
+}
+
+NetDest::NetDest(const NetDest& obj)
+    : m_words(m_inline), m_num_words(0), m_capacity(NETDEST_INLINE_WORDS)
+{
+    growTo(obj.m_num_words);
+    std::memcpy(m_words, obj.m_words, m_num_words * sizeof(uint64_t));
+}
+
+NetDest&
+NetDest::operator=(const NetDest& obj)
+{
+    if (this == &obj)
+        return *this;
+
+    if (obj.m_num_words > m_capacity) {
+        if (m_words != m_inline)
+            delete [] m_words;
+        m_words = new uint64_t[obj.m_num_words];
+        m_capacity = obj.m_num_words;
+    }
+    m_num_words = obj.m_num_words;
+    std::memcpy(m_words, obj.m_words, m_num_words * sizeof(uint64_t));
+    return *this;
+}
+
+int
+NetDest::numWordsNeeded()
+{
+    int num_nodes = MachineType_base_number(MachineType_NUM);
+    return (num_nodes + BITS_PER_WORD - 1) / BITS_PER_WORD;
+}
+
+// Controllers are still being constructed when some NetDests are built,
+// so a set may be narrower than the final system; the word array grows
+// on demand and missing words always read as zero.
+void
+NetDest::growTo(int num_words)
+{
+    if (num_words <= m_num_words)
+        return;
+
+    if (num_words > m_capacity) {
+        uint64_t *words = new uint64_t[num_words];
+        std::memcpy(words, m_words, m_num_words * sizeof(uint64_t));
+        if (m_words != m_inline)
+            delete [] m_words;
+        m_words = words;
+        m_capacity = num_words;
+    }
+    std::fill(m_words + m_num_words, m_words + num_words, 0);
+    m_num_words = num_words;
+}
+
+void
+NetDest::setBit(int index)
+{
+    int w = index / BITS_PER_WORD;
+    growTo(w + 1);
+    m_words[w] |= ULL(1) << (index % BITS_PER_WORD);
+}
+
+// Sets the bits in [first, last)
+void
+NetDest::setRange(int first, int last)
 {
-  resize();
+    if (first >= last)
+        return;
+
+    growTo((last + BITS_PER_WORD - 1) / BITS_PER_WORD);
+    int first_word = first / BITS_PER_WORD;
+    int last_word = (last - 1) / BITS_PER_WORD;
+    uint64_t first_mask = ~ULL(0) << (first % BITS_PER_WORD);
+    uint64_t last_mask =
+        ~ULL(0) >> (BITS_PER_WORD - 1 - (last - 1) % BITS_PER_WORD);
+
+    if (first_word == last_word) {
+        m_words[first_word] |= first_mask & last_mask;
+        return;
+    }
+    m_words[first_word] |= first_mask;
+    for (int i = first_word + 1; i < last_word; i++) {
+        m_words[i] = ~ULL(0);
+    }
+    m_words[last_word] |= last_mask;
+}
+
+// Returns the position of the first set bit at or after index, or -1
+int
+NetDest::findFrom(int index) const
+{
+    int w = index / BITS_PER_WORD;
+    if (w >= m_num_words)
+        return -1;
+
+    uint64_t bits = m_words[w] & (~ULL(0) << (index % BITS_PER_WORD));
+    while (true) {
+        if (bits)
+            return w * BITS_PER_WORD + findLsbSet(bits);
+        if (++w >= m_num_words)
+            return -1;
+        bits = m_words[w];
+    }
 }
 
 void
 NetDest::add(MachineID newElement)
 {
-    assert(bitIndex(newElement.num) < m_bits[vecIndex(newElement)].getSize());
-    m_bits[vecIndex(newElement)].add(bitIndex(newElement.num));
+    assert(newElement.num < MachineType_base_count(newElement.type));
+    setBit(bitIndex(newElement));
 }
 
 void
 NetDest::addNetDest(const NetDest& netDest)
 {
-    assert(m_bits.size() == netDest.getSize());
-    for (int i = 0; i < m_bits.size(); i++) {
-        m_bits[i].addSet(netDest.m_bits[i]);
+    growTo(netDest.m_num_words);
+    for (int i = 0; i < netDest.m_num_words; i++) {
+        m_words[i] |= netDest.m_words[i];
     }
 }
 
@@ -57,48 +164,52 @@ NetDest::setNetDest(MachineType machine, const Set& set)
     // assure that there is only one set of destinations for this machine
     assert(MachineType_base_level((MachineType)(machine + 1)) -
            MachineType_base_level(machine) == 1);
-    m_bits[MachineType_base_level(machine)] = set;
+
+    int count = MachineType_base_count(machine);
+    for (NodeID i = 0; i < count; i++) {
+        MachineID mach = {machine, i};
+        if (i < set.getSize() && set.isElement(i))
+            add(mach);
+        else
+            remove(mach);
+    }
 }
 
 void
 NetDest::remove(MachineID oldElement)
 {
-    m_bits[vecIndex(oldElement)].remove(bitIndex(oldElement.num));
+    int index = bitIndex(oldElement);
+    int w = index / BITS_PER_WORD;
+    if (w < m_num_words)
+        m_words[w] &= ~(ULL(1) << (index % BITS_PER_WORD));
 }
 
 void
 NetDest::removeNetDest(const NetDest& netDest)
 {
-    assert(m_bits.size() == netDest.getSize());
-    for (int i = 0; i < m_bits.size(); i++) {
-        m_bits[i].removeSet(netDest.m_bits[i]);
+    int n = std::min(m_num_words, netDest.m_num_words);
+    for (int i = 0; i < n; i++) {
+        m_words[i] &= ~netDest.m_words[i];
     }
 }
 
 void
 NetDest::clear()
 {
-    for (int i = 0; i < m_bits.size(); i++) {
-        m_bits[i].clear();
-    }
+    std::fill(m_words, m_words + m_num_words, 0);
 }
 
 void
 NetDest::broadcast()
 {
-    for (MachineType machine = MachineType_FIRST;
-         machine < MachineType_NUM; ++machine) {
-        broadcast(machine);
-    }
+    setRange(0, MachineType_base_number(MachineType_NUM));
 }
 
 void
 NetDest::broadcast(MachineType machineType)
 {
-    for (NodeID i = 0; i < MachineType_base_count(machineType); i++) {
-        MachineID mach = {machineType, i};
-        add(mach);
-    }
+    int base = MachineType_base_number(machineType);
+    setRange(base, base + MachineType_base_count(machineType));
 }
 
 //For Princeton Network
@@ -106,14 +217,8 @@ std::vector<NodeID>
 NetDest::getAllDest()
 {
     std::vector<NodeID> dest;
-    dest.clear();
-    for (int i = 0; i < m_bits.size(); i++) {
-        for (int j = 0; j < m_bits[i].getSize(); j++) {
-            if (m_bits[i].isElement(j)) {
-                int id = MachineType_base_number((MachineType)i) + j;
-                dest.push_back((NodeID)id);
-            }
-        }
+    for (int n = firstElement(); n >= 0; n = nextElement(n)) {
+        dest.push_back((NodeID)n);
     }
     return dest;
 }
@@ -122,8 +227,8 @@ int
 NetDest::count() const
 {
     int counter = 0;
-    for (int i = 0; i < m_bits.size(); i++) {
-        counter += m_bits[i].count();
+    for (int i = 0; i < m_num_words; i++) {
+        counter += popCount(m_words[i]);
     }
     return counter;
 }
@@ -131,19 +236,19 @@ NetDest::count() const
 NodeID
 NetDest::elementAt(MachineID index)
 {
-    return m_bits[vecIndex(index)].elementAt(bitIndex(index.num));
+    return isElement(index);
 }
 
 MachineID
 NetDest::smallestElement() const
 {
     assert(count() > 0);
-    for (int i = 0; i < m_bits.size(); i++) {
-        for (NodeID j = 0; j < m_bits[i].getSize(); j++) {
-            if (m_bits[i].isElement(j)) {
-                MachineID mach = {MachineType_from_base_level(i), j};
-                return mach;
-            }
+    int index = firstElement();
+    for (MachineType m = MachineType_FIRST; m < MachineType_NUM; ++m) {
+        int base = MachineType_base_number(m);
+        if (index < base + MachineType_base_count(m)) {
+            MachineID mach = {m, (NodeID)(index - base)};
+            return mach;
         }
     }
     panic("No smallest element of an empty set.");
@@ -152,12 +257,11 @@ NetDest::smallestElement() const
 MachineID
 NetDest::smallestElement(MachineType machine) const
 {
-    int size = m_bits[MachineType_base_level(machine)].getSize();
-    for (NodeID j = 0; j < size; j++) {
-        if (m_bits[MachineType_base_level(machine)].isElement(j)) {
-            MachineID mach = {machine, j};
-            return mach;
-        }
+    int base = MachineType_base_number(machine);
+    int index = findFrom(base);
+    if (index >= 0 && index < base + MachineType_base_count(machine)) {
+        MachineID mach = {machine, (NodeID)(index - base)};
+        return mach;
     }
 
     panic("No smallest element of given MachineType.");
@@ -167,8 +271,18 @@ NetDest::smallestElement(MachineType machine) const
 bool
 NetDest::isBroadcast() const
 {
-    for (int i = 0; i < m_bits.size(); i++) {
-        if (!m_bits[i].isBroadcast()) {
+    int num_nodes = MachineType_base_number(MachineType_NUM);
+    int full_words = num_nodes / BITS_PER_WORD;
+    for (int i = 0; i < full_words; i++) {
+        if (word(i) != ~ULL(0)) {
+            return false;
+        }
+    }
+
+    int rest = num_nodes % BITS_PER_WORD;
+    if (rest) {
+        uint64_t mask = (ULL(1) << rest) - 1;
+        if ((word(full_words) & mask) != mask) {
             return false;
         }
     }
@@ -179,8 +293,8 @@ NetDest::isBroadcast() const
 bool
 NetDest::isEmpty() const
 {
-    for (int i = 0; i < m_bits.size(); i++) {
-        if (!m_bits[i].isEmpty()) {
+    for (int i = 0; i < m_num_words; i++) {
+        if (m_words[i]) {
             return false;
         }
     }
@@ -191,11 +305,8 @@ NetDest::isEmpty() const
 NetDest
 NetDest::OR(const NetDest& orNetDest) const
 {
-    assert(m_bits.size() == orNetDest.getSize());
-    NetDest result;
-    for (int i = 0; i < m_bits.size(); i++) {
-        result.m_bits[i] = m_bits[i].OR(orNetDest.m_bits[i]);
-    }
+    NetDest result(*this);
+    result.addNetDest(orNetDest);
     return result;
 }
 
@@ -203,10 +314,9 @@ NetDest::OR(const NetDest& orNetDest) const
 NetDest
 NetDest::AND(const NetDest& andNetDest) const
 {
-    assert(m_bits.size() == andNetDest.getSize());
-    NetDest result;
-    for (int i = 0; i < m_bits.size(); i++) {
-        result.m_bits[i] = m_bits[i].AND(andNetDest.m_bits[i]);
+    NetDest result(*this);
+    for (int i = 0; i < result.m_num_words; i++) {
+        result.m_words[i] &= andNetDest.word(i);
     }
     return result;
 }
@@ -215,9 +325,9 @@ NetDest::AND(const NetDest& andNetDest) const
 bool
 NetDest::intersectionIsNotEmpty(const NetDest& other_netDest) const
 {
-    assert(m_bits.size() == other_netDest.getSize());
-    for (int i = 0; i < m_bits.size(); i++) {
-        if (!m_bits[i].intersectionIsEmpty(other_netDest.m_bits[i])) {
+    int n = std::min(m_num_words, other_netDest.m_num_words);
+    for (int i = 0; i < n; i++) {
+        if (m_words[i] & other_netDest.m_words[i]) {
             return true;
         }
     }
@@ -227,10 +337,8 @@ NetDest::intersectionIsNotEmpty(const NetDest& other_netDest) const
 bool
 NetDest::isSuperset(const NetDest& test) const
 {
-    assert(m_bits.size() == test.getSize());
-
-    for (int i = 0; i < m_bits.size(); i++) {
-        if (!m_bits[i].isSuperset(test.m_bits[i])) {
+    for (int i = 0; i < test.m_num_words; i++) {
+        if (test.m_words[i] & ~word(i)) {
             return false;
         }
     }
@@ -240,28 +348,26 @@ NetDest::isSuperset(const NetDest& test) const
 bool
 NetDest::isElement(MachineID element) const
 {
-    return ((m_bits[vecIndex(element)])).isElement(bitIndex(element.num));
+    int index = bitIndex(element);
+    return (word(index / BITS_PER_WORD) >> (index % BITS_PER_WORD)) & 1;
 }
 
 void
 NetDest::resize()
 {
-    m_bits.resize(MachineType_base_level(MachineType_NUM));
-    assert(m_bits.size() == MachineType_NUM);
-
-    for (int i = 0; i < m_bits.size(); i++) {
-        m_bits[i].setSize(MachineType_base_count((MachineType)i));
-    }
+    growTo(numWordsNeeded());
+    clear();
 }
 
 void
 NetDest::print(std::ostream& out) const
 {
-    out << "[NetDest (" << m_bits.size() << ") ";
+    out << "[NetDest (" << MachineType_NUM << ") ";
 
-    for (int i = 0; i < m_bits.size(); i++) {
-        for (int j = 0; j < m_bits[i].getSize(); j++) {
-            out << (bool) m_bits[i].isElement(j) << " ";
+    for (MachineType m = MachineType_FIRST; m < MachineType_NUM; ++m) {
+        for (NodeID j = 0; j < MachineType_base_count(m); j++) {
+            MachineID mach = {m, j};
+            out << isElement(mach) << " ";
         }
         out << " - ";
     }
@@ -271,9 +377,9 @@ NetDest::print(std::ostream& out) const
 bool
 NetDest::isEqual(const NetDest& n) const
 {
-    assert(m_bits.size() == n.m_bits.size());
-    for (unsigned int i = 0; i < m_bits.size(); ++i) {
-        if (!m_bits[i].isEqual(n.m_bits[i]))
+    int num_words = std::max(m_num_words, n.m_num_words);
+    for (int i = 0; i < num_words; ++i) {
+        if (word(i) != n.word(i))
             return false;
     }
     return true;
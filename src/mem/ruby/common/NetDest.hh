@@ -29,13 +29,25 @@
 #ifndef __MEM_RUBY_COMMON_NETDEST_HH__
 #define __MEM_RUBY_COMMON_NETDEST_HH__
 
+#include <cstdint>
 #include <iostream>
 #include <vector>
 
 #include "mem/ruby/common/Set.hh"
 #include "mem/ruby/common/MachineID.hh"
 
+// Number of 64-bit words stored inside every NetDest. Systems with up to
+// 64 * NETDEST_INLINE_WORDS controllers never touch the heap when a
+// destination set is created, copied or combined; larger systems fall
+// back to a heap allocated word array.
+const int NETDEST_INLINE_WORDS = 8;
+
 // NetDest specifies the network destination of a Message
+//
+// The destinations are kept in one flat bitmap indexed by the global
+// node number of a machine (MachineType_base_number(type) + num), so set
+// operations work a 64-bit word at a time regardless of how the nodes
+// are spread over machine types.
 class NetDest
 {
   public:
@@ -43,11 +55,16 @@ class NetDest
     // creates and empty set
     NetDest();
     explicit NetDest(int bit_size);
+    NetDest(const NetDest& obj);
 
+    NetDest& operator=(const NetDest& obj);
     NetDest& operator=(const Set& obj);
 
     ~NetDest()
-    { }
+    {
+        if (m_words != m_inline)
+            delete [] m_words;
+    }
 
     void add(MachineID newElement);
     void addNetDest(const NetDest& netDest);
@@ -70,7 +87,8 @@ class NetDest
     bool intersectionIsNotEmpty(const NetDest& other_netDest) const;
 
     // Returns true if the intersection of the two netDests is empty
-    bool intersectionIsEmpty(const NetDest& other_netDest) const;
+    bool intersectionIsEmpty(const NetDest& other_netDest) const
+    { return !intersectionIsNotEmpty(other_netDest); }
 
     bool isSuperset(const NetDest& test) const;
     bool isSubset(const NetDest& test) const { return test.isSuperset(*this); }
@@ -81,11 +99,18 @@ class NetDest
     // For Princeton Network
     std::vector<NodeID> getAllDest();
 
+    // Iterate over the global node numbers of the destinations without
+    // building a vector:
+    //   for (int n = d.firstElement(); n >= 0; n = d.nextElement(n))
+    // Both return -1 once the set is exhausted.
+    int firstElement() const { return findFrom(0); }
+    int nextElement(int node) const { return findFrom(node + 1); }
+
     MachineID smallestElement() const;
     MachineID smallestElement(MachineType machine) const;
 
     void resize();
-    int getSize() const { return m_bits.size(); }
+    int getSize() const { return m_num_words * BITS_PER_WORD; }
 
     // get element for a index
     NodeID elementAt(MachineID index);
@@ -93,19 +118,33 @@ class NetDest
     void print(std::ostream& out) const;
 
   private:
-    // returns a value >= MachineType_base_level("this machine")
-    // and < MachineType_base_level("next highest machine")
+    static const int BITS_PER_WORD = 64;
+
+    // returns the position of machine m in the flat bitmap
     int
-    vecIndex(MachineID m) const
+    bitIndex(MachineID m) const
+    {
+        return MachineType_base_number(m.type) + m.num;
+    }
+
+    // number of words needed to hold every node of the current system
+    static int numWordsNeeded();
+
+    uint64_t
+    word(int i) const
     {
-        int vec_index = MachineType_base_level(m.type);
-        assert(vec_index < m_bits.size());
-        return vec_index;
+        return i < m_num_words ? m_words[i] : 0;
     }
 
-    NodeID bitIndex(NodeID index) const { return index; }
+    void setBit(int index);
+    void setRange(int first, int last);
+    void growTo(int num_words);
+    int findFrom(int index) const;
 
-    std::vector<Set> m_bits;  // a vector of bit vectors - i.e. Sets
+    uint64_t *m_words;
+    int m_num_words;
+    int m_capacity;
+    uint64_t m_inline[NETDEST_INLINE_WORDS];
 };
 
 inline std::ostream&
@@ -53,6 +53,25 @@ class AbstractBloomFilter
     virtual int getIndex(Addr addr) = 0;
     virtual int readBit(const int index) = 0;
     virtual void writeBit(const int index, const int value) = 0;
+
+    /**
+     * Set, or test, count addresses at once. The default versions
+     * loop over the single address calls; filters that can hash a
+     * batch of addresses before touching their bits override them.
+     */
+    virtual void
+    setBatch(const Addr *addrs, int count)
+    {
+        for (int i = 0; i < count; i++)
+            set(addrs[i]);
+    }
+
+    virtual void
+    isSetBatch(const Addr *addrs, int count, bool *result)
+    {
+        for (int i = 0; i < count; i++)
+            result[i] = isSet(addrs[i]);
+    }
 };
 
 #endif // __MEM_RUBY_FILTERS_ABSTRACTBLOOMFILTER_HH__
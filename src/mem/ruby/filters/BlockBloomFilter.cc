@@ -35,83 +35,19 @@
 using namespace std;
 
 BlockBloomFilter::BlockBloomFilter(int size)
+    : PackedBloomFilter(size, 1)
 {
-    m_filter_size = size;
     m_filter_size_bits = floorLog2(m_filter_size);
-
-    m_filter.resize(m_filter_size);
-
-    clear();
 }
 
 BlockBloomFilter::~BlockBloomFilter()
 {
 }
 
-void
-BlockBloomFilter::clear()
-{
-    for (int i = 0; i < m_filter_size; i++) {
-        m_filter[i] = 0;
-    }
-}
-
-void
-BlockBloomFilter::increment(Addr addr)
-{
-    // Not used
-}
-
-void
-BlockBloomFilter::decrement(Addr addr)
-{
-    // Not used
-}
-
-void
-BlockBloomFilter::merge(AbstractBloomFilter * other_filter)
-{
-    // TODO
-}
-
-void
-BlockBloomFilter::set(Addr addr)
-{
-    int i = get_index(addr);
-    m_filter[i] = 1;
-}
-
 void
 BlockBloomFilter::unset(Addr addr)
 {
-    int i = get_index(addr);
-    m_filter[i] = 0;
-}
-
-bool
-BlockBloomFilter::isSet(Addr addr)
-{
-    int i = get_index(addr);
-    return (m_filter[i]);
-}
-
-int
-BlockBloomFilter::getCount(Addr addr)
-{
-    return m_filter[get_index(addr)];
-}
-
-int
-BlockBloomFilter::getTotalCount()
-{
-    int count = 0;
-
-    for (int i = 0; i < m_filter_size; i++) {
-        if (m_filter[i]) {
-            count++;
-        }
-    }
-    return count;
+    clearBit(get_index(addr));
 }
 
 int
@@ -121,20 +57,9 @@ BlockBloomFilter::getIndex(Addr addr)
 }
 
 void
-BlockBloomFilter::print(ostream& out) const
-{
-}
-
-int
-BlockBloomFilter::readBit(const int index)
-{
-    return m_filter[index];
-}
-
-void
-BlockBloomFilter::writeBit(const int index, const int value)
+BlockBloomFilter::getIndices(Addr addr, int *indices)
 {
-    m_filter[index] = value;
+    indices[0] = get_index(addr);
 }
 
 int
@@ -30,38 +30,25 @@
 #define __MEM_RUBY_FILTERS_BLOCKBLOOMFILTER_HH__
 
 #include <iostream>
-#include <vector>
 
 #include "mem/ruby/common/Address.hh"
-#include "mem/ruby/filters/AbstractBloomFilter.hh"
+#include "mem/ruby/filters/PackedBloomFilter.hh"
 
-class BlockBloomFilter : public AbstractBloomFilter
+class BlockBloomFilter : public PackedBloomFilter
 {
   public:
     BlockBloomFilter(int size);
     ~BlockBloomFilter();
 
-    void clear();
-    void increment(Addr addr);
-    void decrement(Addr addr);
-    void merge(AbstractBloomFilter * other_filter);
-    void set(Addr addr);
     void unset(Addr addr);
-
-    bool isSet(Addr addr);
-    int getCount(Addr addr);
-    int getTotalCount();
     int getIndex(Addr addr);
-    int readBit(const int index);
-    void writeBit(const int index, const int value);
 
-    void print(std::ostream& out) const;
+  protected:
+    void getIndices(Addr addr, int *indices);
 
   private:
     int get_index(Addr addr);
 
-    std::vector<int> m_filter;
-    int m_filter_size;
     int m_filter_size_bits;
 };
 
@@ -37,20 +37,11 @@
 using namespace std;
 
 BulkBloomFilter::BulkBloomFilter(int size)
+    : PackedBloomFilter(size, 2)
 {
-    m_filter_size = size;
     m_filter_size_bits = floorLog2(m_filter_size);
     // split the filter bits in half, c0 and c1
     m_sector_bits = m_filter_size_bits - 1;
-
-    m_temp_filter.resize(m_filter_size);
-    m_filter.resize(m_filter_size);
-    clear();
-
-    // clear temp filter
-    for (int i = 0; i < m_filter_size; ++i) {
-        m_temp_filter[i] = 0;
-    }
 }
 
 BulkBloomFilter::~BulkBloomFilter()
@@ -58,33 +49,26 @@ BulkBloomFilter::~BulkBloomFilter()
 }
 
 void
-BulkBloomFilter::clear()
-{
-    for (int i = 0; i < m_filter_size; i++) {
-        m_filter[i] = 0;
-    }
-}
-
-void
-BulkBloomFilter::increment(Addr addr)
+BulkBloomFilter::unset(Addr addr)
 {
-    // Not used
+    // not used
 }
 
-void
-BulkBloomFilter::decrement(Addr addr)
+int
+BulkBloomFilter::getCount(Addr addr)
 {
-    // Not used
+    // not used
+    return 0;
 }
 
-void
-BulkBloomFilter::merge(AbstractBloomFilter * other_filter)
+int
+BulkBloomFilter::getIndex(Addr addr)
 {
-    // TODO
+    return get_index(addr);
 }
 
 void
-BulkBloomFilter::set(Addr addr)
+BulkBloomFilter::getIndices(Addr addr, int *indices)
 {
     // c0 contains the cache index bits
     int set_bits = m_sector_bits;
@@ -97,115 +81,14 @@ BulkBloomFilter::set(Addr addr)
     //assert(c0 < (m_filter_size/2));
     //assert(c0 + (m_filter_size/2) < m_filter_size);
     //assert(c1 < (m_filter_size/2));
-    // set v0 bit
-    m_filter[c0 + (m_filter_size/2)] = 1;
-    // set v1 bit
-    m_filter[c1] = 1;
-}
-
-void
-BulkBloomFilter::unset(Addr addr)
-{
-    // not used
-}
 
-bool
-BulkBloomFilter::isSet(Addr addr)
-{
-    // c0 contains the cache index bits
-    int set_bits = m_sector_bits;
-    int block_bits = RubySystem::getBlockSizeBits();
-    int c0 = bitSelect(addr, block_bits, block_bits + set_bits - 1);
-    // c1 contains the lower 10 permuted bits
-    //Address permuted_bits = permute(addr);
-    //int c1 = permuted_bits.bitSelect(0, set_bits-1);
-    int c1 = bitSelect(addr, block_bits+set_bits, (block_bits+2*set_bits) - 1);
-    //assert(c0 < (m_filter_size/2));
-    //assert(c0 + (m_filter_size/2) < m_filter_size);
-    //assert(c1 < (m_filter_size/2));
-    // set v0 bit
-    m_temp_filter[c0 + (m_filter_size/2)] = 1;
-    // set v1 bit
-    m_temp_filter[c1] = 1;
-
-    // perform filter intersection. If any c part is 0, no possibility
-    // of address being in signature.  get first c intersection part
-    bool zero = false;
-    for (int i = 0; i < m_filter_size/2; ++i){
-        // get intersection of signatures
-        m_temp_filter[i] = m_temp_filter[i] && m_filter[i];
-        zero = zero || m_temp_filter[i];
-    }
-    zero = !zero;
-    if (zero) {
-        // one section is zero, no possiblility of address in signature
-        // reset bits we just set
-        m_temp_filter[c0 + (m_filter_size / 2)] = 0;
-        m_temp_filter[c1] = 0;
-        return false;
-    }
-
-    // check second section
-    zero = false;
-    for (int i = m_filter_size / 2; i < m_filter_size; ++i) {
-        // get intersection of signatures
-        m_temp_filter[i] =  m_temp_filter[i] && m_filter[i];
-        zero = zero || m_temp_filter[i];
-    }
-    zero = !zero;
-    if (zero) {
-        // one section is zero, no possiblility of address in signature
-        m_temp_filter[c0 + (m_filter_size / 2)] = 0;
-        m_temp_filter[c1] = 0;
-        return false;
-    }
-    // one section has at least one bit set
-    m_temp_filter[c0 + (m_filter_size / 2)] = 0;
-    m_temp_filter[c1] = 0;
-    return true;
-}
-
-int
-BulkBloomFilter::getCount(Addr addr)
-{
-    // not used
-    return 0;
-}
-
-int
-BulkBloomFilter::getTotalCount()
-{
-    int count = 0;
-    for (int i = 0; i < m_filter_size; i++) {
-        if (m_filter[i]) {
-            count++;
-        }
-    }
-    return count;
-}
-
-int
-BulkBloomFilter::getIndex(Addr addr)
-{
-    return get_index(addr);
-}
-
-int
-BulkBloomFilter::readBit(const int index)
-{
-    return 0;
-    // TODO
-}
-
-void
-BulkBloomFilter::writeBit(const int index, const int value)
-{
-    // TODO
-}
-
-void
-BulkBloomFilter::print(ostream& out) const
-{
+    // v0 bit, in the second half of the filter
+    indices[0] = c0 + (m_filter_size/2);
+    // v1 bit, in the first half. An address is in the signature if the
+    // intersection of its signature with the filter is not empty in
+    // either half, and each half of its signature has a single bit, so
+    // this is the same as both bits being set.
+    indices[1] = c1;
 }
 
 int
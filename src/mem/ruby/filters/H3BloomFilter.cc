@@ -32,7 +32,7 @@
 
 using namespace std;
 
-static int H3[64][16] = {
+static const uint32_t H3[64][16] = {
     { 33268410,   395488709,  311024285,  456111753,
       181495008,  119997521,  220697869,  433891432,
       755927921,  515226970,  719448198,  349842774,
@@ -355,6 +355,7 @@ static int H3[64][16] = {
 };
 
 H3BloomFilter::H3BloomFilter(int size, int hashes, bool parallel)
+    : PackedBloomFilter(size, hashes)
 {
     //TODO: change this ugly init code...
     primes_list[0] = 9323;
@@ -378,62 +379,22 @@ H3BloomFilter::H3BloomFilter(int size, int hashes, bool parallel)
     adds_list[4] = 7777;
     adds_list[5] = 65931;
 
-    m_filter_size = size;
-    m_num_hashes = hashes;
     isParallel = parallel;
 
     m_filter_size_bits = floorLog2(m_filter_size);
 
     m_par_filter_size = m_filter_size / m_num_hashes;
     m_par_filter_size_bits = floorLog2(m_par_filter_size);
+    setHashRange(isParallel ? m_par_filter_size : m_filter_size);
 
-    m_filter.resize(m_filter_size);
-    clear();
+    // Hash all 64 address bits, one table lookup per address byte
+    buildHashTable(64, [](int bit, int hash) { return H3[bit][hash]; });
 }
 
 H3BloomFilter::~H3BloomFilter()
 {
 }
 
-void
-H3BloomFilter::clear()
-{
-    for (int i = 0; i < m_filter_size; i++) {
-        m_filter[i] = 0;
-    }
-}
-
-void
-H3BloomFilter::increment(Addr addr)
-{
-    // Not used
-}
-
-void
-H3BloomFilter::decrement(Addr addr)
-{
-    // Not used
-}
-
-void
-H3BloomFilter::merge(AbstractBloomFilter *other_filter)
-{
-    // assumes both filters are the same size!
-    H3BloomFilter * temp = (H3BloomFilter*) other_filter;
-    for (int i = 0; i < m_filter_size; ++i){
-        m_filter[i] |= (*temp)[i];
-    }
-}
-
-void
-H3BloomFilter::set(Addr addr)
-{
-    for (int i = 0; i < m_num_hashes; i++) {
-        int idx = get_index(addr, i);
-        m_filter[idx] = 1;
-    }
-}
-
 void
 H3BloomFilter::unset(Addr addr)
 {
@@ -441,82 +402,24 @@ H3BloomFilter::unset(Addr addr)
     assert(0);
 }
 
-bool
-H3BloomFilter::isSet(Addr addr)
-{
-    bool res = true;
-
-    for (int i = 0; i < m_num_hashes; i++) {
-        int idx = get_index(addr, i);
-        res = res && m_filter[idx];
-    }
-    return res;
-}
-
-int
-H3BloomFilter::getCount(Addr addr)
-{
-    return isSet(addr)? 1: 0;
-}
-
 int
 H3BloomFilter::getIndex(Addr addr)
 {
     return 0;
 }
 
-int
-H3BloomFilter::readBit(const int index)
-{
-    return 0;
-}
-
-void
-H3BloomFilter::writeBit(const int index, const int value)
-{
-}
-
-int
-H3BloomFilter::getTotalCount()
-{
-    int count = 0;
-
-    for (int i = 0; i < m_filter_size; i++) {
-        count += m_filter[i];
-    }
-    return count;
-}
-
 void
-H3BloomFilter::print(ostream& out) const
-{
-}
-
-int
-H3BloomFilter::get_index(Addr addr, int i)
+H3BloomFilter::getIndices(Addr addr, int *indices)
 {
     uint64_t x = makeLineAddress(addr);
     // uint64_t y = (x*mults_list[i] + adds_list[i]) % primes_list[i];
-    int y = hash_H3(x,i);
+    uint32_t y[MaxHashes];
+    hashAll(x, y);
 
-    if (isParallel) {
-        return (y % m_par_filter_size) + i*m_par_filter_size;
-    } else {
-        return y % m_filter_size;
-    }
-}
-
-int
-H3BloomFilter::hash_H3(uint64_t value, int index)
-{
-    uint64_t mask = 1;
-    uint64_t val = value;
-    int result = 0;
-
-    for (int i = 0; i < 64; i++) {
-        if (val&mask) result ^= H3[i][index];
-        val = val >> 1;
+    // the hashes are folded into m_par_filter_size when parallel
+    for (int i = 0; i < m_num_hashes; i++) {
+        indices[i] = foldHash(y[i]);
+        if (isParallel)
+            indices[i] += i*m_par_filter_size;
     }
-    return result;
 }
-
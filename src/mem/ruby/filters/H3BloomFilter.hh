@@ -30,47 +30,23 @@
 #define __MEM_RUBY_FILTERS_H3BLOOMFILTER_HH__
 
 #include <iostream>
-#include <vector>
 
 #include "mem/ruby/common/Address.hh"
-#include "mem/ruby/filters/AbstractBloomFilter.hh"
+#include "mem/ruby/filters/PackedBloomFilter.hh"
 
-class H3BloomFilter : public AbstractBloomFilter
+class H3BloomFilter : public PackedBloomFilter
 {
   public:
     H3BloomFilter(int size, int hashes, bool parallel);
     ~H3BloomFilter();
 
-    void clear();
-    void increment(Addr addr);
-    void decrement(Addr addr);
-    void merge(AbstractBloomFilter * other_filter);
-    void set(Addr addr);
     void unset(Addr addr);
-
-    bool isSet(Addr addr);
-    int getCount(Addr addr);
-    int getTotalCount();
-    void print(std::ostream& out) const;
-
     int getIndex(Addr addr);
-    int readBit(const int index);
-    void writeBit(const int index, const int value);
 
-    int
-    operator[](const int index) const
-    {
-        return this->m_filter[index];
-    }
+  protected:
+    void getIndices(Addr addr, int *indices);
 
   private:
-    int get_index(Addr addr, int hashNumber);
-
-    int hash_H3(uint64_t value, int index);
-
-    std::vector<int> m_filter;
-    int m_filter_size;
-    int m_num_hashes;
     int m_filter_size_bits;
 
     int m_par_filter_size;
@@ -35,15 +35,22 @@
 
 using namespace std;
 
+int
+MultiBitSelBloomFilter::configValue(const string &config, int item)
+{
+    vector<string> items;
+    tokenize(items, config, '_');
+    assert(items.size() == 4);
+    return atoi(items[item].c_str());
+}
+
 MultiBitSelBloomFilter::MultiBitSelBloomFilter(string str)
+    : PackedBloomFilter(configValue(str, 0), configValue(str, 1))
 {
     vector<string> items;
     tokenize(items, str, '_');
-    assert(items.size() == 4);
 
-    // head contains filter size, tail contains bit offset from block number
-    m_filter_size = atoi(items[0].c_str());
-    m_num_hashes = atoi(items[1].c_str());
+    // filter size and number of hashes are taken by the base class
     m_skip_bits = atoi(items[2].c_str());
 
     if (items[3] == "Regular") {
@@ -59,55 +66,28 @@ MultiBitSelBloomFilter::MultiBitSelBloomFilter(string str)
 
     m_par_filter_size = m_filter_size / m_num_hashes;
     m_par_filter_size_bits = floorLog2(m_par_filter_size);
-
-    m_filter.resize(m_filter_size);
-    clear();
+    setHashRange(isParallel ? m_par_filter_size : m_filter_size);
+
+    // Bit i of hash j is address bit (j + m_num_hashes * i) % 30, for
+    // the m_filter_size_bits low bits of the hash (36-bit addresses,
+    // 6-bit cache lines)
+    const int max_bits = 30;
+    int num_hashes = m_num_hashes;
+    int num_bits = m_filter_size_bits;
+    buildHashTable(max_bits, [=](int bit, int hash) {
+        uint32_t row = 0;
+        for (int i = 0; i < num_bits; i++) {
+            if ((hash + num_hashes * i) % max_bits == bit)
+                row |= 1U << i;
+        }
+        return row;
+    });
 }
 
 MultiBitSelBloomFilter::~MultiBitSelBloomFilter()
 {
 }
 
-void
-MultiBitSelBloomFilter::clear()
-{
-    for (int i = 0; i < m_filter_size; i++) {
-        m_filter[i] = 0;
-    }
-}
-
-void
-MultiBitSelBloomFilter::increment(Addr addr)
-{
-    // Not used
-}
-
-
-void
-MultiBitSelBloomFilter::decrement(Addr addr)
-{
-    // Not used
-}
-
-void
-MultiBitSelBloomFilter::merge(AbstractBloomFilter *other_filter)
-{
-    // assumes both filters are the same size!
-    MultiBitSelBloomFilter * temp = (MultiBitSelBloomFilter*) other_filter;
-    for (int i = 0; i < m_filter_size; ++i){
-        m_filter[i] |= (*temp)[i];
-    }
-}
-
-void
-MultiBitSelBloomFilter::set(Addr addr)
-{
-    for (int i = 0; i < m_num_hashes; i++) {
-        int idx = get_index(addr, i);
-        m_filter[idx] = 1;
-    }
-}
-
 void
 MultiBitSelBloomFilter::unset(Addr addr)
 {
@@ -115,85 +95,26 @@ MultiBitSelBloomFilter::unset(Addr addr)
     assert(0);
 }
 
-bool
-MultiBitSelBloomFilter::isSet(Addr addr)
-{
-    bool res = true;
-
-    for (int i=0; i < m_num_hashes; i++) {
-        int idx = get_index(addr, i);
-        res = res && m_filter[idx];
-    }
-    return res;
-}
-
-int
-MultiBitSelBloomFilter::getCount(Addr addr)
-{
-    return isSet(addr)? 1: 0;
-}
-
 int
 MultiBitSelBloomFilter::getIndex(Addr addr)
 {
     return 0;
 }
 
-int
-MultiBitSelBloomFilter::readBit(const int index)
-{
-    return 0;
-}
-
-void
-MultiBitSelBloomFilter::writeBit(const int index, const int value)
-{
-}
-
-int
-MultiBitSelBloomFilter::getTotalCount()
-{
-    int count = 0;
-
-    for (int i = 0; i < m_filter_size; i++) {
-        count += m_filter[i];
-    }
-    return count;
-}
-
 void
-MultiBitSelBloomFilter::print(ostream& out) const
-{
-}
-
-int
-MultiBitSelBloomFilter::get_index(Addr addr, int i)
+MultiBitSelBloomFilter::getIndices(Addr addr, int *indices)
 {
     // m_skip_bits is used to perform BitSelect after skipping some
     // bits. Used to simulate BitSel hashing on larger than cache-line
     // granularities
     uint64_t x = (makeLineAddress(addr) >> m_skip_bits);
-    int y = hash_bitsel(x, i, m_num_hashes, 30, m_filter_size_bits);
-    //36-bit addresses, 6-bit cache lines
+    uint32_t y[MaxHashes];
+    hashAll(x, y);
 
-    if (isParallel) {
-        return (y % m_par_filter_size) + i*m_par_filter_size;
-    } else {
-        return y % m_filter_size;
-    }
-}
-
-int
-MultiBitSelBloomFilter::hash_bitsel(uint64_t value, int index, int jump,
-                                    int maxBits, int numBits)
-{
-    uint64_t mask = 1;
-    int result = 0;
-    int bit, i;
-
-    for (i = 0; i < numBits; i++) {
-        bit = (index + jump*i) % maxBits;
-        if (value & (mask << bit)) result += mask << i;
+    // the hashes are folded into m_par_filter_size when parallel
+    for (int i = 0; i < m_num_hashes; i++) {
+        indices[i] = foldHash(y[i]);
+        if (isParallel)
+            indices[i] += i*m_par_filter_size;
     }
-    return result;
 }
@@ -31,49 +31,26 @@
 
 #include <iostream>
 #include <string>
-#include <vector>
 
 #include "mem/ruby/common/Address.hh"
 #include "mem/ruby/common/TypeDefines.hh"
-#include "mem/ruby/filters/AbstractBloomFilter.hh"
+#include "mem/ruby/filters/PackedBloomFilter.hh"
 
-class MultiBitSelBloomFilter : public AbstractBloomFilter
+class MultiBitSelBloomFilter : public PackedBloomFilter
 {
   public:
     MultiBitSelBloomFilter(std::string config);
     ~MultiBitSelBloomFilter();
 
-    void clear();
-    void increment(Addr addr);
-    void decrement(Addr addr);
-    void merge(AbstractBloomFilter * other_filter);
-    void set(Addr addr);
     void unset(Addr addr);
-
-    bool isSet(Addr addr);
-    int getCount(Addr addr);
-    int getTotalCount();
-    void print(std::ostream& out) const;
-
     int getIndex(Addr addr);
-    int readBit(const int index);
-    void writeBit(const int index, const int value);
 
-    int
-    operator[](const int index) const
-    {
-        return this->m_filter[index];
-    }
+  protected:
+    void getIndices(Addr addr, int *indices);
 
   private:
-    int get_index(Addr addr, int hashNumber);
-
-    int hash_bitsel(uint64_t value, int index, int jump, int maxBits,
-                    int numBits);
+    static int configValue(const std::string &config, int item);
 
-    std::vector<int> m_filter;
-    int m_filter_size;
-    int m_num_hashes;
     int m_filter_size_bits;
     int m_skip_bits;
 
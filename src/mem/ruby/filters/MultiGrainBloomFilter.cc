@@ -28,6 +28,8 @@
 
 #include "mem/ruby/filters/MultiGrainBloomFilter.hh"
 
+#include <cassert>
+
 #include "base/intmath.hh"
 #include "base/str.hh"
 #include "mem/ruby/system/RubySystem.hh"
@@ -35,81 +37,27 @@
 using namespace std;
 
 MultiGrainBloomFilter::MultiGrainBloomFilter(int head, int tail)
+    : PackedBloomFilter(head + tail, 2)
 {
     // head contains size of 1st bloom filter, tail contains size of
     // 2nd bloom filter
-    m_filter_size = head;
-    m_filter_size_bits = floorLog2(m_filter_size);
+    m_block_filter_size = head;
+    m_filter_size_bits = floorLog2(m_block_filter_size);
 
     m_page_filter_size = tail;
     m_page_filter_size_bits = floorLog2(m_page_filter_size);
-
-    m_filter.resize(m_filter_size);
-    m_page_filter.resize(m_page_filter_size);
-    clear();
 }
 
 MultiGrainBloomFilter::~MultiGrainBloomFilter()
 {
 }
 
-void
-MultiGrainBloomFilter::clear()
-{
-    for (int i = 0; i < m_filter_size; i++) {
-        m_filter[i] = 0;
-    }
-    for (int i=0; i < m_page_filter_size; ++i){
-        m_page_filter[i] = 0;
-    }
-}
-
-void
-MultiGrainBloomFilter::increment(Addr addr)
-{
-    // Not used
-}
-
-
-void
-MultiGrainBloomFilter::decrement(Addr addr)
-{
-    // Not used
-}
-
-void
-MultiGrainBloomFilter::merge(AbstractBloomFilter *other_filter)
-{
-    // TODO
-}
-
-void
-MultiGrainBloomFilter::set(Addr addr)
-{
-    int i = get_block_index(addr);
-    assert(i < m_filter_size);
-    assert(get_page_index(addr) < m_page_filter_size);
-    m_filter[i] = 1;
-    m_page_filter[i] = 1;
-
-}
-
 void
 MultiGrainBloomFilter::unset(Addr addr)
 {
     // not used
 }
 
-bool
-MultiGrainBloomFilter::isSet(Addr addr)
-{
-    int i = get_block_index(addr);
-    assert(i < m_filter_size);
-    assert(get_page_index(addr) < m_page_filter_size);
-    // we have to have both indices set
-    return (m_filter[i] && m_page_filter[i]);
-}
-
 int
 MultiGrainBloomFilter::getCount(Addr addr)
 {
@@ -117,22 +65,6 @@ MultiGrainBloomFilter::getCount(Addr addr)
     return 0;
 }
 
-int
-MultiGrainBloomFilter::getTotalCount()
-{
-    int count = 0;
-
-    for (int i = 0; i < m_filter_size; i++) {
-        count += m_filter[i];
-    }
-
-    for (int i=0; i < m_page_filter_size; ++i) {
-        count += m_page_filter[i] = 0;
-    }
-
-    return count;
-}
-
 int
 MultiGrainBloomFilter::getIndex(Addr addr)
 {
@@ -140,22 +72,17 @@ MultiGrainBloomFilter::getIndex(Addr addr)
     // TODO
 }
 
-int
-MultiGrainBloomFilter::readBit(const int index)
-{
-    return 0;
-    // TODO
-}
-
 void
-MultiGrainBloomFilter::writeBit(const int index, const int value)
+MultiGrainBloomFilter::getIndices(Addr addr, int *indices)
 {
-    // TODO
-}
+    int i = get_block_index(addr);
+    int j = get_page_index(addr);
+    assert(i < m_block_filter_size);
+    assert(j < m_page_filter_size);
 
-void
-MultiGrainBloomFilter::print(ostream& out) const
-{
+    // we have to have both indices set
+    indices[0] = i;
+    indices[1] = m_block_filter_size + j;
 }
 
 int
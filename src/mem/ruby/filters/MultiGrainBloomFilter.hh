@@ -30,43 +30,31 @@
 #define __MEM_RUBY_FILTERS_MULTIGRAINBLOOMFILTER_HH__
 
 #include <iostream>
-#include <vector>
 
 #include "mem/ruby/common/Address.hh"
-#include "mem/ruby/filters/AbstractBloomFilter.hh"
+#include "mem/ruby/filters/PackedBloomFilter.hh"
 
-class MultiGrainBloomFilter : public AbstractBloomFilter
+class MultiGrainBloomFilter : public PackedBloomFilter
 {
   public:
     MultiGrainBloomFilter(int head, int tail);
     ~MultiGrainBloomFilter();
 
-    void clear();
-    void increment(Addr addr);
-    void decrement(Addr addr);
-    void merge(AbstractBloomFilter * other_filter);
-    void set(Addr addr);
     void unset(Addr addr);
-
-    bool isSet(Addr addr);
     int getCount(Addr addr);
-    int getTotalCount();
     int getIndex(Addr addr);
-    int readBit(const int index);
-    void writeBit(const int index, const int value);
 
-    void print(std::ostream& out) const;
+  protected:
+    void getIndices(Addr addr, int *indices);
 
   private:
     int get_block_index(Addr addr);
     int get_page_index(Addr addr);
 
-    // The block filter
-    std::vector<int> m_filter;
-    int m_filter_size;
+    // The block filter, in the first m_block_filter_size bits
+    int m_block_filter_size;
     int m_filter_size_bits;
-    // The page number filter
-    std::vector<int> m_page_filter;
+    // The page number filter, in the bits after it
     int m_page_filter_size;
     int m_page_filter_size_bits;
 };
@@ -35,92 +35,21 @@
 using namespace std;
 
 NonCountingBloomFilter::NonCountingBloomFilter(int head, int tail)
+    : PackedBloomFilter(head, 1)
 {
     // head contains filter size, tail contains bit offset from block number
-    m_filter_size = head;
     m_offset = tail;
     m_filter_size_bits = floorLog2(m_filter_size);
-
-    m_filter.resize(m_filter_size);
-    clear();
 }
 
 NonCountingBloomFilter::~NonCountingBloomFilter()
 {
 }
 
-void
-NonCountingBloomFilter::clear()
-{
-    for (int i = 0; i < m_filter_size; i++) {
-        m_filter[i] = 0;
-    }
-}
-
-void
-NonCountingBloomFilter::increment(Addr addr)
-{
-    // Not used
-}
-
-void
-NonCountingBloomFilter::decrement(Addr addr)
-{
-    // Not used
-}
-
-void
-NonCountingBloomFilter::merge(AbstractBloomFilter *other_filter)
-{
-    // assumes both filters are the same size!
-    NonCountingBloomFilter * temp = (NonCountingBloomFilter*) other_filter;
-    for (int i = 0; i < m_filter_size; ++i){
-        m_filter[i] |= (*temp)[i];
-    }
-}
-
-void
-NonCountingBloomFilter::set(Addr addr)
-{
-    int i = get_index(addr);
-    m_filter[i] = 1;
-}
-
 void
 NonCountingBloomFilter::unset(Addr addr)
 {
-    int i = get_index(addr);
-    m_filter[i] = 0;
-}
-
-bool
-NonCountingBloomFilter::isSet(Addr addr)
-{
-    int i = get_index(addr);
-    return (m_filter[i]);
-}
-
-
-int
-NonCountingBloomFilter::getCount(Addr addr)
-{
-    return m_filter[get_index(addr)];
-}
-
-int
-NonCountingBloomFilter::getTotalCount()
-{
-    int count = 0;
-
-    for (int i = 0; i < m_filter_size; i++) {
-        count += m_filter[i];
-    }
-    return count;
-}
-
-void
-NonCountingBloomFilter::print(ostream& out) const
-{
+    clearBit(get_index(addr));
 }
 
 int
@@ -129,16 +58,10 @@ NonCountingBloomFilter::getIndex(Addr addr)
     return get_index(addr);
 }
 
-int
-NonCountingBloomFilter::readBit(const int index)
-{
-    return m_filter[index];
-}
-
 void
-NonCountingBloomFilter::writeBit(const int index, const int value)
+NonCountingBloomFilter::getIndices(Addr addr, int *indices)
 {
-    m_filter[index] = value;
+    indices[0] = get_index(addr);
 }
 
 int
@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Authors: agent
+ */
+
+#include "mem/ruby/filters/PackedBloomFilter.hh"
+
+#include <cassert>
+
+#include "base/bitfield.hh"
+#include "base/intmath.hh"
+#include "base/misc.hh"
+
+using namespace std;
+
+const int PackedBloomFilter::MaxHashes;
+const int PackedBloomFilter::BatchSize;
+
+PackedBloomFilter::PackedBloomFilter(int size, int num_hashes)
+    : m_filter_size(size), m_num_hashes(num_hashes), m_hash_bytes(0),
+      m_hash_range(size), m_range_mask(0)
+{
+    fatal_if(num_hashes < 1 || num_hashes > MaxHashes,
+             "Bloom filters support 1 to %d hashes, not %d\n",
+             MaxHashes, num_hashes);
+    m_bits.resize(divCeil(m_filter_size, 64));
+    clear();
+}
+
+PackedBloomFilter::~PackedBloomFilter()
+{
+}
+
+void
+PackedBloomFilter::clear()
+{
+    fill(m_bits.begin(), m_bits.end(), 0);
+}
+
+void
+PackedBloomFilter::increment(Addr addr)
+{
+    // Not used
+}
+
+void
+PackedBloomFilter::decrement(Addr addr)
+{
+    // Not used
+}
+
+void
+PackedBloomFilter::merge(AbstractBloomFilter *other_filter)
+{
+    PackedBloomFilter *temp = (PackedBloomFilter*) other_filter;
+    assert(temp->m_filter_size == m_filter_size);
+    for (size_t i = 0; i < m_bits.size(); ++i) {
+        m_bits[i] |= temp->m_bits[i];
+    }
+}
+
+void
+PackedBloomFilter::set(Addr addr)
+{
+    int indices[MaxHashes];
+    getIndices(addr, indices);
+    for (int i = 0; i < m_num_hashes; i++) {
+        setBit(indices[i]);
+    }
+}
+
+bool
+PackedBloomFilter::isSet(Addr addr)
+{
+    int indices[MaxHashes];
+    getIndices(addr, indices);
+    for (int i = 0; i < m_num_hashes; i++) {
+        if (!testBit(indices[i]))
+            return false;
+    }
+    return true;
+}
+
+int
+PackedBloomFilter::getCount(Addr addr)
+{
+    return isSet(addr) ? 1 : 0;
+}
+
+int
+PackedBloomFilter::getTotalCount()
+{
+    int count = 0;
+    for (auto word : m_bits) {
+        count += popCount(word);
+    }
+    return count;
+}
+
+void
+PackedBloomFilter::print(ostream& out) const
+{
+}
+
+int
+PackedBloomFilter::readBit(const int index)
+{
+    return testBit(index);
+}
+
+void
+PackedBloomFilter::writeBit(const int index, const int value)
+{
+    if (value)
+        setBit(index);
+    else
+        clearBit(index);
+}
+
+void
+PackedBloomFilter::setBatch(const Addr *addrs, int count)
+{
+    int indices[BatchSize * MaxHashes];
+
+    for (int base = 0; base < count; base += BatchSize) {
+        int n = min(count - base, BatchSize);
+        for (int i = 0; i < n; i++) {
+            getIndices(addrs[base + i], &indices[i * m_num_hashes]);
+        }
+        for (int i = 0; i < n * m_num_hashes; i++) {
+            setBit(indices[i]);
+        }
+    }
+}
+
+void
+PackedBloomFilter::isSetBatch(const Addr *addrs, int count, bool *result)
+{
+    int indices[BatchSize * MaxHashes];
+
+    for (int base = 0; base < count; base += BatchSize) {
+        int n = min(count - base, BatchSize);
+        for (int i = 0; i < n; i++) {
+            getIndices(addrs[base + i], &indices[i * m_num_hashes]);
+        }
+        // Test every bit instead of stopping at the first clear one,
+        // the loads are independent and can all be in flight at once
+        for (int i = 0; i < n; i++) {
+            const int *idx = &indices[i * m_num_hashes];
+            bool res = true;
+            for (int j = 0; j < m_num_hashes; j++) {
+                res &= testBit(idx[j]);
+            }
+            result[base + i] = res;
+        }
+    }
+}
+
+void
+PackedBloomFilter::setHashRange(int range)
+{
+    m_hash_range = range;
+    m_range_mask = isPowerOf2(range) ? range - 1 : 0;
+}
+
+void
+PackedBloomFilter::buildHashTable(int num_bits,
+                                  const function<uint32_t(int, int)> &row)
+{
+    m_hash_bytes = divCeil(num_bits, 8);
+    m_hash_table.assign(m_hash_bytes * 256 * m_num_hashes, 0);
+
+    for (int b = 0; b < m_hash_bytes; b++) {
+        for (int value = 0; value < 256; value++) {
+            uint32_t *entry =
+                &m_hash_table[((b << 8) | value) * m_num_hashes];
+            for (int bit = 0; bit < 8 && 8 * b + bit < num_bits; bit++) {
+                if (!(value & (1 << bit)))
+                    continue;
+                for (int j = 0; j < m_num_hashes; j++) {
+                    entry[j] ^= row(8 * b + bit, j);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Authors: agent
+ */
+
+#ifndef __MEM_RUBY_FILTERS_PACKEDBLOOMFILTER_HH__
+#define __MEM_RUBY_FILTERS_PACKEDBLOOMFILTER_HH__
+
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+#include "mem/ruby/common/Address.hh"
+#include "mem/ruby/filters/AbstractBloomFilter.hh"
+
+/**
+ * Common base of the non-counting filters. The filter bits are packed
+ * 64 to a word, so clear, merge and the population count work a word
+ * at a time. An address is represented by m_num_hashes bit indices,
+ * which the derived filter computes in getIndices().
+ *
+ * Filters whose hash functions are linear over GF(2), i.e. every hash
+ * is the XOR of a row per set address bit (H3, bit selection), can
+ * describe the rows with buildHashTable(). hashAll() then computes
+ * every hash of an address with one table lookup per address byte,
+ * instead of a loop over the address bits per hash.
+ */
+class PackedBloomFilter : public AbstractBloomFilter
+{
+  public:
+    /** Largest number of hash functions of a filter */
+    static const int MaxHashes = 16;
+
+    PackedBloomFilter(int size, int num_hashes);
+    ~PackedBloomFilter();
+
+    void clear();
+    void increment(Addr addr);
+    void decrement(Addr addr);
+    void merge(AbstractBloomFilter * other_filter);
+    void set(Addr addr);
+
+    bool isSet(Addr addr);
+    int getCount(Addr addr);
+    int getTotalCount();
+    void print(std::ostream& out) const;
+
+    int readBit(const int index);
+    void writeBit(const int index, const int value);
+
+    void setBatch(const Addr *addrs, int count);
+    void isSetBatch(const Addr *addrs, int count, bool *result);
+
+  protected:
+    /** Store the m_num_hashes bit indices of addr in indices. */
+    virtual void getIndices(Addr addr, int *indices) = 0;
+
+    /**
+     * Build the lookup tables of a linear hash over the low num_bits
+     * bits of a value. row(bit, hash) is the value the address bit
+     * contributes to the hash when it is set.
+     */
+    void buildHashTable(int num_bits,
+                        const std::function<uint32_t(int, int)> &row);
+
+    /**
+     * Set the range foldHash() maps hashes into. A range that is a
+     * power of two is folded with a mask instead of a division.
+     */
+    void setHashRange(int range);
+
+    int
+    foldHash(uint32_t hash) const
+    {
+        return m_range_mask ? hash & m_range_mask : hash % m_hash_range;
+    }
+
+    /** Compute all m_num_hashes hashes of value at once. */
+    void
+    hashAll(uint64_t value, uint32_t *hashes) const
+    {
+        for (int j = 0; j < m_num_hashes; j++)
+            hashes[j] = 0;
+
+        const uint32_t *table = m_hash_table.data();
+        for (int b = 0; b < m_hash_bytes; b++, value >>= 8) {
+            const uint32_t *entry =
+                table + ((b << 8) | (value & 0xff)) * m_num_hashes;
+            for (int j = 0; j < m_num_hashes; j++)
+                hashes[j] ^= entry[j];
+        }
+    }
+
+    bool
+    testBit(int index) const
+    {
+        return (m_bits[index >> 6] >> (index & 63)) & 1;
+    }
+
+    void setBit(int index) { m_bits[index >> 6] |= 1ULL << (index & 63); }
+
+    void
+    clearBit(int index)
+    {
+        m_bits[index >> 6] &= ~(1ULL << (index & 63));
+    }
+
+    int m_filter_size;
+    int m_num_hashes;
+
+  private:
+    /** Number of addresses hashed ahead of touching the bits */
+    static const int BatchSize = 64;
+
+    std::vector<uint64_t> m_bits;
+
+    /** Hash lookup tables, indexed by [byte][byte value][hash] */
+    std::vector<uint32_t> m_hash_table;
+    int m_hash_bytes;
+
+    uint32_t m_hash_range;
+    uint32_t m_range_mask;
+};
+
+#endif // __MEM_RUBY_FILTERS_PACKEDBLOOMFILTER_HH__
@@ -36,7 +36,7 @@ class BasicLink(SimObject):
     link_id = Param.Int("ID in relation to other links")
     latency = Param.Cycles(1, "latency")
     # Width of the link in bytes
-    # Only used by simple network.
+    # Only used by simple and analytical networks.
     # Garnet models this by flit size
     bandwidth_factor = Param.Int("generic bandwidth factor, usually in bytes")
     weight = Param.Int(1, "used to restrict routing in shortest path analysis")
@@ -46,7 +46,7 @@ class BasicExtLink(BasicLink):
     cxx_header = "mem/ruby/network/BasicLink.hh"
     ext_node = Param.RubyController("External node")
     int_node = Param.BasicRouter("ID of internal node")
-    bandwidth_factor = 16 # only used by simple network
+    bandwidth_factor = 16 # only used by simple and analytical networks
 
 class BasicIntLink(BasicLink):
     type = 'BasicIntLink'
@@ -58,5 +58,5 @@ class BasicIntLink(BasicLink):
     src_outport = Param.String("", "Outport direction at src router")
     dst_inport = Param.String("", "Inport direction at dst router")
 
-    # only used by simple network
+    # only used by simple and analytical networks
     bandwidth_factor = 16
@@ -35,5 +35,5 @@ class BasicRouter(ClockedObject):
     cxx_header = "mem/ruby/network/BasicRouter.hh"
     router_id = Param.Int("ID in relation to other routers")
 
-    # only used by garnet
+    # only used by garnet and the analytical network
     latency   = Param.Cycles(1, "number of cycles inside router")
@@ -41,7 +41,8 @@ using namespace std;
 using m5::stl_helpers::operator<<;
 
 MessageBuffer::MessageBuffer(const Params *p)
-    : SimObject(p), m_stall_map_size(0),
+    : SimObject(p), m_lanes(p->calendar_lanes), m_head(-1), m_num_msgs(0),
+    m_stall_index(16), m_stall_lines(0), m_stall_map_size(0),
     m_max_size(p->buffer_size), m_time_last_time_size_checked(0),
     m_time_last_time_enqueue(0), m_time_last_time_pop(0),
     m_last_arrival_time(0), m_strict_fifo(p->ordered),
@@ -54,7 +55,6 @@ MessageBuffer::MessageBuffer(const Params *p)
     m_msgs_this_cycle = 0;
     m_priority_rank = 0;
 
-    m_stall_msg_map.clear();
     m_input_link_id = 0;
     m_vnet_id = 0;
 
@@ -69,7 +69,7 @@ MessageBuffer::getSize(Tick curTime)
 {
     if (m_time_last_time_size_checked != curTime) {
         m_time_last_time_size_checked = curTime;
-        m_size_last_time_size_checked = m_prio_heap.size();
+        m_size_last_time_size_checked = m_num_msgs;
     }
 
     return m_size_last_time_size_checked;
@@ -91,8 +91,8 @@ MessageBuffer::areNSlotsAvailable(unsigned int n, Tick current_time)
     unsigned int current_size = 0;
 
     if (m_time_last_time_pop < current_time) {
-        // no pops this cycle - heap size is correct
-        current_size = m_prio_heap.size();
+        // no pops this cycle - buffer size is correct
+        current_size = m_num_msgs;
     } else {
         if (m_time_last_time_enqueue < current_time) {
             // no enqueues this cycle - m_size_at_cycle_start is correct
@@ -108,9 +108,9 @@ MessageBuffer::areNSlotsAvailable(unsigned int n, Tick current_time)
     if (current_size + m_stall_map_size + n <= m_max_size) {
         return true;
     } else {
-        DPRINTF(RubyQueue, "n: %d, current_size: %d, heap size: %d, "
+        DPRINTF(RubyQueue, "n: %d, current_size: %d, buffer size: %d, "
                 "m_max_size: %d\n",
-                n, current_size, m_prio_heap.size(), m_max_size);
+                n, current_size, m_num_msgs, m_max_size);
         m_not_avail_count++;
         return false;
     }
@@ -120,7 +120,7 @@ const Message*
 MessageBuffer::peek() const
 {
     DPRINTF(RubyQueue, "Peeking at head of queue.\n");
-    const Message* msg_ptr = m_prio_heap.front().get();
+    const Message* msg_ptr = head().get();
     assert(msg_ptr);
 
     DPRINTF(RubyQueue, "Message: %s\n", (*msg_ptr));
@@ -142,13 +142,21 @@ random_time()
 void
 MessageBuffer::enqueue(MsgPtr message, Tick current_time, Tick delta)
 {
+    // When the consumer runs on another event queue, the buffer belongs
+    // to that queue's thread and must not be touched from here
+    assert(m_consumer != NULL);
+    EventQueue *consumer_eq = m_consumer->wakeupEventQueue();
+    if (inParallelMode && consumer_eq != curEventQueue()) {
+        enqueueRemote(message, current_time, delta, consumer_eq);
+        return;
+    }
+
     // record current time incase we have a pop that also adjusts my size
     if (m_time_last_time_enqueue < current_time) {
         m_msgs_this_cycle = 0;  // first msg this cycle
         m_time_last_time_enqueue = current_time;
     }
 
-    m_msg_counter++;
     m_msgs_this_cycle++;
 
     // Calculate the arrival time of the message, that is, the first
@@ -196,11 +204,75 @@ MessageBuffer::enqueue(MsgPtr message, Tick current_time, Tick delta)
 
     msg_ptr->updateDelayedTicks(current_time);
     msg_ptr->setLastEnqueueTime(arrival_time);
-    msg_ptr->setMsgCounter(m_msg_counter);
 
-    // Insert the message into the priority heap
-    m_prio_heap.push_back(message);
-    push_heap(m_prio_heap.begin(), m_prio_heap.end(), greater<MsgPtr>());
+    deliver(message, arrival_time);
+}
+
+void
+MessageBuffer::enqueueRemote(const MsgPtr &message, Tick current_time,
+                             Tick delta, EventQueue *consumer_eq)
+{
+    // The message is handed over with an event on the consumer's queue.
+    // Event queues only exchange events at the end of a simulation
+    // quantum, so the enqueue latency is the lookahead the link
+    // provides and has to be longer than a whole quantum, making sure
+    // the event cannot be due before the consumer has seen it.
+    // Randomization is not allowed with several event queues, see
+    // RubySystem::startup(), so the latency is always delta.
+    fatal_if(m_max_size != 0, "%s: a buffer between event queues must "
+             "have an unlimited size\n", name());
+    fatal_if(delta <= simQuantum, "%s: enqueue latency %d is not longer "
+             "than the simulation quantum %d\n", name(), delta,
+             simQuantum);
+
+    assert(delta > 0);
+    Tick arrival_time = current_time + delta;
+
+    Message* msg_ptr = message.get();
+    assert(msg_ptr != NULL);
+
+    assert(current_time >= msg_ptr->getLastEnqueueTime() &&
+           "ensure we aren't dequeued early");
+
+    msg_ptr->updateDelayedTicks(current_time);
+    msg_ptr->setLastEnqueueTime(arrival_time);
+
+    DPRINTF(RubyQueue, "Enqueue from another event queue, "
+            "arrival_time: %lld, Message: %s\n",
+            arrival_time, *msg_ptr);
+
+    // The reference count is not atomic, and the sender may still hold
+    // references to the message, so the consumer gets a copy of its
+    // own rather than sharing the count across threads.
+    consumer_eq->schedule(new DeliveryEvent(this, msg_ptr->clone()),
+                          arrival_time);
+}
+
+void
+MessageBuffer::deliverRemote(const MsgPtr &message, Tick arrival_time)
+{
+    // the bookkeeping enqueue() does on the sender's side for a local
+    // message, done on the consumer's thread as the message arrives
+    if (m_time_last_time_enqueue < arrival_time) {
+        m_msgs_this_cycle = 0;
+        m_time_last_time_enqueue = arrival_time;
+    }
+    m_msgs_this_cycle++;
+
+    // deliveries are processed in tick order, so FIFO order holds
+    if (m_last_arrival_time < arrival_time)
+        m_last_arrival_time = arrival_time;
+
+    deliver(message, arrival_time);
+}
+
+void
+MessageBuffer::deliver(const MsgPtr &message, Tick arrival_time)
+{
+    m_msg_counter++;
+    message->setMsgCounter(m_msg_counter);
+
+    insertMessage(message);
     // Increment the number of messages statistic
     m_buf_msgs++;
 
@@ -208,7 +280,6 @@ MessageBuffer::enqueue(MsgPtr message, Tick current_time, Tick delta)
             arrival_time, *(message.get()));
 
     // Schedule the wakeup
-    assert(m_consumer != NULL);
     m_consumer->scheduleEventAbsolute(arrival_time);
     m_consumer->storeEventInfo(m_vnet_id);
 }
@@ -220,7 +291,7 @@ MessageBuffer::dequeue(Tick current_time, bool decrement_messages)
     assert(isReady(current_time));
 
     // get MsgPtr of the message about to be dequeued
-    MsgPtr message = m_prio_heap.front();
+    MsgPtr message = head();
 
     // get the delay cycles
     message->updateDelayedTicks(current_time);
@@ -231,12 +302,11 @@ MessageBuffer::dequeue(Tick current_time, bool decrement_messages)
     // record previous size and time so the current buffer size isn't
     // adjusted until schd cycle
     if (m_time_last_time_pop < current_time) {
-        m_size_at_cycle_start = m_prio_heap.size();
+        m_size_at_cycle_start = m_num_msgs;
         m_time_last_time_pop = current_time;
     }
 
-    pop_heap(m_prio_heap.begin(), m_prio_heap.end(), greater<MsgPtr>());
-    m_prio_heap.pop_back();
+    popHead();
     if (decrement_messages) {
         // If the message will be removed from the queue, decrement the
         // number of message in the queue.
@@ -266,7 +336,11 @@ MessageBuffer::unregisterDequeueCallback()
 void
 MessageBuffer::clear()
 {
+    for (auto &lane : m_lanes)
+        lane.clear();
     m_prio_heap.clear();
+    m_head = -1;
+    m_num_msgs = 0;
 
     m_msg_counter = 0;
     m_time_last_time_enqueue = 0;
@@ -280,51 +354,203 @@ MessageBuffer::recycle(Tick current_time, Tick recycle_latency)
 {
     DPRINTF(RubyQueue, "Recycling.\n");
     assert(isReady(current_time));
-    MsgPtr node = m_prio_heap.front();
-    pop_heap(m_prio_heap.begin(), m_prio_heap.end(), greater<MsgPtr>());
+    MsgPtr node = popHead();
 
     Tick future_time = current_time + recycle_latency;
     node->setLastEnqueueTime(future_time);
 
-    m_prio_heap.back() = node;
-    push_heap(m_prio_heap.begin(), m_prio_heap.end(), greater<MsgPtr>());
+    insertMessage(node);
     m_consumer->scheduleEventAbsolute(future_time);
 }
 
 void
-MessageBuffer::reanalyzeList(list<MsgPtr> &lt, Tick schdTick)
+MessageBuffer::insertMessage(const MsgPtr &message)
+{
+    // Append to the first lane that stays sorted, an empty lane takes
+    // anything
+    int num_lanes = m_lanes.size();
+    int pos = num_lanes;
+    for (int i = 0; i < num_lanes; ++i) {
+        if (m_lanes[i].empty() || !(m_lanes[i].back() > message)) {
+            m_lanes[i].push_back(message);
+            pos = i;
+            break;
+        }
+    }
+
+    if (pos == num_lanes) {
+        m_prio_heap.push_back(message);
+        push_heap(m_prio_heap.begin(), m_prio_heap.end(), greater<MsgPtr>());
+    }
+
+    m_num_msgs++;
+    if (m_head < 0 || head() > message)
+        m_head = pos;
+}
+
+void
+MessageBuffer::insertBatch(vector<MsgPtr> &batch)
+{
+    // The batch is sorted, so if its first message fits at the end of a
+    // lane the whole batch does
+    for (auto &lane : m_lanes) {
+        if (lane.empty() || !(lane.back() > batch.front())) {
+            lane.insert(lane.end(), batch.begin(), batch.end());
+            m_num_msgs += batch.size();
+            updateHead();
+            return;
+        }
+    }
+
+    for (const auto &m : batch)
+        insertMessage(m);
+}
+
+MsgPtr
+MessageBuffer::popHead()
+{
+    assert(m_head >= 0);
+
+    MsgPtr m;
+    if ((size_t)m_head < m_lanes.size()) {
+        m = std::move(m_lanes[m_head].front());
+        m_lanes[m_head].pop_front();
+    } else {
+        pop_heap(m_prio_heap.begin(), m_prio_heap.end(), greater<MsgPtr>());
+        m = std::move(m_prio_heap.back());
+        m_prio_heap.pop_back();
+    }
+
+    m_num_msgs--;
+    updateHead();
+    return m;
+}
+
+void
+MessageBuffer::updateHead()
+{
+    int num_lanes = m_lanes.size();
+    m_head = -1;
+    const MsgPtr *oldest = nullptr;
+    for (int i = 0; i < num_lanes; ++i) {
+        if (!m_lanes[i].empty() &&
+            (!oldest || *oldest > m_lanes[i].front())) {
+            oldest = &m_lanes[i].front();
+            m_head = i;
+        }
+    }
+    if (!m_prio_heap.empty() && (!oldest || *oldest > m_prio_heap.front()))
+        m_head = num_lanes;
+}
+
+int
+MessageBuffer::stallBucket(Addr addr) const
+{
+    return (addr >> RubySystem::getBlockSizeBits()) &
+        (m_stall_index.size() - 1);
+}
+
+MessageBuffer::StallEntry *
+MessageBuffer::findStall(Addr addr)
+{
+    int mask = m_stall_index.size() - 1;
+    for (int i = stallBucket(addr); m_stall_index[i].valid();
+         i = (i + 1) & mask) {
+        if (m_stall_index[i].addr == addr)
+            return &m_stall_index[i];
+    }
+    return nullptr;
+}
+
+MessageBuffer::StallEntry &
+MessageBuffer::insertStall(Addr addr)
+{
+    // keep the index at most half full
+    if (2 * (m_stall_lines + 1) > m_stall_index.size())
+        resizeStallIndex(2 * m_stall_index.size());
+
+    int mask = m_stall_index.size() - 1;
+    int i = stallBucket(addr);
+    while (m_stall_index[i].valid())
+        i = (i + 1) & mask;
+
+    m_stall_index[i].addr = addr;
+    m_stall_lines++;
+    return m_stall_index[i];
+}
+
+void
+MessageBuffer::eraseStall(StallEntry *entry)
+{
+    int mask = m_stall_index.size() - 1;
+    int i = entry - &m_stall_index[0];
+    m_stall_lines--;
+
+    // Backward-shift deletion, entries whose home bucket does not lie
+    // cyclically in (i, j] are moved into the hole
+    for (int j = (i + 1) & mask; m_stall_index[j].valid();
+         j = (j + 1) & mask) {
+        int home = stallBucket(m_stall_index[j].addr);
+        bool reachable = (i <= j) ? (i < home && home <= j)
+                                  : (i < home || home <= j);
+        if (!reachable) {
+            std::swap(m_stall_index[i], m_stall_index[j]);
+            i = j;
+        }
+    }
+
+    m_stall_index[i].addr = MaxAddr;
+    m_stall_index[i].msgs.clear();
+}
+
+void
+MessageBuffer::resizeStallIndex(size_t size)
 {
-    while (!lt.empty()) {
+    vector<StallEntry> old(size);
+    old.swap(m_stall_index);
+    m_stall_lines = 0;
+
+    for (auto &entry : old) {
+        if (entry.valid())
+            insertStall(entry.addr).msgs.swap(entry.msgs);
+    }
+}
+
+void
+MessageBuffer::reanalyzeList(vector<MsgPtr> &lt, Tick schdTick)
+{
+    if (lt.empty())
+        return;
+
+    for (auto &m : lt) {
         m_msg_counter++;
-        MsgPtr m = lt.front();
         m->setLastEnqueueTime(schdTick);
         m->setMsgCounter(m_msg_counter);
+    }
 
-        m_prio_heap.push_back(m);
-        push_heap(m_prio_heap.begin(), m_prio_heap.end(),
-                  greater<MsgPtr>());
+    insertBatch(lt);
+    lt.clear();
 
-        m_consumer->scheduleEventAbsolute(schdTick);
-        lt.pop_front();
-    }
+    m_consumer->scheduleEventAbsolute(schdTick);
 }
 
 void
 MessageBuffer::reanalyzeMessages(Addr addr, Tick current_time)
 {
     DPRINTF(RubyQueue, "ReanalyzeMessages %#x\n", addr);
-    assert(m_stall_msg_map.count(addr) > 0);
+    StallEntry *entry = findStall(addr);
+    assert(entry);
 
     //
-    // Put all stalled messages associated with this address back on the
-    // prio heap.  The reanalyzeList call will make sure the consumer is
+    // Put all stalled messages associated with this address back in the
+    // buffer.  The reanalyzeList call will make sure the consumer is
     // scheduled for the current cycle so that the previously stalled messages
     // will be observed before any younger messages that may arrive this cycle
     //
-    m_stall_map_size -= m_stall_msg_map[addr].size();
+    m_stall_map_size -= entry->msgs.size();
     assert(m_stall_map_size >= 0);
-    reanalyzeList(m_stall_msg_map[addr], current_time);
-    m_stall_msg_map.erase(addr);
+    reanalyzeList(entry->msgs, current_time);
+    eraseStall(entry);
 }
 
 void
@@ -332,19 +558,33 @@ MessageBuffer::reanalyzeAllMessages(Tick current_time)
 {
     DPRINTF(RubyQueue, "ReanalyzeAllMessages\n");
 
+    if (m_stall_lines == 0)
+        return;
+
     //
-    // Put all stalled messages associated with this address back on the
-    // prio heap.  The reanalyzeList call will make sure the consumer is
-    // scheduled for the current cycle so that the previously stalled messages
-    // will be observed before any younger messages that may arrive this cycle.
+    // Put all stalled messages back in the buffer.  The reanalyzeList call
+    // will make sure the consumer is scheduled for the current cycle so that
+    // the previously stalled messages will be observed before any younger
+    // messages that may arrive this cycle. Lines are released in address
+    // order so the result does not depend on the layout of the index.
     //
-    for (StallMsgMapType::iterator map_iter = m_stall_msg_map.begin();
-         map_iter != m_stall_msg_map.end(); ++map_iter) {
-        m_stall_map_size -= map_iter->second.size();
+    vector<StallEntry *> lines;
+    lines.reserve(m_stall_lines);
+    for (auto &entry : m_stall_index) {
+        if (entry.valid())
+            lines.push_back(&entry);
+    }
+    sort(lines.begin(), lines.end(),
+         [](const StallEntry *a, const StallEntry *b)
+         { return a->addr < b->addr; });
+
+    for (auto entry : lines) {
+        m_stall_map_size -= entry->msgs.size();
         assert(m_stall_map_size >= 0);
-        reanalyzeList(map_iter->second, current_time);
+        reanalyzeList(entry->msgs, current_time);
+        entry->addr = MaxAddr;
     }
-    m_stall_msg_map.clear();
+    m_stall_lines = 0;
 }
 
 void
@@ -353,7 +593,7 @@ MessageBuffer::stallMessage(Addr addr, Tick current_time)
     DPRINTF(RubyQueue, "Stalling due to %#x\n", addr);
     assert(isReady(current_time));
     assert(getOffset(addr) == 0);
-    MsgPtr message = m_prio_heap.front();
+    MsgPtr message = head();
 
     // Since the message will just be moved to stall map, indicate that the
     // buffer should not decrement the m_buf_msgs statistic
@@ -364,7 +604,10 @@ MessageBuffer::stallMessage(Addr addr, Tick current_time)
     // Instead the controller is responsible to call reanalyzeMessages when
     // these addresses change state.
     //
-    (m_stall_msg_map[addr]).push_back(message);
+    StallEntry *entry = findStall(addr);
+    if (!entry)
+        entry = &insertStall(addr);
+    entry->msgs.push_back(message);
     m_stall_map_size++;
     m_stall_count++;
 }
@@ -378,6 +621,9 @@ MessageBuffer::print(ostream& out) const
     }
 
     vector<MsgPtr> copy(m_prio_heap);
+    for (const auto &lane : m_lanes)
+        copy.insert(copy.end(), lane.begin(), lane.end());
+    make_heap(copy.begin(), copy.end(), greater<MsgPtr>());
     sort_heap(copy.begin(), copy.end(), greater<MsgPtr>());
     ccprintf(out, "%s] %s", copy, name());
 }
@@ -385,8 +631,8 @@ MessageBuffer::print(ostream& out) const
 bool
 MessageBuffer::isReady(Tick current_time) const
 {
-    return ((m_prio_heap.size() > 0) &&
-        (m_prio_heap.front()->getLastEnqueueTime() <= current_time));
+    return ((m_head >= 0) &&
+        (head()->getLastEnqueueTime() <= current_time));
 }
 
 void
@@ -429,8 +675,16 @@ MessageBuffer::functionalWrite(Packet *pkt)
 {
     uint32_t num_functional_writes = 0;
 
-    // Check the priority heap and write any messages that may
-    // correspond to the address in the packet.
+    // Check the lanes and the priority heap and write any messages that
+    // may correspond to the address in the packet.
+    for (const auto &lane : m_lanes) {
+        for (const auto &m : lane) {
+            if (m->functionalWrite(pkt)) {
+                num_functional_writes++;
+            }
+        }
+    }
+
     for (unsigned int i = 0; i < m_prio_heap.size(); ++i) {
         Message *msg = m_prio_heap[i].get();
         if (msg->functionalWrite(pkt)) {
@@ -438,17 +692,11 @@ MessageBuffer::functionalWrite(Packet *pkt)
         }
     }
 
-    // Check the stall queue and write any messages that may
+    // Check the stall index and write any messages that may
     // correspond to the address in the packet.
-    for (StallMsgMapType::iterator map_iter = m_stall_msg_map.begin();
-         map_iter != m_stall_msg_map.end();
-         ++map_iter) {
-
-        for (std::list<MsgPtr>::iterator it = (map_iter->second).begin();
-            it != (map_iter->second).end(); ++it) {
-
-            Message *msg = (*it).get();
-            if (msg->functionalWrite(pkt)) {
+    for (const auto &entry : m_stall_index) {
+        for (const auto &m : entry.msgs) {
+            if (m->functionalWrite(pkt)) {
                 num_functional_writes++;
             }
         }
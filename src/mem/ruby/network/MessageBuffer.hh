@@ -36,6 +36,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <deque>
 #include <functional>
 #include <iostream>
 #include <string>
@@ -48,6 +49,7 @@
 #include "mem/ruby/slicc_interface/Message.hh"
 #include "mem/packet.hh"
 #include "params/MessageBuffer.hh"
+#include "sim/eventq.hh"
 #include "sim/sim_object.hh"
 
 class MessageBuffer : public SimObject
@@ -66,10 +68,7 @@ class MessageBuffer : public SimObject
     void
     delayHead(Tick current_time, Tick delta)
     {
-        MsgPtr m = m_prio_heap.front();
-        std::pop_heap(m_prio_heap.begin(), m_prio_heap.end(),
-                      std::greater<MsgPtr>());
-        m_prio_heap.pop_back();
+        MsgPtr m = popHead();
         enqueue(m, current_time, delta);
     }
 
@@ -95,7 +94,7 @@ class MessageBuffer : public SimObject
     //! message queue.  The function assumes that the queue is nonempty.
     const Message* peek() const;
 
-    const MsgPtr &peekMsgPtr() const { return m_prio_heap.front(); }
+    const MsgPtr &peekMsgPtr() const { return head(); }
 
     void enqueue(MsgPtr message, Tick curTime, Tick delta);
 
@@ -107,9 +106,9 @@ class MessageBuffer : public SimObject
     void unregisterDequeueCallback();
 
     void recycle(Tick current_time, Tick recycle_latency);
-    bool isEmpty() const { return m_prio_heap.size() == 0; }
-    bool isStallMapEmpty() { return m_stall_msg_map.size() == 0; }
-    unsigned int getStallMapSize() { return m_stall_msg_map.size(); }
+    bool isEmpty() const { return m_num_msgs == 0; }
+    bool isStallMapEmpty() { return m_stall_lines == 0; }
+    unsigned int getStallMapSize() { return m_stall_lines; }
 
     unsigned int getSize(Tick curTime);
 
@@ -129,34 +128,107 @@ class MessageBuffer : public SimObject
     uint32_t functionalWrite(Packet *pkt);
 
   private:
-    void reanalyzeList(std::list<MsgPtr> &, Tick);
+    /** Lines whose stalled messages are kept in the stall index */
+    struct StallEntry
+    {
+        Addr addr;
+        std::vector<MsgPtr> msgs;
+
+        StallEntry() : addr(MaxAddr) { }
+        bool valid() const { return addr != MaxAddr; }
+    };
+
+    /**
+     * Carries a message enqueued by an object on another event queue
+     * and hands it to the buffer on the consumer's queue once it
+     * arrives, see enqueue().
+     */
+    class DeliveryEvent : public Event
+    {
+      public:
+        DeliveryEvent(MessageBuffer *buffer, const MsgPtr &message)
+            // Deliver ahead of the consumer wakeups of the same tick
+            : Event(Default_Pri - 1, AutoDelete),
+              m_buffer(buffer), m_message(message)
+        {
+        }
+
+        void process() { m_buffer->deliverRemote(m_message, when()); }
+        const char *description() const { return "MessageBuffer delivery"; }
+
+      private:
+        MessageBuffer *m_buffer;
+        MsgPtr m_message;
+    };
+
+    void enqueueRemote(const MsgPtr &message, Tick current_time,
+                       Tick delta, EventQueue *consumer_eq);
+    void deliverRemote(const MsgPtr &message, Tick arrival_time);
+    void deliver(const MsgPtr &message, Tick arrival_time);
+    void insertMessage(const MsgPtr &message);
+    void insertBatch(std::vector<MsgPtr> &batch);
+    MsgPtr popHead();
+    void updateHead();
+
+    const MsgPtr &
+    head() const
+    {
+        assert(m_head >= 0);
+        return (size_t)m_head < m_lanes.size() ? m_lanes[m_head].front()
+                                               : m_prio_heap.front();
+    }
+
+    int stallBucket(Addr addr) const;
+    StallEntry *findStall(Addr addr);
+    StallEntry &insertStall(Addr addr);
+    void eraseStall(StallEntry *entry);
+    void resizeStallIndex(size_t size);
+
+    void reanalyzeList(std::vector<MsgPtr> &, Tick);
 
   private:
     // Data Members (m_ prefix)
     //! Consumer to signal a wakeup(), can be NULL
     Consumer* m_consumer;
+
+    /**
+     * Messages waiting to be dequeued, ordered by arrival time and then
+     * enqueue order. Since a buffer is fed over links with a fixed
+     * latency, messages almost always arrive in the order they are
+     * enqueued, or in a small number of such sequences when several
+     * latencies are used. Each sequence is kept in its own lane, which
+     * is sorted by construction, and only messages that fit in no lane
+     * (e.g. with randomization enabled) go to m_prio_heap. The head of
+     * the buffer is the oldest of the lane fronts and the heap top.
+     */
+    std::vector<std::deque<MsgPtr> > m_lanes;
     std::vector<MsgPtr> m_prio_heap;
 
-    std::function<void()> m_dequeue_callback;
+    //! Lane holding the head of the buffer, m_lanes.size() for the heap
+    //! or -1 if the buffer is empty
+    int m_head;
+    //! Number of messages in the lanes and the heap
+    unsigned int m_num_msgs;
 
-    // use a std::map for the stalled messages as this container is
-    // sorted and ensures a well-defined iteration order
-    typedef std::map<Addr, std::list<MsgPtr> > StallMsgMapType;
+    std::function<void()> m_dequeue_callback;
 
     /**
-     * A map from line addresses to lists of stalled messages for that line.
-     * If this buffer allows the receiver to stall messages, on a stall
-     * request, the stalled message is removed from the m_prio_heap and placed
-     * in the m_stall_msg_map. Messages are held there until the receiver
-     * requests they be reanalyzed, at which point they are moved back to
-     * m_prio_heap.
+     * An open-addressing index from line addresses to lists of stalled
+     * messages for that line. If this buffer allows the receiver to
+     * stall messages, on a stall request, the stalled message is
+     * removed from the buffer and placed in the index. Messages are
+     * held there until the receiver requests they be reanalyzed, at
+     * which point they are moved back to the buffer as a batch.
      *
-     * NOTE: The stall map holds messages in the order in which they were
+     * NOTE: The index holds messages in the order in which they were
      * initially received, and when a line is unblocked, the messages are
-     * moved back to the m_prio_heap in the same order. This prevents starving
+     * moved back to the buffer in the same order. This prevents starving
      * older requests with younger ones.
      */
-    StallMsgMapType m_stall_msg_map;
+    std::vector<StallEntry> m_stall_index;
+
+    //! Number of lines in the stall index
+    unsigned int m_stall_lines;
 
     /**
      * Current size of the stall map.
@@ -38,6 +38,9 @@ class MessageBuffer(SimObject):
     buffer_size = Param.Unsigned(0, "Maximum number of entries to buffer \
                                      (0 allows infinite entries)")
     randomization = Param.Bool(False, "")
+    calendar_lanes = Param.Unsigned(4, "Number of in-order lanes messages \
+                                         are sorted into before falling \
+                                         back to a priority heap")
 
     master = MasterPort("Master port to MessageBuffer receiver")
     slave = SlavePort("Slave port from MessageBuffer sender")
@@ -29,6 +29,8 @@
 #include "mem/ruby/network/Topology.hh"
 
 #include <cassert>
+#include <functional>
+#include <queue>
 
 #include "base/trace.hh"
 #include "debug/RubyNetwork.hh"
@@ -116,43 +118,30 @@ Topology::createLinks(Network *net)
         max_switch_id = max(max_switch_id, src_dest.second);
     }
 
-    // Initialize weight, latency, and inter switched vectors
+    // Links into each switch, weighted
     int num_switches = max_switch_id+1;
-    Matrix topology_weights(num_switches,
-            vector<int>(num_switches, INFINITE_LATENCY));
-    Matrix component_latencies(num_switches,
-            vector<int>(num_switches, -1));
-    Matrix component_inter_switches(num_switches,
-            vector<int>(num_switches, 0));
-
-    // Set identity weights to zero
-    for (int i = 0; i < topology_weights.size(); i++) {
-        topology_weights[i][i] = 0;
-    }
-
-    // Fill in the topology weights and bandwidth multipliers
+    AdjacencyList reverse_links(num_switches);
     for (LinkMap::const_iterator i = m_link_map.begin();
          i != m_link_map.end(); ++i) {
-        std::pair<int, int> src_dest = (*i).first;
-        BasicLink* link = (*i).second.link;
-        int src = src_dest.first;
-        int dst = src_dest.second;
-        component_latencies[src][dst] = link->m_latency;
-        topology_weights[src][dst] = link->m_weight;
+        int weight = (*i).second.link->m_weight;
+        if (weight != INFINITE_LATENCY) {
+            Edge edge = {(*i).first.first, weight};
+            reverse_links[(*i).first.second].push_back(edge);
+        }
     }
 
     // Walk topology and hookup the links
-    Matrix dist = shortest_path(topology_weights, component_latencies,
-                                component_inter_switches);
-
-    for (int i = 0; i < topology_weights.size(); i++) {
-        for (int j = 0; j < topology_weights[i].size(); j++) {
-            int weight = topology_weights[i][j];
-            if (weight > 0 && weight != INFINITE_LATENCY) {
-                NetDest destination_set =
-                        shortest_path_to_node(i, j, topology_weights, dist);
-                makeLink(net, i, j, destination_set);
-            }
+    vector<int> dist = shortest_paths(reverse_links);
+
+    for (LinkMap::const_iterator i = m_link_map.begin();
+         i != m_link_map.end(); ++i) {
+        SwitchID src = (*i).first.first;
+        SwitchID dst = (*i).first.second;
+        int weight = (*i).second.link->m_weight;
+        if (weight > 0 && weight != INFINITE_LATENCY) {
+            NetDest destination_set =
+                    shortest_path_to_node(src, dst, weight, dist);
+            makeLink(net, src, dst, destination_set);
         }
     }
 }
@@ -214,66 +203,68 @@ Topology::makeLink(Network *net, SwitchID src, SwitchID dest,
     }
 }
 
-// The following all-pairs shortest path algorithm is based on the
-// discussion from Cormen et al., Chapter 26.1.
-void
-Topology::extend_shortest_path(Matrix &current_dist, Matrix &latencies,
-    Matrix &inter_switches)
+// Returns the distances from every switch to every destination node,
+// with dist[switch * num_nodes + node], or INFINITE_LATENCY where there
+// is no path. Only the distances to the destination nodes are needed
+// for the routing tables, so this keeps O(switches * nodes) entries
+// rather than an all-pairs matrix.
+vector<int>
+Topology::shortest_paths(const AdjacencyList &reverse_links)
 {
-    bool change = true;
-    int nodes = current_dist.size();
-
-    while (change) {
-        change = false;
-        for (int i = 0; i < nodes; i++) {
-            for (int j = 0; j < nodes; j++) {
-                int minimum = current_dist[i][j];
-                int previous_minimum = minimum;
-                int intermediate_switch = -1;
-                for (int k = 0; k < nodes; k++) {
-                    minimum = min(minimum,
-                        current_dist[i][k] + current_dist[k][j]);
-                    if (previous_minimum != minimum) {
-                        intermediate_switch = k;
-                        inter_switches[i][j] =
-                            inter_switches[i][k] +
-                            inter_switches[k][j] + 1;
-                    }
-                    previous_minimum = minimum;
-                }
-                if (current_dist[i][j] != minimum) {
-                    change = true;
-                    current_dist[i][j] = minimum;
-                    assert(intermediate_switch >= 0);
-                    assert(intermediate_switch < latencies[i].size());
-                    latencies[i][j] = latencies[i][intermediate_switch] +
-                        latencies[intermediate_switch][j];
+    int num_switches = reverse_links.size();
+    int max_machines = MachineType_base_number(MachineType_NUM);
+    vector<int> dist(num_switches * max_machines, INFINITE_LATENCY);
+
+    // (distance, switch), closest first
+    typedef pair<int, SwitchID> QueueEntry;
+    priority_queue<QueueEntry, vector<QueueEntry>,
+                   greater<QueueEntry> > queue;
+
+    for (int d = 0; d < max_machines; d++) {
+        // the destination switch of a node follows the input links
+        SwitchID final = d + max_machines;
+        if (final >= num_switches)
+            continue;
+
+        dist[final * max_machines + d] = 0;
+        queue.push(QueueEntry(0, final));
+
+        while (!queue.empty()) {
+            QueueEntry entry = queue.top();
+            queue.pop();
+
+            SwitchID node = entry.second;
+            if (entry.first > dist[node * max_machines + d])
+                continue;
+
+            for (const Edge &edge : reverse_links[node]) {
+                int new_dist = entry.first + edge.weight;
+                int &old_dist = dist[edge.node * max_machines + d];
+                if (new_dist < old_dist) {
+                    old_dist = new_dist;
+                    queue.push(QueueEntry(new_dist, edge.node));
                 }
             }
         }
     }
-}
 
-Matrix
-Topology::shortest_path(const Matrix &weights, Matrix &latencies,
-                        Matrix &inter_switches)
-{
-    Matrix dist = weights;
-    extend_shortest_path(dist, latencies, inter_switches);
     return dist;
 }
 
 bool
 Topology::link_is_shortest_path_to_node(SwitchID src, SwitchID next,
-                                        SwitchID final, const Matrix &weights,
-                                        const Matrix &dist)
+                                        int weight, int final,
+                                        const vector<int> &dist)
 {
-    return weights[src][next] + dist[next][final] == dist[src][final];
+    int max_machines = MachineType_base_number(MachineType_NUM);
+    int src_dist = dist[src * max_machines + final];
+    return src_dist != INFINITE_LATENCY &&
+        weight + dist[next * max_machines + final] == src_dist;
 }
 
 NetDest
-Topology::shortest_path_to_node(SwitchID src, SwitchID next,
-                                const Matrix &weights, const Matrix &dist)
+Topology::shortest_path_to_node(SwitchID src, SwitchID next, int weight,
+                                const vector<int> &dist)
 {
     NetDest result;
     int d = 0;
@@ -285,13 +276,12 @@ Topology::shortest_path_to_node(SwitchID src, SwitchID next,
 
     for (int m = 0; m < machines; m++) {
         for (NodeID i = 0; i < MachineType_base_count((MachineType)m); i++) {
-            // we use "d+max_machines" below since the "destination"
-            // switches for the machines are numbered
+            // the "destination" switches for the machines are numbered
             // [MachineType_base_number(MachineType_NUM)...
             //  2*MachineType_base_number(MachineType_NUM)-1] for the
-            // component network
-            if (link_is_shortest_path_to_node(src, next, d + max_machines,
-                    weights, dist)) {
+            // component network, shortest_paths() indexes them by d
+            if (link_is_shortest_path_to_node(src, next, weight, d,
+                    dist)) {
                 MachineID mach = {(MachineType)m, i};
                 result.add(mach);
             }
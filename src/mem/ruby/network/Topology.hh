@@ -51,7 +51,6 @@
 class NetDest;
 class Network;
 
-typedef std::vector<std::vector<int> > Matrix;
 typedef std::string PortDirection;
 
 struct LinkEntry
@@ -80,18 +79,24 @@ class Topology
     void makeLink(Network *net, SwitchID src, SwitchID dest,
                   const NetDest& routing_table_entry);
 
-    // Helper functions based on chapter 29 of Cormen et al.
-    void extend_shortest_path(Matrix &current_dist, Matrix &latencies,
-                              Matrix &inter_switches);
+    // Shortest path routing. The links are kept in a sparse adjacency
+    // list, and the distances from every switch to each destination
+    // node are found with one Dijkstra search per node, run backwards
+    // from the node over the links into each switch.
+    struct Edge
+    {
+        SwitchID node;
+        int weight;
+    };
+    typedef std::vector<std::vector<Edge>> AdjacencyList;
 
-    std::vector<std::vector<int>> shortest_path(const Matrix &weights,
-            Matrix &latencies, Matrix &inter_switches);
+    std::vector<int> shortest_paths(const AdjacencyList &reverse_links);
 
     bool link_is_shortest_path_to_node(SwitchID src, SwitchID next,
-            SwitchID final, const Matrix &weights, const Matrix &dist);
+            int weight, int final, const std::vector<int> &dist);
 
-    NetDest shortest_path_to_node(SwitchID src, SwitchID next,
-                                  const Matrix &weights, const Matrix &dist);
+    NetDest shortest_path_to_node(SwitchID src, SwitchID next, int weight,
+                                  const std::vector<int> &dist);
 
     const uint32_t m_nodes;
     const uint32_t m_number_of_switches;
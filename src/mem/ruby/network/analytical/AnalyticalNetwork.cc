@@ -0,0 +1,387 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Authors: agent
+ */
+
+#include "mem/ruby/network/analytical/AnalyticalNetwork.hh"
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+
+#include "base/intmath.hh"
+#include "base/stl_helpers.hh"
+#include "debug/RubyNetwork.hh"
+#include "mem/ruby/network/BasicLink.hh"
+#include "mem/ruby/network/BasicRouter.hh"
+#include "mem/ruby/network/MessageBuffer.hh"
+#include "sim/eventq.hh"
+
+using namespace std;
+using m5::stl_helpers::deletePointers;
+
+AnalyticalNetwork::AnalyticalNetwork(const Params *p)
+    : Network(p), m_adaptive_routing(p->adaptive_routing),
+      m_inject_tick(0)
+{
+    m_injectors.resize(m_nodes, nullptr);
+    m_in_ports.resize(m_nodes);
+    m_out_ports.resize(p->routers.size());
+    m_router_latency.resize(p->routers.size());
+
+    for (vector<BasicRouter*>::const_iterator i = p->routers.begin();
+         i != p->routers.end(); ++i) {
+        int id = (*i)->params()->router_id;
+        assert(id < p->routers.size());
+        m_router_latency[id] = cyclesToTicks((*i)->params()->latency);
+    }
+
+    m_last_arrival.resize(m_nodes * m_virtual_networks, 0);
+}
+
+void
+AnalyticalNetwork::init()
+{
+    Network::init();
+
+    // The link reservations are shared by all the nodes
+    fatal_if(numMainEventQueues > 1,
+             "%s: not supported with %d event queues\n",
+             name(), numMainEventQueues);
+
+    assert(m_topology_ptr != NULL);
+    m_topology_ptr->createLinks(this);
+}
+
+AnalyticalNetwork::~AnalyticalNetwork()
+{
+    deletePointers(m_injectors);
+}
+
+int
+AnalyticalNetwork::addChannel(BasicLink *link)
+{
+    fatal_if(link->m_bandwidth_factor <= 0,
+             "%s: link %s has a bandwidth factor of %d\n",
+             name(), link->name(), link->m_bandwidth_factor);
+
+    Channel channel;
+    channel.latency = cyclesToTicks(link->m_latency);
+    channel.bandwidth = link->m_bandwidth_factor;
+    m_channels.push_back(channel);
+    return m_channels.size() - 1;
+}
+
+Tick
+AnalyticalNetwork::serializationTime(const Channel &channel,
+                                     const MsgPtr &msg) const
+{
+    int bytes = MessageSizeType_to_int(msg->getMessageSize());
+    return cyclesToTicks(Cycles(divCeil(bytes, channel.bandwidth)));
+}
+
+Tick
+AnalyticalNetwork::earliestStart(Channel &channel, Tick ready,
+                                 Tick duration)
+{
+    // nothing is reserved in the past, so forget what has ended
+    map<Tick, Tick> &busy = channel.busy;
+    while (!busy.empty() && busy.begin()->second <= curTick())
+        busy.erase(busy.begin());
+
+    // start after any reservation covering the ready time, and move
+    // past the reservations the packet would overlap until it fits in
+    // a gap
+    Tick start = ready;
+    auto it = busy.upper_bound(ready);
+    if (it != busy.begin())
+        start = max(start, prev(it)->second);
+    for (; it != busy.end() && it->first < start + duration; ++it)
+        start = max(start, it->second);
+    return start;
+}
+
+void
+AnalyticalNetwork::reserve(Channel &channel, Tick start, Tick duration)
+{
+    if (duration == 0)
+        return;
+
+    // merge with the reservations it touches to keep the calendar short
+    map<Tick, Tick> &busy = channel.busy;
+    auto it = busy.emplace(start, start + duration).first;
+    auto next = std::next(it);
+    if (next != busy.end() && next->first == it->second) {
+        it->second = next->second;
+        busy.erase(next);
+    }
+    if (it != busy.begin()) {
+        auto before = prev(it);
+        if (before->second == it->first) {
+            before->second = it->second;
+            busy.erase(it);
+        }
+    }
+}
+
+// From a switch to an endpoint node
+void
+AnalyticalNetwork::makeExtOutLink(SwitchID src, NodeID dest, BasicLink* link,
+                                  const NetDest& routing_table_entry)
+{
+    assert(dest < m_nodes);
+    assert(src < m_out_ports.size());
+
+    OutPort port = {addChannel(link), routing_table_entry, (int)dest, true};
+    m_out_ports[src].push_back(port);
+}
+
+// From an endpoint node to a switch
+void
+AnalyticalNetwork::makeExtInLink(NodeID src, SwitchID dest, BasicLink* link,
+                                 const NetDest& routing_table_entry)
+{
+    assert(src < m_nodes);
+    assert(dest < m_out_ports.size());
+
+    OutPort port = {addChannel(link), routing_table_entry, (int)dest, false};
+    m_in_ports[src] = port;
+
+    Injector *injector = new Injector(this, src);
+    m_injectors[src] = injector;
+    for (auto &buffer : m_toNetQueues[src]) {
+        if (buffer != nullptr)
+            buffer->setConsumer(injector);
+    }
+}
+
+// From a switch to a switch
+void
+AnalyticalNetwork::makeInternalLink(SwitchID src, SwitchID dest,
+                                    BasicLink* link,
+                                    const NetDest& routing_table_entry,
+                                    PortDirection src_outport,
+                                    PortDirection dst_inport)
+{
+    assert(src < m_out_ports.size());
+    assert(dest < m_out_ports.size());
+
+    OutPort port = {addChannel(link), routing_table_entry, (int)dest, false};
+    m_out_ports[src].push_back(port);
+}
+
+void
+AnalyticalNetwork::inject(NodeID src, int vnet, const MsgPtr &msg)
+{
+    DPRINTF(RubyNetwork, "Injecting from node %d vnet %d: %s\n",
+            src, vnet, *msg);
+
+    m_inject_tick = clockEdge();
+    m_packets_injected++;
+
+    forward(m_in_ports[src], msg, m_inject_tick, vnet);
+}
+
+void
+AnalyticalNetwork::route(SwitchID src, const MsgPtr &msg, Tick head,
+                         int vnet)
+{
+    Tick ready = head + m_router_latency[src];
+    const vector<OutPort> &ports = m_out_ports[src];
+    NetDest msg_dsts = msg->getDestination();
+
+    // Unicast messages keep their message. With adaptive routing they
+    // take the link that can send them first among those on a shortest
+    // path, except on ordered vnets.
+    if (msg_dsts.count() == 1) {
+        bool adaptive = m_adaptive_routing && !m_ordered[vnet];
+        const OutPort *out = nullptr;
+        Tick out_start = MaxTick;
+        for (const OutPort &port : ports) {
+            if (!msg_dsts.intersectionIsNotEmpty(port.routing_table_entry))
+                continue;
+            if (!adaptive) {
+                out = &port;
+                break;
+            }
+            Channel &channel = m_channels[port.channel];
+            Tick start = earliestStart(channel, ready,
+                                       serializationTime(channel, msg));
+            if (out == nullptr || start < out_start) {
+                out = &port;
+                out_start = start;
+            }
+        }
+        assert(out != nullptr);
+        forward(*out, msg, ready, vnet);
+        return;
+    }
+
+    // Otherwise, the destinations are split over the links as in
+    // PerfectSwitch, each link getting its own copy of the message.
+    // The token protocol sends some messages with no destination.
+    for (const OutPort &port : ports) {
+        if (msg_dsts.isEmpty())
+            break;
+        if (!msg_dsts.intersectionIsNotEmpty(port.routing_table_entry))
+            continue;
+
+        MsgPtr copy = msg->clone();
+        copy->getDestination() = msg_dsts.AND(port.routing_table_entry);
+        msg_dsts.removeNetDest(port.routing_table_entry);
+
+        forward(port, copy, ready, vnet);
+    }
+    assert(msg_dsts.isEmpty());
+}
+
+void
+AnalyticalNetwork::forward(const OutPort &port, const MsgPtr &msg,
+                           Tick ready, int vnet)
+{
+    Channel &channel = m_channels[port.channel];
+    Tick serialization = serializationTime(channel, msg);
+
+    Tick start = earliestStart(channel, ready, serialization);
+    reserve(channel, start, serialization);
+    m_queueing_latency += start - ready;
+
+    Tick head = start + channel.latency;
+    if (port.to_node) {
+        deliver(port.dest, msg, head + serialization - clockPeriod(), vnet);
+    } else {
+        route(port.dest, msg, head, vnet);
+    }
+}
+
+void
+AnalyticalNetwork::deliver(NodeID dest, const MsgPtr &msg, Tick arrival,
+                           int vnet)
+{
+    // With zero link and router latencies a message could arrive in the
+    // cycle it was sent, but the buffers only take messages for a later
+    // cycle
+    Tick current_time = curTick();
+    arrival = max(arrival, current_time + clockPeriod());
+
+    if (m_ordered[vnet]) {
+        Tick &last_arrival = m_last_arrival[dest * m_virtual_networks + vnet];
+        arrival = max(arrival, last_arrival);
+        last_arrival = arrival;
+    }
+
+    DPRINTF(RubyNetwork, "Delivering to node %d vnet %d at %lld: %s\n",
+            dest, vnet, arrival, *msg);
+
+    assert(vnet < m_fromNetQueues[dest].size());
+    MessageBuffer *buffer = m_fromNetQueues[dest][vnet];
+    assert(buffer != nullptr);
+
+    buffer->enqueue(msg, current_time, arrival - current_time);
+
+    m_packets_received++;
+    m_packet_latency += arrival - m_inject_tick;
+}
+
+void
+AnalyticalNetwork::regStats()
+{
+    Network::regStats();
+
+    m_packets_injected
+        .name(name() + ".packets_injected")
+        .desc("number of packets injected into the network")
+        ;
+    m_packets_received
+        .name(name() + ".packets_received")
+        .desc("number of packets delivered, once per destination")
+        ;
+    m_packet_latency
+        .name(name() + ".packet_latency")
+        .desc("total ticks from injection to delivery")
+        ;
+    m_queueing_latency
+        .name(name() + ".queueing_latency")
+        .desc("total ticks packets waited for busy links")
+        ;
+
+    m_avg_packet_latency
+        .name(name() + ".average_packet_latency")
+        .desc("average ticks from injection to delivery")
+        ;
+    m_avg_packet_latency = m_packet_latency / m_packets_received;
+
+    m_avg_queueing_latency
+        .name(name() + ".average_queueing_latency")
+        .desc("average ticks a packet waited for busy links")
+        ;
+    m_avg_queueing_latency = m_queueing_latency / m_packets_received;
+}
+
+void
+AnalyticalNetwork::print(ostream& out) const
+{
+    out << "[AnalyticalNetwork]";
+}
+
+AnalyticalNetwork::Injector::Injector(AnalyticalNetwork *network,
+                                      NodeID node)
+    : Consumer(network), m_network(network), m_node(node)
+{
+}
+
+void
+AnalyticalNetwork::Injector::wakeup()
+{
+    Tick current_time = m_network->clockEdge();
+    const vector<MessageBuffer*> &buffers = m_network->m_toNetQueues[m_node];
+
+    for (int vnet = 0; vnet < buffers.size(); vnet++) {
+        MessageBuffer *buffer = buffers[vnet];
+        if (buffer == nullptr)
+            continue;
+
+        while (buffer->isReady(current_time)) {
+            MsgPtr msg = buffer->peekMsgPtr();
+            buffer->dequeue(current_time);
+            m_network->inject(m_node, vnet, msg);
+        }
+    }
+}
+
+void
+AnalyticalNetwork::Injector::print(ostream& out) const
+{
+    out << "[AnalyticalNetwork::Injector " << m_node << "]";
+}
+
+AnalyticalNetwork *
+AnalyticalNetworkParams::create()
+{
+    return new AnalyticalNetwork(this);
+}
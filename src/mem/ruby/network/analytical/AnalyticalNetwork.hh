@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Authors: agent
+ */
+
+/*
+ * A packet level model of the interconnect, much faster than garnet while
+ * still accounting for link bandwidth and contention. Rather than moving
+ * messages from hop to hop, the network works out when a message reaches
+ * its destinations as it is injected and enqueues it there straight
+ * away, so every delivered message costs a single event.
+ *
+ * Each link is a channel that a packet reserves for its serialization
+ * time, bytes / bandwidth_factor cycles rounded up, starting at the first
+ * idle period long enough once the packet reaches the link. The head of
+ * the packet moves on after the link latency (virtual cut-through) and
+ * pays the router latency at the next switch; the destination receives
+ * the packet once its tail has arrived.
+ *
+ * Reservations are made in injection order, but each channel keeps a
+ * calendar of them, so a packet reaching a shared link early can still
+ * use the gap before a reservation made for a packet injected earlier.
+ * Buffering is unlimited, as in SimpleNetwork with a buffer size of 0.
+ */
+
+#ifndef __MEM_RUBY_NETWORK_ANALYTICAL_ANALYTICALNETWORK_HH__
+#define __MEM_RUBY_NETWORK_ANALYTICAL_ANALYTICALNETWORK_HH__
+
+#include <iostream>
+#include <map>
+#include <vector>
+
+#include "mem/ruby/common/Consumer.hh"
+#include "mem/ruby/common/NetDest.hh"
+#include "mem/ruby/network/Network.hh"
+#include "mem/ruby/slicc_interface/Message.hh"
+#include "params/AnalyticalNetwork.hh"
+
+class AnalyticalNetwork : public Network
+{
+  public:
+    typedef AnalyticalNetworkParams Params;
+    AnalyticalNetwork(const Params *p);
+    ~AnalyticalNetwork();
+
+    void init();
+
+    // Methods used by Topology to setup the network
+    void makeExtOutLink(SwitchID src, NodeID dest, BasicLink* link,
+                     const NetDest& routing_table_entry);
+    void makeExtInLink(NodeID src, SwitchID dest, BasicLink* link,
+                    const NetDest& routing_table_entry);
+    void makeInternalLink(SwitchID src, SwitchID dest, BasicLink* link,
+                          const NetDest& routing_table_entry,
+                          PortDirection src_outport,
+                          PortDirection dst_inport);
+
+    void regStats();
+    void collateStats() {}
+    void print(std::ostream& out) const;
+
+    // Messages sit in the buffers of their destinations from the moment
+    // they are injected, and the controllers access those themselves
+    bool functionalRead(Packet *pkt) { return false; }
+    uint32_t functionalWrite(Packet *pkt) { return 0; }
+
+  private:
+    // Takes the messages out of the buffers of one node as they become
+    // ready and injects them
+    class Injector : public Consumer
+    {
+      public:
+        Injector(AnalyticalNetwork *network, NodeID node);
+
+        void wakeup();
+        void print(std::ostream& out) const;
+
+      private:
+        AnalyticalNetwork *m_network;
+        NodeID m_node;
+    };
+
+    struct Channel
+    {
+        Tick latency;
+        // bytes per cycle
+        int bandwidth;
+        // start and end of the reservations that have not ended yet,
+        // merged where they touch
+        std::map<Tick, Tick> busy;
+    };
+
+    // A link out of a switch, or from a node into its switch
+    struct OutPort
+    {
+        int channel;
+        NetDest routing_table_entry;
+        // switch or node at the other end
+        int dest;
+        bool to_node;
+    };
+
+    int addChannel(BasicLink *link);
+
+    Tick serializationTime(const Channel &channel, const MsgPtr &msg) const;
+    // First tick from ready on at which the channel is idle for duration
+    Tick earliestStart(Channel &channel, Tick ready, Tick duration);
+    void reserve(Channel &channel, Tick start, Tick duration);
+
+    void inject(NodeID src, int vnet, const MsgPtr &msg);
+    void route(SwitchID src, const MsgPtr &msg, Tick head, int vnet);
+    void forward(const OutPort &port, const MsgPtr &msg, Tick ready,
+                 int vnet);
+    void deliver(NodeID dest, const MsgPtr &msg, Tick arrival, int vnet);
+
+    // Private copy constructor and assignment operator
+    AnalyticalNetwork(const AnalyticalNetwork& obj);
+    AnalyticalNetwork& operator=(const AnalyticalNetwork& obj);
+
+    const bool m_adaptive_routing;
+
+    std::vector<Channel> m_channels;
+    std::vector<Injector*> m_injectors;
+    // per node, the link into the network
+    std::vector<OutPort> m_in_ports;
+    // per switch, the links out of it and the router latency
+    std::vector<std::vector<OutPort>> m_out_ports;
+    std::vector<Tick> m_router_latency;
+    // per node and vnet, the last arrival, to keep ordered vnets in order
+    std::vector<Tick> m_last_arrival;
+
+    // injection tick of the message being routed
+    Tick m_inject_tick;
+
+    // Statistical variables
+    Stats::Scalar m_packets_injected;
+    Stats::Scalar m_packets_received;
+    Stats::Scalar m_packet_latency;
+    Stats::Scalar m_queueing_latency;
+    Stats::Formula m_avg_packet_latency;
+    Stats::Formula m_avg_queueing_latency;
+};
+
+inline std::ostream&
+operator<<(std::ostream& out, const AnalyticalNetwork& obj)
+{
+    obj.print(out);
+    out << std::flush;
+    return out;
+}
+
+#endif // __MEM_RUBY_NETWORK_ANALYTICAL_ANALYTICALNETWORK_HH__
@@ -34,6 +34,10 @@
 #ifndef __MEM_RUBY_NETWORK_GARNET_COMMONTYPES_HH__
 #define __MEM_RUBY_NETWORK_GARNET_COMMONTYPES_HH__
 
+#include <cstdint>
+#include <vector>
+
+#include "base/bitfield.hh"
 #include "mem/ruby/common/NetDest.hh"
 
 // All common enums and typedefs go here
@@ -44,6 +48,7 @@ enum VNET_type {CTRL_VNET_, DATA_VNET_, NULL_VNET_, NUM_VNET_TYPE_};
 enum flit_stage {I_, VA_, SA_, ST_, LT_, NUM_FLIT_STAGE_};
 enum link_type { EXT_IN_, EXT_OUT_, INT_, NUM_LINK_TYPES_ };
 enum RoutingAlgorithm { TABLE_ = 0, XY_ = 1, CUSTOM_ = 2,
+                        WEST_FIRST_ = 3, ODD_EVEN_ = 4, ESCAPE_VC_ = 5,
                         NUM_ROUTING_ALGORITHM_};
 
 struct RouteInfo
@@ -58,8 +63,56 @@ struct RouteInfo
     int dest_ni;
     int dest_router;
     int hops_traversed;
+
+    // id of the packet in the network trace, see NetworkTrace.hh
+    uint64_t trace_id;
 };
 
 #define INFINITE_ 10000
 
+// A set of port ids of one router. The router and its allocators keep
+// the ports that have work in these sets, so each cycle they visit only
+// those ports (in increasing order) instead of polling every port.
+class PortSet
+{
+  public:
+    void
+    set(int port)
+    {
+        unsigned w = port / 64;
+        if (w >= m_words.size())
+            m_words.resize(w + 1, 0);
+        m_words[w] |= ULL(1) << (port % 64);
+    }
+
+    void
+    clear(int port)
+    {
+        unsigned w = port / 64;
+        if (w < m_words.size())
+            m_words[w] &= ~(ULL(1) << (port % 64));
+    }
+
+    // First port >= port in the set, or -1
+    int
+    next(int port) const
+    {
+        unsigned w = port / 64;
+        if (w >= m_words.size())
+            return -1;
+        uint64_t bits = m_words[w] & (~ULL(0) << (port % 64));
+        while (!bits) {
+            if (++w >= m_words.size())
+                return -1;
+            bits = m_words[w];
+        }
+        return w * 64 + findLsbSet(bits);
+    }
+
+    int first() const { return next(0); }
+
+  private:
+    std::vector<uint64_t> m_words;
+};
+
 #endif // __MEM_RUBY_NETWORK_GARNET_COMMONTYPES_HH__
@@ -51,6 +51,11 @@ class Credit : public flit
     Credit() {};
     Credit(int vc, bool is_free_signal, Cycles curTime);
 
+    static void *operator new(size_t size)
+    { return MessagePool<Credit>::allocate(size); }
+    static void operator delete(void *p, size_t size)
+    { MessagePool<Credit>::release(p, size); }
+
     bool is_free_signal() { return m_is_free_signal; }
 
   private:
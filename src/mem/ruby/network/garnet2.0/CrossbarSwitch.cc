@@ -78,7 +78,8 @@ CrossbarSwitch::wakeup()
             "at time: %lld\n",
             m_router->get_id(), m_router->curCycle());
 
-    for (int inport = 0; inport < m_num_inports; inport++) {
+    for (int inport = m_busy_inports.first(); inport >= 0;
+         inport = m_busy_inports.next(inport + 1)) {
         if (!m_switch_buffer[inport]->isReady(m_router->curCycle()))
             continue;
 
@@ -95,6 +96,9 @@ CrossbarSwitch::wakeup()
             m_output_unit[outport]->insert_flit(t_flit);
             m_switch_buffer[inport]->getTopFlit();
             m_crossbar_activity++;
+
+            if (m_switch_buffer[inport]->isEmpty())
+                m_busy_inports.clear(inport);
         }
     }
 }
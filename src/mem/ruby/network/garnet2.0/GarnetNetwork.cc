@@ -36,7 +36,9 @@
 #include <cassert>
 
 #include "base/cast.hh"
+#include "base/output.hh"
 #include "base/stl_helpers.hh"
+#include "config/have_protobuf.hh"
 #include "mem/ruby/common/NetDest.hh"
 #include "mem/ruby/network/MessageBuffer.hh"
 #include "mem/ruby/network/garnet2.0/CommonTypes.hh"
@@ -44,8 +46,17 @@
 #include "mem/ruby/network/garnet2.0/GarnetLink.hh"
 #include "mem/ruby/network/garnet2.0/NetworkInterface.hh"
 #include "mem/ruby/network/garnet2.0/NetworkLink.hh"
+#include "mem/ruby/network/garnet2.0/NetworkPower.hh"
 #include "mem/ruby/network/garnet2.0/Router.hh"
+#include "mem/ruby/slicc_interface/AbstractController.hh"
 #include "mem/ruby/system/RubySystem.hh"
+#include "mem/ruby/system/Sequencer.hh"
+#include "sim/eventq.hh"
+#include "sim/sim_exit.hh"
+
+#if HAVE_PROTOBUF
+#include "mem/ruby/network/garnet2.0/NetworkTrace.hh"
+#endif
 
 using namespace std;
 using m5::stl_helpers::deletePointers;
@@ -57,7 +68,10 @@ using m5::stl_helpers::deletePointers;
  */
 
 GarnetNetwork::GarnetNetwork(const Params *p)
-    : Network(p)
+    : Network(p), m_trace_capture(p->trace_capture),
+      m_trace_replay(p->trace_replay), m_trace_writer(nullptr),
+      m_trace_packets(0), m_replay_remaining(0), m_power_table(nullptr),
+      m_power_window_start(0)
 {
     m_num_rows = p->num_rows;
     m_ni_flit_size = p->ni_flit_size;
@@ -66,10 +80,21 @@ GarnetNetwork::GarnetNetwork(const Params *p)
     m_buffers_per_ctrl_vc = p->buffers_per_ctrl_vc;
     m_routing_algorithm = p->routing_algorithm;
 
+    fatal_if((m_routing_algorithm == WEST_FIRST_ ||
+              m_routing_algorithm == ODD_EVEN_ ||
+              m_routing_algorithm == ESCAPE_VC_) && m_num_rows <= 0,
+             "Routing algorithm %d needs a mesh with num_rows set\n",
+             m_routing_algorithm);
+    fatal_if(m_routing_algorithm == ESCAPE_VC_ && m_vcs_per_vnet < 2,
+             "Escape VC routing needs at least 2 VCs per vnet\n");
+
     m_enable_fault_model = p->enable_fault_model;
     if (m_enable_fault_model)
         fault_model = p->fault_model;
 
+    if (!p->power_table.empty())
+        m_power_table = new NetworkPowerTable(p->power_table);
+
     m_vnet_type.resize(m_virtual_networks);
 
     for (int i = 0 ; i < m_virtual_networks ; i++) {
@@ -141,6 +166,101 @@ GarnetNetwork::init()
             router->printFaultVector(cout);
         }
     }
+
+    // Look up the energies of every router once the ports are known
+    if (m_power_table) {
+        for (int i = 0; i < m_routers.size(); i++) {
+            m_routers[i]->initPower(m_power_table);
+        }
+        resetPower();
+    }
+
+    // The trace and its packet ids are shared by all the interfaces
+    fatal_if((!m_trace_capture.empty() || isReplayingTrace()) &&
+             numMainEventQueues > 1,
+             "%s: network traces are not supported with %d event queues\n",
+             name(), numMainEventQueues);
+    fatal_if(!m_trace_capture.empty() && isReplayingTrace(),
+             "%s: cannot capture a trace while replaying one\n", name());
+
+#if HAVE_PROTOBUF
+    if (!m_trace_capture.empty()) {
+        m_trace_writer = new NetworkTraceWriter(
+            simout.resolve(m_trace_capture), name(), m_nodes,
+            m_virtual_networks);
+
+        // The destructor is not called at exit, so flush and close the
+        // trace with a callback
+        registerExitCallback(
+            new MakeCallback<GarnetNetwork, &GarnetNetwork::closeTrace>(this));
+    }
+
+    if (isReplayingTrace()) {
+        NetworkTraceReader reader(m_trace_replay, m_nodes,
+                                  m_virtual_networks);
+        NetworkTraceRecord record;
+        while (reader.read(record)) {
+            fatal_if(record.src >= m_nodes || record.dest >= m_nodes,
+                     "%s: packet %d of the trace goes from node %d to %d\n",
+                     name(), record.id, record.src, record.dest);
+            m_nis[record.src]->addReplayPacket(record);
+            ++m_replay_remaining;
+        }
+        fatal_if(m_replay_remaining == 0, "%s: network trace %s is empty\n",
+                 name(), m_trace_replay);
+    }
+#else
+    fatal_if(!m_trace_capture.empty() || isReplayingTrace(),
+             "%s: network traces need protobuf support\n", name());
+#endif
+}
+
+uint64_t
+GarnetNetwork::captureTrace(NetworkTraceRecord &record)
+{
+    record.id = ++m_trace_packets;
+#if HAVE_PROTOBUF
+    m_trace_writer->write(record);
+#endif
+    return record.id;
+}
+
+void
+GarnetNetwork::startup()
+{
+    if (!isReplayingTrace())
+        return;
+
+    // The cores and the protocol keep running while the trace is
+    // replayed, but their messages never make it through the network,
+    // so their requests are not expected to complete. The simulation
+    // ends once the trace is done instead, see replayPacketReceived().
+    warn("%s: replaying a network trace, Ruby requests will not "
+         "complete\n", name());
+    for (const auto &cntrls : params()->ruby_system->m_abstract_controls) {
+        for (const auto &it : cntrls) {
+            Sequencer *seq = it.second->getCPUSequencer();
+            if (seq != nullptr)
+                seq->disableDeadlockCheck();
+        }
+    }
+}
+
+void
+GarnetNetwork::replayPacketReceived()
+{
+    assert(m_replay_remaining > 0);
+    if (--m_replay_remaining == 0)
+        exitSimLoop("garnet network trace replayed");
+}
+
+void
+GarnetNetwork::closeTrace()
+{
+#if HAVE_PROTOBUF
+    delete m_trace_writer;
+    m_trace_writer = nullptr;
+#endif
 }
 
 GarnetNetwork::~GarnetNetwork()
@@ -149,6 +269,7 @@ GarnetNetwork::~GarnetNetwork()
     deletePointers(m_nis);
     deletePointers(m_networklinks);
     deletePointers(m_creditlinks);
+    delete m_power_table;
 }
 
 /*
@@ -174,6 +295,9 @@ GarnetNetwork::makeExtInLink(NodeID src, SwitchID dest, BasicLink* link,
     m_networklinks.push_back(net_link);
     m_creditlinks.push_back(credit_link);
 
+    checkLinkEventQueues(net_link, m_nis[src], m_routers[dest]);
+    checkLinkEventQueues(credit_link, m_routers[dest], m_nis[src]);
+
     PortDirection dst_inport_dirn = "Local";
     m_routers[dest]->addInPort(dst_inport_dirn, net_link, credit_link);
     m_nis[src]->addOutPort(net_link, credit_link, dest);
@@ -203,6 +327,9 @@ GarnetNetwork::makeExtOutLink(SwitchID src, NodeID dest, BasicLink* link,
     m_networklinks.push_back(net_link);
     m_creditlinks.push_back(credit_link);
 
+    checkLinkEventQueues(net_link, m_routers[src], m_nis[dest]);
+    checkLinkEventQueues(credit_link, m_nis[dest], m_routers[src]);
+
     PortDirection src_outport_dirn = "Local";
     m_routers[src]->addOutPort(src_outport_dirn, net_link,
                                routing_table_entry,
@@ -231,12 +358,40 @@ GarnetNetwork::makeInternalLink(SwitchID src, SwitchID dest, BasicLink* link,
     m_networklinks.push_back(net_link);
     m_creditlinks.push_back(credit_link);
 
+    checkLinkEventQueues(net_link, m_routers[src], m_routers[dest]);
+    checkLinkEventQueues(credit_link, m_routers[dest], m_routers[src]);
+
     m_routers[dest]->addInPort(dst_inport_dirn, net_link, credit_link);
     m_routers[src]->addOutPort(src_outport_dirn, net_link,
                                routing_table_entry,
                                link->m_weight, credit_link);
 }
 
+/*
+ * Routers and network interfaces may be spread over several event
+ * queues, e.g., to simulate the tiles of a large mesh in parallel.
+ * A link has to run on the event queue of the unit feeding it, and
+ * hands its flits over to a consumer on another queue (see
+ * NetworkLink::wakeup()). Event queues only exchange events at the end
+ * of a simulation quantum, so such a link has to be longer than a
+ * quantum. A flit arriving exactly on the quantum boundary would only
+ * be inserted after the consumer's wakeup for that tick had run.
+ */
+
+void
+GarnetNetwork::checkLinkEventQueues(NetworkLink *link, ClockedObject *src,
+                                   ClockedObject *dest)
+{
+    fatal_if(link->eventQueue() != src->eventQueue(),
+             "%s is not on the event queue of %s\n",
+             link->name(), src->name());
+    fatal_if(dest->eventQueue() != src->eventQueue() &&
+             link->cyclesToTicks(link->getLatency()) <= simQuantum,
+             "%s: latency %d between event queues is not longer than the "
+             "simulation quantum %d\n", link->name(),
+             link->cyclesToTicks(link->getLatency()), simQuantum);
+}
+
 // Total routers in the network
 int
 GarnetNetwork::getNumRouters()
@@ -393,6 +548,44 @@ GarnetNetwork::regStats()
         .name(name() + ".avg_vc_load")
         .flags(Stats::pdf | Stats::total | Stats::nozero | Stats::oneline)
         ;
+
+    // Power. Every stat is checked for initialization at stats enable,
+    // so the formula is set up even if the power model is not used.
+    m_total_power = m_router_dynamic_power + m_router_static_power +
+        m_link_dynamic_power + m_link_static_power;
+    if (m_power_table) {
+        m_router_dynamic_power
+            .name(name() + ".router_dynamic_power")
+            .desc("Dynamic power of all routers over the last stats "
+                  "window (W)")
+            ;
+        m_router_static_power
+            .name(name() + ".router_static_power")
+            .desc("Leakage power of all routers (W)")
+            ;
+        m_link_dynamic_power
+            .name(name() + ".link_dynamic_power")
+            .desc("Dynamic power of all links over the last stats "
+                  "window (W)")
+            ;
+        m_link_static_power
+            .name(name() + ".link_static_power")
+            .desc("Leakage power of all links (W)")
+            ;
+        m_total_power
+            .name(name() + ".total_power")
+            .desc("Power of the network over the last stats window (W)")
+            ;
+        m_energy
+            .name(name() + ".energy")
+            .desc("Energy of the network over the last stats window (J)")
+            ;
+
+        // The next window starts whenever the stats are reset
+        Stats::registerResetCallback(
+            new MakeCallback<GarnetNetwork, &GarnetNetwork::resetPower>(
+                this));
+    }
 }
 
 void
@@ -421,10 +614,101 @@ GarnetNetwork::collateStats()
         }
     }
 
+    // Packet and flit counts are kept by the network interfaces
+    for (int j = 0; j < m_virtual_networks; j++) {
+        NetworkInterface::VnetStats total = NetworkInterface::VnetStats();
+        for (int i = 0; i < m_nis.size(); i++) {
+            const NetworkInterface::VnetStats &stats =
+                m_nis[i]->getVnetStats(j);
+            total.packets_injected += stats.packets_injected;
+            total.packets_received += stats.packets_received;
+            total.packet_network_latency += stats.packet_network_latency;
+            total.packet_queueing_latency += stats.packet_queueing_latency;
+            total.flits_injected += stats.flits_injected;
+            total.flits_received += stats.flits_received;
+            total.flit_network_latency += stats.flit_network_latency;
+            total.flit_queueing_latency += stats.flit_queueing_latency;
+        }
+
+        m_packets_injected[j] = total.packets_injected;
+        m_packets_received[j] = total.packets_received;
+        m_packet_network_latency[j] = total.packet_network_latency;
+        m_packet_queueing_latency[j] = total.packet_queueing_latency;
+        m_flits_injected[j] = total.flits_injected;
+        m_flits_received[j] = total.flits_received;
+        m_flit_network_latency[j] = total.flit_network_latency;
+        m_flit_queueing_latency[j] = total.flit_queueing_latency;
+    }
+
+    Counter total_hops = 0;
+    for (int i = 0; i < m_nis.size(); i++) {
+        total_hops += m_nis[i]->getTotalHops();
+    }
+    m_total_hops = total_hops;
+
     // Ask the routers to collate their statistics
     for (int i = 0; i < m_routers.size(); i++) {
         m_routers[i]->collateStats();
     }
+
+    if (m_power_table) {
+        collatePower();
+    }
+}
+
+void
+GarnetNetwork::collatePower()
+{
+    Tick window = curTick() - m_power_window_start;
+    if (window == 0) {
+        return;
+    }
+    double seconds = double(window) / SimClock::Frequency;
+
+    double router_dynamic = 0;
+    double router_static = 0;
+    for (int i = 0; i < m_routers.size(); i++) {
+        m_routers[i]->collatePower(window);
+        router_dynamic += m_routers[i]->getDynamicPower();
+        router_static += m_routers[i]->getStaticPower();
+    }
+
+    const LinkEnergy &energy = m_power_table->getLinkEnergy();
+    double link_dynamic = 0;
+    double link_static = 0;
+    for (int i = 0; i < m_networklinks.size(); i++) {
+        unsigned int flits = m_networklinks[i]->getLinkUtilization();
+        double voltage = m_networklinks[i]->voltage();
+
+        link_dynamic += (flits - m_link_flits_start[i]) * energy.flit *
+            m_power_table->dynamicScale(voltage) / seconds;
+        link_static += energy.leakage * m_power_table->staticScale(voltage);
+        m_link_flits_start[i] = flits;
+    }
+
+    m_router_dynamic_power = router_dynamic;
+    m_router_static_power = router_static;
+    m_link_dynamic_power = link_dynamic;
+    m_link_static_power = link_static;
+    m_energy = (router_dynamic + router_static + link_dynamic +
+                link_static) * seconds;
+
+    m_power_window_start = curTick();
+}
+
+void
+GarnetNetwork::resetPower()
+{
+    for (int i = 0; i < m_routers.size(); i++) {
+        m_routers[i]->resetPower();
+    }
+
+    m_link_flits_start.resize(m_networklinks.size());
+    for (int i = 0; i < m_networklinks.size(); i++) {
+        m_link_flits_start[i] = m_networklinks[i]->getLinkUtilization();
+    }
+
+    m_power_window_start = curTick();
 }
 
 void
@@ -48,6 +48,9 @@ class Router;
 class NetDest;
 class NetworkLink;
 class CreditLink;
+class NetworkPowerTable;
+class NetworkTraceWriter;
+struct NetworkTraceRecord;
 
 class GarnetNetwork : public Network
 {
@@ -57,6 +60,7 @@ class GarnetNetwork : public Network
 
     ~GarnetNetwork();
     void init();
+    void startup();
 
     // Configuration (set externally)
 
@@ -96,6 +100,14 @@ class GarnetNetwork : public Network
                           const NetDest& routing_table_entry,
                           PortDirection src_outport_dirn,
                           PortDirection dest_inport_dirn);
+    void checkLinkEventQueues(NetworkLink *link, ClockedObject *src,
+                              ClockedObject *dest);
+
+    // Trace capture and replay, see NetworkTrace.hh
+    bool isCapturingTrace() const { return m_trace_writer != nullptr; }
+    bool isReplayingTrace() const { return !m_trace_replay.empty(); }
+    uint64_t captureTrace(NetworkTraceRecord &record);
+    void replayPacketReceived();
 
     //! Function for performing a functional write. The return value
     //! indicates the number of messages that were written.
@@ -106,43 +118,6 @@ class GarnetNetwork : public Network
     void regStats();
     void print(std::ostream& out) const;
 
-    // increment counters
-    void increment_injected_packets(int vnet) { m_packets_injected[vnet]++; }
-    void increment_received_packets(int vnet) { m_packets_received[vnet]++; }
-
-    void
-    increment_packet_network_latency(Cycles latency, int vnet)
-    {
-        m_packet_network_latency[vnet] += latency;
-    }
-
-    void
-    increment_packet_queueing_latency(Cycles latency, int vnet)
-    {
-        m_packet_queueing_latency[vnet] += latency;
-    }
-
-    void increment_injected_flits(int vnet) { m_flits_injected[vnet]++; }
-    void increment_received_flits(int vnet) { m_flits_received[vnet]++; }
-
-    void
-    increment_flit_network_latency(Cycles latency, int vnet)
-    {
-        m_flit_network_latency[vnet] += latency;
-    }
-
-    void
-    increment_flit_queueing_latency(Cycles latency, int vnet)
-    {
-        m_flit_queueing_latency[vnet] += latency;
-    }
-
-    void
-    increment_total_hops(int hops)
-    {
-        m_total_hops += hops;
-    }
-
   protected:
     // Configuration
     int m_num_rows;
@@ -186,6 +161,14 @@ class GarnetNetwork : public Network
     Stats::Scalar  m_total_hops;
     Stats::Formula m_avg_hops;
 
+    // Power over the last stats window, see NetworkPower.hh
+    Stats::Scalar m_router_dynamic_power;
+    Stats::Scalar m_router_static_power;
+    Stats::Scalar m_link_dynamic_power;
+    Stats::Scalar m_link_static_power;
+    Stats::Formula m_total_power;
+    Stats::Scalar m_energy;
+
   private:
     GarnetNetwork(const GarnetNetwork& obj);
     GarnetNetwork& operator=(const GarnetNetwork& obj);
@@ -195,6 +178,24 @@ class GarnetNetwork : public Network
     std::vector<NetworkLink *> m_networklinks; // All flit links in the network
     std::vector<CreditLink *> m_creditlinks; // All credit links in the network
     std::vector<NetworkInterface *> m_nis;   // All NI's in Network
+
+    void closeTrace();
+
+    void collatePower();
+    void resetPower();
+
+    const std::string m_trace_capture;
+    const std::string m_trace_replay;
+    NetworkTraceWriter *m_trace_writer;
+    uint64_t m_trace_packets;
+    // packets of the trace being replayed not received yet
+    uint64_t m_replay_remaining;
+
+    // Start of the current power window and the flits each link had
+    // carried by then
+    NetworkPowerTable *m_power_table;
+    Tick m_power_window_start;
+    std::vector<unsigned int> m_link_flits_start;
 };
 
 inline std::ostream&
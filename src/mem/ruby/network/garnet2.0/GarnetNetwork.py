@@ -43,11 +43,18 @@ class GarnetNetwork(RubyNetwork):
     buffers_per_data_vc = Param.UInt32(4, "buffers per data virtual channel");
     buffers_per_ctrl_vc = Param.UInt32(1, "buffers per ctrl virtual channel");
     routing_algorithm = Param.Int(0,
-        "0: Weight-based Table, 1: XY, 2: Custom");
+        "0: Weight-based Table, 1: XY, 2: Custom, 3: West-first, "
+        "4: Odd-even, 5: Escape VC adaptive");
     enable_fault_model = Param.Bool(False, "enable network fault model");
     fault_model = Param.FaultModel(NULL, "network fault model");
     garnet_deadlock_threshold = Param.UInt32(50000,
                               "network-level deadlock threshold")
+    trace_capture = Param.String("",
+        "file to capture the packets injected into the network to")
+    trace_replay = Param.String("", "network trace whose packets the "
+        "network interfaces inject instead of their controllers' messages")
+    power_table = Param.String("", "per-event energies of the routers and "
+        "links (util/garnet-power-table.py), enables the power stats")
 
 class GarnetNetworkInterface(ClockedObject):
     type = 'GarnetNetworkInterface'
@@ -49,6 +49,7 @@ InputUnit::InputUnit(int id, PortDirection direction, Router *router)
     m_router = router;
     m_num_vcs = m_router->get_num_vcs();
     m_vc_per_vnet = m_router->get_vc_per_vnet();
+    m_num_buffered_flits = 0;
 
     m_num_buffer_reads.resize(m_num_vcs/m_vc_per_vnet);
     m_num_buffer_writes.resize(m_num_vcs/m_vc_per_vnet);
@@ -99,7 +100,7 @@ InputUnit::wakeup()
 
             // Route computation for this vc
             int outport = m_router->route_compute(t_flit->get_route(),
-                m_id, m_direction);
+                m_id, vc, m_direction);
 
             // Update output port in VC
             // All flits in this packet will use this output port
@@ -113,6 +114,8 @@ InputUnit::wakeup()
 
         // Buffer the flit
         m_vcs[vc]->insertFlit(t_flit);
+        if (m_num_buffered_flits++ == 0)
+            m_router->set_inport_active(m_id);
 
         int vnet = vc/m_vc_per_vnet;
         // number of writes same as reads
@@ -109,6 +109,8 @@ class InputUnit : public Consumer
     inline flit*
     getTopFlit(int vc)
     {
+        if (--m_num_buffered_flits == 0)
+            m_router->set_inport_idle(m_id);
         return m_vcs[vc]->getTopFlit();
     }
 
@@ -133,6 +135,7 @@ class InputUnit : public Consumer
     }
 
     inline int get_inlink_id() { return m_in_link->get_id(); }
+    inline bool is_in_link_empty() { return m_in_link->isEmpty(); }
 
     inline void
     set_credit_link(CreditLink *credit_link)
@@ -161,6 +164,8 @@ class InputUnit : public Consumer
 
     // Input Virtual channels
     std::vector<VirtualChannel *> m_vcs;
+    // Flits buffered across all input VCs
+    int m_num_buffered_flits;
 
     // Statistical variables
     std::vector<double> m_num_buffer_writes;
@@ -33,6 +33,7 @@
 
 #include "mem/ruby/network/garnet2.0/NetworkInterface.hh"
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 
@@ -41,6 +42,7 @@
 #include "debug/RubyNetwork.hh"
 #include "mem/ruby/network/MessageBuffer.hh"
 #include "mem/ruby/network/garnet2.0/Credit.hh"
+#include "mem/ruby/network/garnet2.0/TraceMessage.hh"
 #include "mem/ruby/network/garnet2.0/flitBuffer.hh"
 #include "mem/ruby/slicc_interface/Message.hh"
 
@@ -72,6 +74,16 @@ NetworkInterface::NetworkInterface(const Params *p)
     }
 
     m_stall_count.resize(m_virtual_networks);
+    m_replay_packets.resize(m_virtual_networks);
+
+    resetStats();
+}
+
+void
+NetworkInterface::resetStats()
+{
+    m_vnet_stats.assign(m_virtual_networks, VnetStats());
+    m_total_hops = 0;
 }
 
 void
@@ -82,6 +94,13 @@ NetworkInterface::init()
     }
 }
 
+void
+NetworkInterface::startup()
+{
+    if (m_net_ptr->isReplayingTrace())
+        scheduleReplay();
+}
+
 NetworkInterface::~NetworkInterface()
 {
     deletePointers(m_out_vc_state);
@@ -142,27 +161,30 @@ NetworkInterface::dequeueCallback()
 void
 NetworkInterface::incrementStats(flit *t_flit)
 {
-    int vnet = t_flit->get_vnet();
+    VnetStats &stats = m_vnet_stats[t_flit->get_vnet()];
 
     // Latency
-    m_net_ptr->increment_received_flits(vnet);
+    stats.flits_received++;
     Cycles network_delay =
         t_flit->get_dequeue_time() - t_flit->get_enqueue_time() - Cycles(1);
     Cycles src_queueing_delay = t_flit->get_src_delay();
     Cycles dest_queueing_delay = (curCycle() - t_flit->get_dequeue_time());
     Cycles queueing_delay = src_queueing_delay + dest_queueing_delay;
 
-    m_net_ptr->increment_flit_network_latency(network_delay, vnet);
-    m_net_ptr->increment_flit_queueing_latency(queueing_delay, vnet);
+    stats.flit_network_latency += network_delay;
+    stats.flit_queueing_latency += queueing_delay;
 
     if (t_flit->get_type() == TAIL_ || t_flit->get_type() == HEAD_TAIL_) {
-        m_net_ptr->increment_received_packets(vnet);
-        m_net_ptr->increment_packet_network_latency(network_delay, vnet);
-        m_net_ptr->increment_packet_queueing_latency(queueing_delay, vnet);
+        stats.packets_received++;
+        stats.packet_network_latency += network_delay;
+        stats.packet_queueing_latency += queueing_delay;
+
+        if (m_net_ptr->isCapturingTrace() || m_net_ptr->isReplayingTrace())
+            tracePacketReceived(t_flit->get_route());
     }
 
     // Hops
-    m_net_ptr->increment_total_hops(t_flit->get_route().hops_traversed);
+    m_total_hops += t_flit->get_route().hops_traversed;
 }
 
 /*
@@ -184,18 +206,25 @@ NetworkInterface::wakeup()
     MsgPtr msg_ptr;
     Tick curTime = clockEdge();
 
-    // Checking for messages coming from the protocol
-    // can pick up a message/cycle for each virtual net
-    for (int vnet = 0; vnet < inNode_ptr.size(); ++vnet) {
-        MessageBuffer *b = inNode_ptr[vnet];
-        if (b == nullptr) {
-            continue;
-        }
+    if (m_net_ptr->isReplayingTrace()) {
+        // The trace takes the place of the messages of the controller
+        replayPackets(curTime);
+    } else {
+        // Checking for messages coming from the protocol
+        // can pick up a message/cycle for each virtual net
+        for (int vnet = 0; vnet < inNode_ptr.size(); ++vnet) {
+            MessageBuffer *b = inNode_ptr[vnet];
+            if (b == nullptr) {
+                continue;
+            }
 
-        if (b->isReady(curTime)) { // Is there a message waiting
-            msg_ptr = b->peekMsgPtr();
-            if (flitisizeMessage(msg_ptr, vnet)) {
-                b->dequeue(curTime);
+            if (b->isReady(curTime)) { // Is there a message waiting
+                msg_ptr = b->peekMsgPtr();
+                int num_bytes = m_net_ptr->MessageSizeType_to_int(
+                    msg_ptr->getMessageSize());
+                if (flitisizeMessage(msg_ptr, vnet, num_bytes)) {
+                    b->dequeue(curTime);
+                }
             }
         }
     }
@@ -216,7 +245,13 @@ NetworkInterface::wakeup()
         // If a tail flit is received, enqueue into the protocol buffers if
         // space is available. Otherwise, exchange non-tail flits for credits.
         if (t_flit->get_type() == TAIL_ || t_flit->get_type() == HEAD_TAIL_) {
-            if (!messageEnqueuedThisCycle &&
+            if (m_net_ptr->isReplayingTrace()) {
+                // Replayed packets end here, their controller never sees
+                // them
+                sendCredit(t_flit, true);
+                incrementStats(t_flit);
+                delete t_flit;
+            } else if (!messageEnqueuedThisCycle &&
                 outNode_ptr[vnet]->areNSlotsAvailable(1, curTime)) {
                 // Space is available. Enqueue to protocol buffer.
                 outNode_ptr[vnet]->enqueue(t_flit->get_msg_ptr(), curTime,
@@ -322,23 +357,26 @@ NetworkInterface::checkStallQueue()
     return messageEnqueuedThisCycle;
 }
 
-// Embed the protocol message into flits
+// Embed the protocol message into flits. Replayed packets come with
+// their id in the trace.
 bool
-NetworkInterface::flitisizeMessage(MsgPtr msg_ptr, int vnet)
+NetworkInterface::flitisizeMessage(MsgPtr msg_ptr, int vnet, int num_bytes,
+                                   uint64_t trace_id)
 {
     Message *net_msg_ptr = msg_ptr.get();
     NetDest net_msg_dest = net_msg_ptr->getDestination();
 
-    // gets all the destinations associated with this message.
-    vector<NodeID> dest_nodes = net_msg_dest.getAllDest();
+    // gets the number of destinations associated with this message.
+    int num_dests = net_msg_dest.count();
 
     // Number of flits is dependent on the link bandwidth available.
     // This is expressed in terms of bytes/cycle or the flit size
-    int num_flits = (int) ceil((double) m_net_ptr->MessageSizeType_to_int(
-        net_msg_ptr->getMessageSize())/m_net_ptr->getNiFlitSize());
+    int num_flits = (int) ceil((double) num_bytes /
+                               m_net_ptr->getNiFlitSize());
 
     // loop to convert all multicast messages into unicast messages
-    for (int ctr = 0; ctr < dest_nodes.size(); ctr++) {
+    for (int destID = net_msg_dest.firstElement(); destID >= 0;
+         destID = net_msg_dest.nextElement(destID)) {
 
         // this will return a free output virtual channel
         int vc = calculateVC(vnet);
@@ -347,17 +385,17 @@ NetworkInterface::flitisizeMessage(MsgPtr msg_ptr, int vnet)
             return false ;
         }
         MsgPtr new_msg_ptr = msg_ptr->clone();
-        NodeID destID = dest_nodes[ctr];
 
         Message *new_net_msg_ptr = new_msg_ptr.get();
-        if (dest_nodes.size() > 1) {
+        if (num_dests > 1) {
             NetDest personal_dest;
             for (int m = 0; m < (int) MachineType_NUM; m++) {
                 if ((destID >= MachineType_base_number((MachineType) m)) &&
                     destID < MachineType_base_number((MachineType) (m+1))) {
                     // calculating the NetDest associated with this destID
                     personal_dest.clear();
-                    personal_dest.add((MachineID) {(MachineType) m, (destID -
+                    personal_dest.add((MachineID) {(MachineType) m,
+                        (NodeID) (destID -
                         MachineType_base_number((MachineType) m))});
                     new_net_msg_ptr->getDestination() = personal_dest;
                     break;
@@ -385,9 +423,15 @@ NetworkInterface::flitisizeMessage(MsgPtr msg_ptr, int vnet)
         // so that the first router increments it to 0
         route.hops_traversed = -1;
 
-        m_net_ptr->increment_injected_packets(vnet);
+        route.trace_id = trace_id;
+        if (m_net_ptr->isCapturingTrace()) {
+            route.trace_id = captureInjection(msg_ptr, vnet, destID,
+                                              num_bytes);
+        }
+
+        m_vnet_stats[vnet].packets_injected++;
         for (int i = 0; i < num_flits; i++) {
-            m_net_ptr->increment_injected_flits(vnet);
+            m_vnet_stats[vnet].flits_injected++;
             flit *fl = new flit(i, vc, vnet, route, num_flits, new_msg_ptr,
                 curCycle());
 
@@ -505,14 +549,19 @@ NetworkInterface::get_vnet(int vc)
 void
 NetworkInterface::checkReschedule()
 {
-    for (const auto& it : inNode_ptr) {
-        if (it == nullptr) {
-            continue;
-        }
+    if (m_net_ptr->isReplayingTrace()) {
+        // The protocol buffers are not read while replaying
+        scheduleReplay();
+    } else {
+        for (const auto& it : inNode_ptr) {
+            if (it == nullptr) {
+                continue;
+            }
 
-        while (it->isReady(clockEdge())) { // Is there a message waiting
-            scheduleEvent(Cycles(1));
-            return;
+            while (it->isReady(clockEdge())) { // Is there a message waiting
+                scheduleEvent(Cycles(1));
+                return;
+            }
         }
     }
 
@@ -542,6 +591,140 @@ NetworkInterface::functionalWrite(Packet *pkt)
     return num_functional_writes;
 }
 
+uint64_t
+NetworkInterface::captureInjection(const MsgPtr &msg_ptr, int vnet,
+                                   NodeID dest, int num_bytes)
+{
+    NetworkTraceRecord record;
+    // the tick the message became ready to the network
+    record.tick = msg_ptr->getLastEnqueueTime();
+    record.src = m_id;
+    record.dest = dest;
+    record.vnet = vnet;
+    record.size = num_bytes;
+
+    // The dependency is the last packet received by then, which need
+    // not be the last one received before the injection when the
+    // message waited for a VC
+    record.dep_id = 0;
+    record.dep_delay = 0;
+    for (auto it = m_recent_received.rbegin();
+         it != m_recent_received.rend(); ++it) {
+        if (it->second <= record.tick) {
+            record.dep_id = it->first;
+            record.dep_delay = record.tick - it->second;
+            break;
+        }
+    }
+
+    return m_net_ptr->captureTrace(record);
+}
+
+void
+NetworkInterface::tracePacketReceived(const RouteInfo &route)
+{
+    if (m_net_ptr->isReplayingTrace()) {
+        auto it = m_replay_deps.find(route.trace_id);
+        if (it != m_replay_deps.end()) {
+            it->second.received = curTick();
+            scheduleReplay();
+        }
+        m_net_ptr->replayPacketReceived();
+    } else {
+        m_recent_received.push_back(make_pair(route.trace_id, curTick()));
+        if (m_recent_received.size() > TRACE_RECENT_PACKETS)
+            m_recent_received.pop_front();
+    }
+}
+
+// The tick a replayed packet can be injected at, or MaxTick while its
+// dependency has not been received
+Tick
+NetworkInterface::replayReadyTime(const NetworkTraceRecord &record) const
+{
+    if (record.dep_id == 0)
+        return record.tick;
+
+    auto it = m_replay_deps.find(record.dep_id);
+    assert(it != m_replay_deps.end());
+    if (it->second.received == MaxTick)
+        return MaxTick;
+    return it->second.received + record.dep_delay;
+}
+
+// Injects the next packet of each vnet once it is ready, keeping the
+// order of the trace within a vnet as the protocol buffers do
+void
+NetworkInterface::replayPackets(Tick curTime)
+{
+    for (int vnet = 0; vnet < m_virtual_networks; ++vnet) {
+        std::deque<NetworkTraceRecord> &packets = m_replay_packets[vnet];
+        if (packets.empty())
+            continue;
+
+        const NetworkTraceRecord &record = packets.front();
+        Tick ready_time = replayReadyTime(record);
+        if (ready_time > curTime)
+            continue;
+
+        NetDest destination;
+        for (int m = 0; m < (int) MachineType_NUM; m++) {
+            if (record.dest < MachineType_base_number((MachineType) (m+1))) {
+                destination.add((MachineID) {(MachineType) m,
+                    (NodeID) (record.dest -
+                    MachineType_base_number((MachineType) m))});
+                break;
+            }
+        }
+
+        MsgPtr msg_ptr(new TraceMessage(ready_time, destination));
+        if (flitisizeMessage(msg_ptr, vnet, record.size, record.id)) {
+            DPRINTF(RubyNetwork, "Network Interface %d replayed packet %d "
+                    "ready at %lld\n", m_id, record.id, ready_time);
+            if (record.dep_id != 0) {
+                auto it = m_replay_deps.find(record.dep_id);
+                if (--it->second.pending == 0)
+                    m_replay_deps.erase(it);
+            }
+            packets.pop_front();
+        }
+    }
+}
+
+// Wakes the NI up when the next replayed packet is ready, which is the
+// next cycle if it is waiting for a VC
+void
+NetworkInterface::scheduleReplay()
+{
+    Tick ready_time = MaxTick;
+    for (const auto &packets : m_replay_packets) {
+        if (!packets.empty())
+            ready_time = min(ready_time, replayReadyTime(packets.front()));
+    }
+
+    if (ready_time == MaxTick)
+        return;
+
+    if (ready_time <= curTick()) {
+        scheduleEvent(Cycles(1));
+    } else {
+        scheduleEventAbsolute(
+            clockEdge(ticksToCycles(ready_time - curTick())));
+    }
+}
+
+void
+NetworkInterface::addReplayPacket(const NetworkTraceRecord &record)
+{
+    m_replay_packets[record.vnet].push_back(record);
+
+    if (record.dep_id != 0) {
+        auto it = m_replay_deps.emplace(record.dep_id,
+                                        ReplayDependency{0, MaxTick}).first;
+        it->second.pending++;
+    }
+}
+
 NetworkInterface *
 GarnetNetworkInterfaceParams::create()
 {
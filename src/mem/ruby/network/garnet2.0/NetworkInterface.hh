@@ -34,7 +34,10 @@
 #ifndef __MEM_RUBY_NETWORK_GARNET_NETWORK_INTERFACE_HH__
 #define __MEM_RUBY_NETWORK_GARNET_NETWORK_INTERFACE_HH__
 
+#include <deque>
 #include <iostream>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "mem/ruby/common/Consumer.hh"
@@ -42,6 +45,7 @@
 #include "mem/ruby/network/garnet2.0/CreditLink.hh"
 #include "mem/ruby/network/garnet2.0/GarnetNetwork.hh"
 #include "mem/ruby/network/garnet2.0/NetworkLink.hh"
+#include "mem/ruby/network/garnet2.0/NetworkTrace.hh"
 #include "mem/ruby/network/garnet2.0/OutVcState.hh"
 #include "mem/ruby/slicc_interface/Message.hh"
 #include "params/GarnetNetworkInterface.hh"
@@ -57,6 +61,7 @@ class NetworkInterface : public ClockedObject, public Consumer
     ~NetworkInterface();
 
     void init();
+    void startup();
 
     void addInPort(NetworkLink *in_link, CreditLink *credit_link);
     void addOutPort(NetworkLink *out_link, CreditLink *credit_link,
@@ -74,6 +79,30 @@ class NetworkInterface : public ClockedObject, public Consumer
 
     uint32_t functionalWrite(Packet *);
 
+    // Queues a packet of the trace being replayed, see NetworkTrace.hh
+    void addReplayPacket(const NetworkTraceRecord &record);
+
+    // Packets and flits injected and received by this interface. They
+    // are kept here rather than in GarnetNetwork, as interfaces may run
+    // on different event queues, and are collated by
+    // GarnetNetwork::collateStats().
+    struct VnetStats
+    {
+        Counter packets_injected;
+        Counter packets_received;
+        Counter packet_network_latency;
+        Counter packet_queueing_latency;
+        Counter flits_injected;
+        Counter flits_received;
+        Counter flit_network_latency;
+        Counter flit_queueing_latency;
+    };
+
+    const VnetStats &getVnetStats(int vnet) const
+    { return m_vnet_stats[vnet]; }
+    Counter getTotalHops() const { return m_total_hops; }
+    void resetStats();
+
   private:
     GarnetNetwork *m_net_ptr;
     const NodeID m_id;
@@ -108,7 +137,8 @@ class NetworkInterface : public ClockedObject, public Consumer
     std::vector<int> vc_busy_counter;
 
     bool checkStallQueue();
-    bool flitisizeMessage(MsgPtr msg_ptr, int vnet);
+    bool flitisizeMessage(MsgPtr msg_ptr, int vnet, int num_bytes,
+                          uint64_t trace_id = 0);
     int calculateVC(int vnet);
 
     void scheduleOutputLink();
@@ -116,6 +146,35 @@ class NetworkInterface : public ClockedObject, public Consumer
     void sendCredit(flit *t_flit, bool is_free);
 
     void incrementStats(flit *t_flit);
+
+    // Trace capture and replay
+    uint64_t captureInjection(const MsgPtr &msg_ptr, int vnet, NodeID dest,
+                              int num_bytes);
+    void tracePacketReceived(const RouteInfo &route);
+    Tick replayReadyTime(const NetworkTraceRecord &record) const;
+    void replayPackets(Tick curTime);
+    void scheduleReplay();
+
+    // Packets received last with their ticks, the most recent at the
+    // back, to find the one an injection depends on when capturing
+    static const int TRACE_RECENT_PACKETS = 16;
+    std::deque<std::pair<uint64_t, Tick>> m_recent_received;
+
+    // Packets still to replay, per vnet in trace order
+    std::vector<std::deque<NetworkTraceRecord>> m_replay_packets;
+
+    // Received packets the packets still to replay depend on, with the
+    // number of those and the tick it was received at, MaxTick until
+    // then. An entry goes once its last dependant has been injected.
+    struct ReplayDependency
+    {
+        int pending;
+        Tick received;
+    };
+    std::unordered_map<uint64_t, ReplayDependency> m_replay_deps;
+
+    std::vector<VnetStats> m_vnet_stats;
+    Counter m_total_hops;
 };
 
 #endif // __MEM_RUBY_NETWORK_GARNET_NETWORK_INTERFACE_HH__
@@ -40,7 +40,8 @@ NetworkLink::NetworkLink(const Params *p)
       m_type(NUM_LINK_TYPES_),
       m_latency(p->link_latency),
       linkBuffer(new flitBuffer()), link_consumer(nullptr),
-      link_srcQueue(nullptr), m_link_utilized(0),
+      link_srcQueue(nullptr), m_ready_ports(nullptr), m_ready_port(-1),
+      m_link_utilized(0),
       m_vc_load(p->vcs_per_vnet * p->virt_nets)
 {
 }
@@ -62,19 +63,47 @@ NetworkLink::setSourceQueue(flitBuffer *srcQueue)
     link_srcQueue = srcQueue;
 }
 
+void
+NetworkLink::setReadyPorts(PortSet *ready_ports, int port)
+{
+    m_ready_ports = ready_ports;
+    m_ready_port = port;
+}
+
 void
 NetworkLink::wakeup()
 {
     if (link_srcQueue->isReady(curCycle())) {
         flit *t_flit = link_srcQueue->getTopFlit();
         t_flit->set_time(curCycle() + m_latency);
-        linkBuffer->insert(t_flit);
-        link_consumer->scheduleEventAbsolute(clockEdge(m_latency));
         m_link_utilized++;
         m_vc_load[t_flit->get_vc()]++;
+
+        // The link runs on the event queue of the unit feeding it. When
+        // its consumer runs on another queue, the link buffer belongs to
+        // that queue's thread and the flit is handed over with an event
+        // on it. GarnetNetwork checks that the link latency covers a
+        // simulation quantum, so the flit is only seen on arrival, as it
+        // would be in a serial run.
+        EventQueue *consumer_eq = link_consumer->wakeupEventQueue();
+        if (inParallelMode && consumer_eq != curEventQueue()) {
+            consumer_eq->schedule(new DeliveryEvent(this, t_flit),
+                                  clockEdge(m_latency));
+        } else {
+            deliver(t_flit, clockEdge(m_latency));
+        }
     }
 }
 
+void
+NetworkLink::deliver(flit *t_flit, Tick arrival_time)
+{
+    linkBuffer->insert(t_flit);
+    link_consumer->scheduleEventAbsolute(arrival_time);
+    if (m_ready_ports)
+        m_ready_ports->set(m_ready_port);
+}
+
 NetworkLink *
 NetworkLinkParams::create()
 {
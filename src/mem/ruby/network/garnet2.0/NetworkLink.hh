@@ -42,6 +42,7 @@
 #include "mem/ruby/network/garnet2.0/flitBuffer.hh"
 #include "params/NetworkLink.hh"
 #include "sim/clocked_object.hh"
+#include "sim/eventq.hh"
 
 class GarnetNetwork;
 
@@ -54,10 +55,13 @@ class NetworkLink : public ClockedObject, public Consumer
 
     void setLinkConsumer(Consumer *consumer);
     void setSourceQueue(flitBuffer *srcQueue);
+    // Mark port in ready_ports whenever a flit is put on the link
+    void setReadyPorts(PortSet *ready_ports, int port);
     void setType(link_type type) { m_type = type; }
     link_type getType() { return m_type; }
     void print(std::ostream& out) const {}
     int get_id() const { return m_id; }
+    Cycles getLatency() const { return m_latency; }
     void wakeup();
 
     unsigned int getLinkUtilization() const { return m_link_utilized; }
@@ -65,6 +69,7 @@ class NetworkLink : public ClockedObject, public Consumer
 
     inline bool isReady(Cycles curTime)
     { return linkBuffer->isReady(curTime); }
+    inline bool isEmpty() { return linkBuffer->isEmpty(); }
 
     inline flit* peekLink()       { return linkBuffer->peekTopFlit(); }
     inline flit* consumeLink()    { return linkBuffer->getTopFlit(); }
@@ -72,6 +77,30 @@ class NetworkLink : public ClockedObject, public Consumer
     uint32_t functionalWrite(Packet *);
 
   private:
+    /**
+     * Carries a flit to a consumer on another event queue and puts it
+     * on the link there once it arrives, see wakeup().
+     */
+    class DeliveryEvent : public Event
+    {
+      public:
+        DeliveryEvent(NetworkLink *link, flit *t_flit)
+            // Deliver ahead of the consumer wakeups of the same tick
+            : Event(Default_Pri - 1, AutoDelete),
+              m_link(link), m_flit(t_flit)
+        {
+        }
+
+        void process() { m_link->deliver(m_flit, when()); }
+        const char *description() const { return "NetworkLink delivery"; }
+
+      private:
+        NetworkLink *m_link;
+        flit *m_flit;
+    };
+
+    void deliver(flit *t_flit, Tick arrival_time);
+
     const int m_id;
     link_type m_type;
     const Cycles m_latency;
@@ -79,6 +108,8 @@ class NetworkLink : public ClockedObject, public Consumer
     flitBuffer *linkBuffer;
     Consumer *link_consumer;
     flitBuffer *link_srcQueue;
+    PortSet *m_ready_ports;
+    int m_ready_port;
 
     // Statistical variables
     unsigned int m_link_utilized;
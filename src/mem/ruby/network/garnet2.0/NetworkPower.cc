@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Authors: agent
+ */
+
+#include "mem/ruby/network/garnet2.0/NetworkPower.hh"
+
+#include <fstream>
+#include <sstream>
+
+#include "base/misc.hh"
+
+using namespace std;
+
+// Parses the key=value fields of an entry into the given variables,
+// all of which have to be present
+static void
+parseFields(istringstream &fields, const map<string, double *> &values,
+            const string &filename, int line_num)
+{
+    size_t found = 0;
+    string field;
+    while (fields >> field) {
+        size_t eq = field.find('=');
+        auto it = values.find(field.substr(0, eq));
+        fatal_if(eq == string::npos || it == values.end(),
+                 "%s:%d: unexpected field '%s'\n", filename, line_num, field);
+
+        istringstream value(field.substr(eq + 1));
+        fatal_if(!(value >> *it->second) || !value.eof(),
+                 "%s:%d: bad value in '%s'\n", filename, line_num, field);
+        found++;
+    }
+
+    fatal_if(found != values.size(), "%s:%d: expected %d fields, found %d\n",
+             filename, line_num, values.size(), found);
+}
+
+NetworkPowerTable::NetworkPowerTable(const string &filename)
+    : m_filename(filename), m_voltage(0), m_link({0, 0})
+{
+    ifstream file(filename);
+    fatal_if(!file, "Failed to open the network power table %s\n", filename);
+
+    bool has_link = false;
+    string line;
+    for (int line_num = 1; getline(file, line); line_num++) {
+        line = line.substr(0, line.find('#'));
+        istringstream fields(line);
+
+        string kind;
+        if (!(fields >> kind)) {
+            continue;
+        }
+
+        if (kind == "voltage") {
+            fatal_if(!(fields >> m_voltage) || m_voltage <= 0,
+                     "%s:%d: bad voltage\n", filename, line_num);
+        } else if (kind == "router") {
+            int inports, outports;
+            fatal_if(!(fields >> inports >> outports),
+                     "%s:%d: expected the router's number of ports\n",
+                     filename, line_num);
+
+            RouterEnergy &e = m_routers[make_pair(inports, outports)];
+            parseFields(fields, {
+                    {"buffer_write", &e.buffer_write},
+                    {"buffer_read", &e.buffer_read},
+                    {"sw_input_arbiter", &e.sw_input_arbiter},
+                    {"sw_output_arbiter", &e.sw_output_arbiter},
+                    {"crossbar", &e.crossbar},
+                    {"clock", &e.clock},
+                    {"leakage", &e.leakage}},
+                filename, line_num);
+        } else if (kind == "link") {
+            parseFields(fields, {
+                    {"flit", &m_link.flit},
+                    {"leakage", &m_link.leakage}},
+                filename, line_num);
+            has_link = true;
+        } else {
+            fatal("%s:%d: unknown entry '%s'\n", filename, line_num, kind);
+        }
+    }
+
+    fatal_if(m_voltage <= 0, "%s: no voltage given\n", filename);
+    fatal_if(!has_link, "%s: no link entry\n", filename);
+}
+
+const RouterEnergy &
+NetworkPowerTable::getRouterEnergy(int inports, int outports) const
+{
+    auto it = m_routers.find(make_pair(inports, outports));
+    fatal_if(it == m_routers.end(),
+             "%s: no entry for routers with %d inports and %d outports\n",
+             m_filename, inports, outports);
+    return it->second;
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Authors: agent
+ */
+
+/*
+ * Inline power model of garnet2.0. The energy of every router and link
+ * event (buffer write and read, switch arbitration, crossbar and link
+ * traversal), the clock energy per cycle and the leakage power are read
+ * once at startup from a table, which util/garnet-power-table.py
+ * computes with DSENT for the network's configuration. At every stats
+ * dump the routers and the network turn the activity since the last
+ * dump or stats reset into dynamic and static power, so the power of
+ * each stats window needs no post-processing.
+ *
+ * The table lists its energies at a nominal voltage. Dynamic energies
+ * are scaled with the square of the clock domain's voltage relative to
+ * it and leakage linearly, so the power follows DVFS of the routers and
+ * links.
+ *
+ * Table format, one entry per line, '#' starts a comment:
+ *
+ *   voltage <V>
+ *   router <inports> <outports> buffer_write=<J> buffer_read=<J>
+ *       sw_input_arbiter=<J> sw_output_arbiter=<J> crossbar=<J>
+ *       clock=<J> leakage=<W>
+ *   link flit=<J> leakage=<W>
+ *
+ * where each router entry is on a single line.
+ */
+
+#ifndef __MEM_RUBY_NETWORK_GARNET_NETWORK_POWER_HH__
+#define __MEM_RUBY_NETWORK_GARNET_NETWORK_POWER_HH__
+
+#include <map>
+#include <string>
+#include <utility>
+
+// Energy per event in joules, leakage in watts
+struct RouterEnergy
+{
+    double buffer_write;
+    double buffer_read;
+    double sw_input_arbiter;
+    double sw_output_arbiter;
+    double crossbar;
+    // per router cycle
+    double clock;
+    double leakage;
+};
+
+struct LinkEnergy
+{
+    double flit;
+    double leakage;
+};
+
+class NetworkPowerTable
+{
+  public:
+    NetworkPowerTable(const std::string &filename);
+
+    // Energies of a router with the given ports, fatal if the table has
+    // no entry for it
+    const RouterEnergy &getRouterEnergy(int inports, int outports) const;
+    const LinkEnergy &getLinkEnergy() const { return m_link; }
+
+    // Scale factors of the dynamic and the static power at a clock
+    // domain voltage
+    double
+    dynamicScale(double voltage) const
+    {
+        double ratio = voltage / m_voltage;
+        return ratio * ratio;
+    }
+    double staticScale(double voltage) const { return voltage / m_voltage; }
+
+  private:
+    const std::string m_filename;
+    double m_voltage;
+    std::map<std::pair<int, int>, RouterEnergy> m_routers;
+    LinkEnergy m_link;
+};
+
+#endif // __MEM_RUBY_NETWORK_GARNET_NETWORK_POWER_HH__
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Authors: agent
+ */
+
+#include "mem/ruby/network/garnet2.0/NetworkTrace.hh"
+
+#include "base/misc.hh"
+#include "proto/network.pb.h"
+#include "proto/protoio.hh"
+#include "sim/core.hh"
+
+NetworkTraceWriter::NetworkTraceWriter(const std::string &filename,
+                                       const std::string &obj_id,
+                                       int num_nodes, int num_vnets)
+    : m_stream(new ProtoOutputStream(filename))
+{
+    ProtoMessage::NetworkHeader header_msg;
+    header_msg.set_obj_id(obj_id);
+    header_msg.set_tick_freq(SimClock::Frequency);
+    header_msg.set_num_nodes(num_nodes);
+    header_msg.set_num_vnets(num_vnets);
+    m_stream->write(header_msg);
+}
+
+NetworkTraceWriter::~NetworkTraceWriter()
+{
+    // flushes and closes the file
+    delete m_stream;
+}
+
+void
+NetworkTraceWriter::write(const NetworkTraceRecord &record)
+{
+    ProtoMessage::NetworkPacket pkt_msg;
+
+    pkt_msg.set_id(record.id);
+    pkt_msg.set_tick(record.tick);
+    pkt_msg.set_src(record.src);
+    pkt_msg.set_dest(record.dest);
+    pkt_msg.set_vnet(record.vnet);
+    pkt_msg.set_size(record.size);
+    if (record.dep_id != 0) {
+        pkt_msg.set_dep_id(record.dep_id);
+        pkt_msg.set_dep_delay(record.dep_delay);
+    }
+
+    m_stream->write(pkt_msg);
+}
+
+NetworkTraceReader::NetworkTraceReader(const std::string &filename,
+                                       int num_nodes, int num_vnets)
+    : m_stream(new ProtoInputStream(filename))
+{
+    ProtoMessage::NetworkHeader header_msg;
+    if (!m_stream->read(header_msg)) {
+        fatal("Failed to read the network trace header from %s\n",
+              filename);
+    }
+
+    fatal_if(header_msg.tick_freq() != SimClock::Frequency,
+             "Network trace %s was recorded with a tick frequency of %d, "
+             "not %d\n", filename, header_msg.tick_freq(),
+             SimClock::Frequency);
+    fatal_if(header_msg.num_nodes() != num_nodes ||
+             header_msg.num_vnets() > num_vnets,
+             "Network trace %s was recorded with %d nodes and %d vnets, "
+             "the network has %d and %d\n", filename,
+             header_msg.num_nodes(), header_msg.num_vnets(),
+             num_nodes, num_vnets);
+}
+
+NetworkTraceReader::~NetworkTraceReader()
+{
+    delete m_stream;
+}
+
+bool
+NetworkTraceReader::read(NetworkTraceRecord &record)
+{
+    ProtoMessage::NetworkPacket pkt_msg;
+    if (!m_stream->read(pkt_msg))
+        return false;
+
+    record.id = pkt_msg.id();
+    record.tick = pkt_msg.tick();
+    record.src = pkt_msg.src();
+    record.dest = pkt_msg.dest();
+    record.vnet = pkt_msg.vnet();
+    record.size = pkt_msg.size();
+    record.dep_id = pkt_msg.has_dep_id() ? pkt_msg.dep_id() : 0;
+    record.dep_delay = pkt_msg.has_dep_delay() ? pkt_msg.dep_delay() : 0;
+    return true;
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Authors: agent
+ */
+
+/*
+ * Capture and replay of the traffic of garnet2.0. With trace_capture
+ * set, every network interface records the unicast packets it injects
+ * into a protobuf trace (src/proto/network.proto). With trace_replay
+ * set, the interfaces inject the packets of such a trace instead of the
+ * messages of their controllers, so different network configurations
+ * can be compared on the same traffic.
+ *
+ * A packet is replayed relative to its dependency, the packet its source
+ * had received last when it was captured, keeping the delay between the
+ * two. Packets without a dependency go at their captured tick. The
+ * simulation exits once all the packets of the trace have been
+ * received.
+ *
+ * Replay is not a standalone network simulation: it runs the same
+ * system as the capture, with the cores, sequencers and controllers
+ * still simulated and only their network traffic discarded. The
+ * sequencers do not check for deadlocks while replaying, since their
+ * requests never complete.
+ */
+
+#ifndef __MEM_RUBY_NETWORK_GARNET_NETWORK_TRACE_HH__
+#define __MEM_RUBY_NETWORK_GARNET_NETWORK_TRACE_HH__
+
+#include <string>
+
+#include "base/types.hh"
+#include "mem/ruby/common/TypeDefines.hh"
+
+class ProtoInputStream;
+class ProtoOutputStream;
+
+struct NetworkTraceRecord
+{
+    // sequential id, starting at 1
+    uint64_t id;
+    // tick the source made the packet available to the network
+    Tick tick;
+    NodeID src;
+    NodeID dest;
+    int vnet;
+    // size in bytes
+    int size;
+    // packet the source received last before tick, 0 for none, and the
+    // ticks in between
+    uint64_t dep_id;
+    Tick dep_delay;
+};
+
+class NetworkTraceWriter
+{
+  public:
+    NetworkTraceWriter(const std::string &filename,
+                       const std::string &obj_id, int num_nodes,
+                       int num_vnets);
+    ~NetworkTraceWriter();
+
+    void write(const NetworkTraceRecord &record);
+
+  private:
+    ProtoOutputStream *m_stream;
+};
+
+class NetworkTraceReader
+{
+  public:
+    NetworkTraceReader(const std::string &filename, int num_nodes,
+                       int num_vnets);
+    ~NetworkTraceReader();
+
+    // Returns false once the trace is exhausted
+    bool read(NetworkTraceRecord &record);
+
+  private:
+    ProtoInputStream *m_stream;
+};
+
+#endif // __MEM_RUBY_NETWORK_GARNET_NETWORK_TRACE_HH__
@@ -51,9 +51,15 @@ OutputUnit::OutputUnit(int id, PortDirection direction, Router *router)
     m_vc_per_vnet = m_router->get_vc_per_vnet();
     m_out_buffer = new flitBuffer();
 
+    m_free_credits.resize(m_router->get_num_vnets(), 0);
+    m_total_free_credits = 0;
     for (int i = 0; i < m_num_vcs; i++) {
         m_outvc_state.push_back(new OutVcState(i, m_router->get_net_ptr()));
+        m_free_credits[i / m_vc_per_vnet] +=
+            m_outvc_state[i]->get_max_credit_count();
+        m_total_free_credits += m_outvc_state[i]->get_max_credit_count();
     }
+    m_max_credits = m_total_free_credits;
 }
 
 OutputUnit::~OutputUnit()
@@ -70,6 +76,8 @@ OutputUnit::decrement_credit(int out_vc)
             m_router->get_id(), m_id, out_vc, m_router->curCycle());
 
     m_outvc_state[out_vc]->decrement_credit();
+    m_free_credits[out_vc / m_vc_per_vnet]--;
+    m_total_free_credits--;
 }
 
 void
@@ -80,6 +88,8 @@ OutputUnit::increment_credit(int out_vc)
             m_router->get_id(), m_id, out_vc, m_router->curCycle());
 
     m_outvc_state[out_vc]->increment_credit();
+    m_free_credits[out_vc / m_vc_per_vnet]++;
+    m_total_free_credits++;
 }
 
 // Check if the output VC (i.e., input VC at next router)
@@ -98,7 +108,14 @@ bool
 OutputUnit::has_free_vc(int vnet)
 {
     int vc_base = vnet*m_vc_per_vnet;
-    for (int vc = vc_base; vc < vc_base + m_vc_per_vnet; vc++) {
+    return has_free_vc(vc_base, vc_base + m_vc_per_vnet - 1);
+}
+
+// Same as above, restricted to output VCs first_vc..last_vc
+bool
+OutputUnit::has_free_vc(int first_vc, int last_vc)
+{
+    for (int vc = first_vc; vc <= last_vc; vc++) {
         if (is_vc_idle(vc, m_router->curCycle()))
             return true;
     }
@@ -111,7 +128,13 @@ int
 OutputUnit::select_free_vc(int vnet)
 {
     int vc_base = vnet*m_vc_per_vnet;
-    for (int vc = vc_base; vc < vc_base + m_vc_per_vnet; vc++) {
+    return select_free_vc(vc_base, vc_base + m_vc_per_vnet - 1);
+}
+
+int
+OutputUnit::select_free_vc(int first_vc, int last_vc)
+{
+    for (int vc = first_vc; vc <= last_vc; vc++) {
         if (is_vc_idle(vc, m_router->curCycle())) {
             m_outvc_state[vc]->setState(ACTIVE_, m_router->curCycle());
             return vc;
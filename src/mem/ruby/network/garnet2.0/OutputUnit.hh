@@ -59,7 +59,9 @@ class OutputUnit : public Consumer
     void increment_credit(int out_vc);
     bool has_credit(int out_vc);
     bool has_free_vc(int vnet);
+    bool has_free_vc(int first_vc, int last_vc);
     int select_free_vc(int vnet);
+    int select_free_vc(int first_vc, int last_vc);
 
     inline PortDirection get_direction() { return m_direction; }
 
@@ -69,12 +71,21 @@ class OutputUnit : public Consumer
         return m_outvc_state[vc]->get_credit_count();
     }
 
+    // Buffer slots currently free at the downstream router, within one
+    // vnet or across all of them. Used as the congestion estimate by
+    // adaptive routing.
+    inline int get_free_credits(int vnet) { return m_free_credits[vnet]; }
+    inline int get_free_credits() { return m_total_free_credits; }
+    inline int get_max_credits() { return m_max_credits; }
+
     inline int
     get_outlink_id()
     {
         return m_out_link->get_id();
     }
 
+    inline bool is_credit_link_empty() { return m_credit_link->isEmpty(); }
+
     inline void
     set_vc_state(VC_state_type state, int vc, Cycles curTime)
     {
@@ -108,6 +119,11 @@ class OutputUnit : public Consumer
     flitBuffer *m_out_buffer; // This is for the network link to consume
     std::vector<OutVcState *> m_outvc_state; // vc state of downstream router
 
+    // Running sums of the credit counts in m_outvc_state
+    std::vector<int> m_free_credits; // per vnet
+    int m_total_free_credits;
+    int m_max_credits;
+
 };
 
 #endif // __MEM_RUBY_NETWORK_GARNET_OUTPUT_UNIT_HH__
@@ -40,6 +40,7 @@
 #include "mem/ruby/network/garnet2.0/GarnetNetwork.hh"
 #include "mem/ruby/network/garnet2.0/InputUnit.hh"
 #include "mem/ruby/network/garnet2.0/NetworkLink.hh"
+#include "mem/ruby/network/garnet2.0/NetworkPower.hh"
 #include "mem/ruby/network/garnet2.0/OutputUnit.hh"
 #include "mem/ruby/network/garnet2.0/RoutingUnit.hh"
 #include "mem/ruby/network/garnet2.0/SwitchAllocator.hh"
@@ -48,7 +49,8 @@ using namespace std;
 using m5::stl_helpers::deletePointers;
 
 Router::Router(const Params *p)
-    : BasicRouter(p), Consumer(this)
+    : BasicRouter(p), Consumer(this), m_power_table(nullptr),
+      m_energy(nullptr), m_power_start()
 {
     m_latency = p->latency;
     m_virtual_networks = p->virt_nets;
@@ -86,9 +88,12 @@ Router::wakeup()
 {
     DPRINTF(RubyNetwork, "Router %d woke up\n", m_id);
 
-    // check for incoming flits
-    for (int inport = 0; inport < m_input_unit.size(); inport++) {
+    // check for incoming flits, only on links that carry some
+    for (int inport = m_ready_inports.first(); inport >= 0;
+         inport = m_ready_inports.next(inport + 1)) {
         m_input_unit[inport]->wakeup();
+        if (m_input_unit[inport]->is_in_link_empty())
+            m_ready_inports.clear(inport);
     }
 
     // check for incoming credits
@@ -97,8 +102,11 @@ Router::wakeup()
     //     credit traversal (1-cycle) + SA (1-cycle) + Link Traversal (1-cycle)
     // if we want the credit update to take place after SA, this loop should
     // be moved after the SA request
-    for (int outport = 0; outport < m_output_unit.size(); outport++) {
+    for (int outport = m_ready_outports.first(); outport >= 0;
+         outport = m_ready_outports.next(outport + 1)) {
         m_output_unit[outport]->wakeup();
+        if (m_output_unit[outport]->is_credit_link_empty())
+            m_ready_outports.clear(outport);
     }
 
     // Switch Allocation
@@ -118,6 +126,7 @@ Router::addInPort(PortDirection inport_dirn,
     input_unit->set_in_link(in_link);
     input_unit->set_credit_link(credit_link);
     in_link->setLinkConsumer(this);
+    in_link->setReadyPorts(&m_ready_inports, port_num);
     credit_link->setSourceQueue(input_unit->getCreditQueue());
 
     m_input_unit.push_back(input_unit);
@@ -137,6 +146,7 @@ Router::addOutPort(PortDirection outport_dirn,
     output_unit->set_out_link(out_link);
     output_unit->set_credit_link(credit_link);
     credit_link->setLinkConsumer(this);
+    credit_link->setReadyPorts(&m_ready_outports, port_num);
     out_link->setSourceQueue(output_unit->getOutQueue());
 
     m_output_unit.push_back(output_unit);
@@ -159,9 +169,25 @@ Router::getInportDirection(int inport)
 }
 
 int
-Router::route_compute(RouteInfo route, int inport, PortDirection inport_dirn)
+Router::route_compute(RouteInfo route, int inport, int invc,
+                      PortDirection inport_dirn)
 {
-    return m_routing_unit->outportCompute(route, inport, inport_dirn);
+    return m_routing_unit->outportCompute(route, inport, invc, inport_dirn);
+}
+
+void
+Router::outvc_range(const RouteInfo &route, int inport, int invc,
+                    int outport, int &first_vc, int &last_vc)
+{
+    m_routing_unit->outvcRange(route, inport, invc, outport,
+                               first_vc, last_vc);
+}
+
+int
+Router::escape_route(const RouteInfo &route, int inport, int invc,
+                     int outport)
+{
+    return m_routing_unit->escapeOutport(route, inport, invc, outport);
 }
 
 void
@@ -207,6 +233,25 @@ Router::regStats()
         .flags(Stats::nozero)
     ;
 
+    m_adaptive_routes
+        .name(name() + ".adaptive_routes")
+        .desc("Route computations with more than one admissible outport")
+        .flags(Stats::nozero)
+    ;
+
+    m_escape_routes
+        .name(name() + ".escape_routes")
+        .desc("Head flits moved to the escape network")
+        .flags(Stats::nozero)
+    ;
+
+    m_congestion
+        .name(name() + ".congestion")
+        .desc("Average fraction of downstream buffers occupied, "
+              "sampled at every route computation")
+        .flags(Stats::nozero)
+    ;
+
     m_sw_input_arbiter_activity
         .name(name() + ".sw_input_arbiter_activity")
         .flags(Stats::nozero)
@@ -216,6 +261,18 @@ Router::regStats()
         .name(name() + ".sw_output_arbiter_activity")
         .flags(Stats::nozero)
     ;
+
+    if (m_power_table) {
+        m_dynamic_power
+            .name(name() + ".dynamic_power")
+            .desc("Dynamic power over the last stats window (W)")
+            ;
+
+        m_static_power
+            .name(name() + ".static_power")
+            .desc("Leakage power (W)")
+            ;
+    }
 }
 
 void
@@ -231,6 +288,10 @@ Router::collateStats()
     m_sw_input_arbiter_activity = m_sw_alloc->get_input_arbiter_activity();
     m_sw_output_arbiter_activity = m_sw_alloc->get_output_arbiter_activity();
     m_crossbar_activity = m_switch->get_crossbar_activity();
+
+    m_adaptive_routes = m_routing_unit->get_adaptive_routes();
+    m_escape_routes = m_routing_unit->get_escape_routes();
+    m_congestion = m_routing_unit->get_congestion();
 }
 
 void
@@ -241,6 +302,72 @@ Router::resetStats()
             m_input_unit[i]->resetStats();
         }
     }
+
+    m_routing_unit->resetStats();
+}
+
+Router::Activity
+Router::getActivity() const
+{
+    Activity activity = Activity();
+
+    for (int i = 0; i < m_input_unit.size(); i++) {
+        for (int j = 0; j < m_virtual_networks; j++) {
+            activity.buffer_writes +=
+                m_input_unit[i]->get_buf_write_activity(j);
+            activity.buffer_reads += m_input_unit[i]->get_buf_read_activity(j);
+        }
+    }
+
+    activity.sw_input_arbiter = m_sw_alloc->get_input_arbiter_activity();
+    activity.sw_output_arbiter = m_sw_alloc->get_output_arbiter_activity();
+    activity.crossbar = m_switch->get_crossbar_activity();
+
+    return activity;
+}
+
+void
+Router::initPower(const NetworkPowerTable *table)
+{
+    m_power_table = table;
+    m_energy = &table->getRouterEnergy(get_num_inports(),
+                                       get_num_outports());
+    resetPower();
+}
+
+void
+Router::collatePower(Tick window)
+{
+    assert(m_power_table && window > 0);
+
+    Activity now = getActivity();
+    double energy =
+        (now.buffer_writes - m_power_start.buffer_writes) *
+        m_energy->buffer_write +
+        (now.buffer_reads - m_power_start.buffer_reads) *
+        m_energy->buffer_read +
+        (now.sw_input_arbiter - m_power_start.sw_input_arbiter) *
+        m_energy->sw_input_arbiter +
+        (now.sw_output_arbiter - m_power_start.sw_output_arbiter) *
+        m_energy->sw_output_arbiter +
+        (now.crossbar - m_power_start.crossbar) * m_energy->crossbar;
+
+    // The clock tree switches every cycle, at the current frequency
+    energy += double(window) / clockPeriod() * m_energy->clock;
+
+    double seconds = double(window) / SimClock::Frequency;
+    m_dynamic_power =
+        energy * m_power_table->dynamicScale(voltage()) / seconds;
+    m_static_power =
+        m_energy->leakage * m_power_table->staticScale(voltage());
+
+    m_power_start = now;
+}
+
+void
+Router::resetPower()
+{
+    m_power_start = getActivity();
 }
 
 void
@@ -53,6 +53,8 @@ class RoutingUnit;
 class SwitchAllocator;
 class CrossbarSwitch;
 class FaultModel;
+class NetworkPowerTable;
+struct RouterEnergy;
 
 class Router : public BasicRouter, public Consumer
 {
@@ -91,7 +93,18 @@ class Router : public BasicRouter, public Consumer
     PortDirection getOutportDirection(int outport);
     PortDirection getInportDirection(int inport);
 
-    int route_compute(RouteInfo route, int inport, PortDirection direction);
+    // Input ports holding flits in their input VCs, i.e., the ports the
+    // SwitchAllocator has to look at
+    void set_inport_active(int inport) { m_active_inports.set(inport); }
+    void set_inport_idle(int inport) { m_active_inports.clear(inport); }
+    const PortSet& get_active_inports() const { return m_active_inports; }
+
+    int route_compute(RouteInfo route, int inport, int invc,
+                      PortDirection direction);
+    void outvc_range(const RouteInfo &route, int inport, int invc,
+                     int outport, int &first_vc, int &last_vc);
+    int escape_route(const RouteInfo &route, int inport, int invc,
+                     int outport);
     void grant_switch(int inport, flit *t_flit);
     void schedule_wakeup(Cycles time);
 
@@ -103,6 +116,14 @@ class Router : public BasicRouter, public Consumer
     void collateStats();
     void resetStats();
 
+    // Power of the activity since the last call or resetPower(), over a
+    // window of the given ticks, see NetworkPower.hh
+    void initPower(const NetworkPowerTable *table);
+    void collatePower(Tick window);
+    void resetPower();
+    double getDynamicPower() const { return m_dynamic_power.value(); }
+    double getStaticPower() const { return m_static_power.value(); }
+
     // For Fault Model:
     bool get_fault_vector(int temperature, float fault_vector[]) {
         return m_network_ptr->fault_model->fault_vector(m_id, temperature,
@@ -117,6 +138,18 @@ class Router : public BasicRouter, public Consumer
     uint32_t functionalWrite(Packet *);
 
   private:
+    // Activity counts the router's energy is computed from
+    struct Activity
+    {
+        double buffer_writes;
+        double buffer_reads;
+        double sw_input_arbiter;
+        double sw_output_arbiter;
+        double crossbar;
+    };
+
+    Activity getActivity() const;
+
     Cycles m_latency;
     int m_virtual_networks, m_num_vcs, m_vc_per_vnet;
     GarnetNetwork *m_network_ptr;
@@ -127,6 +160,11 @@ class Router : public BasicRouter, public Consumer
     SwitchAllocator *m_sw_alloc;
     CrossbarSwitch *m_switch;
 
+    // Ports whose input link / credit link has flits in flight
+    PortSet m_ready_inports;
+    PortSet m_ready_outports;
+    PortSet m_active_inports;
+
     // Statistical variables required for power computations
     Stats::Scalar m_buffer_reads;
     Stats::Scalar m_buffer_writes;
@@ -135,6 +173,18 @@ class Router : public BasicRouter, public Consumer
     Stats::Scalar m_sw_output_arbiter_activity;
 
     Stats::Scalar m_crossbar_activity;
+
+    // Power model
+    const NetworkPowerTable *m_power_table;
+    const RouterEnergy *m_energy;
+    Activity m_power_start;
+    Stats::Scalar m_dynamic_power;
+    Stats::Scalar m_static_power;
+
+    // Adaptive routing
+    Stats::Scalar m_adaptive_routes;
+    Stats::Scalar m_escape_routes;
+    Stats::Scalar m_congestion;
 };
 
 #endif // __MEM_RUBY_NETWORK_GARNET_ROUTER_HH__
@@ -35,14 +35,34 @@
 
 #include "base/cast.hh"
 #include "mem/ruby/network/garnet2.0/InputUnit.hh"
+#include "mem/ruby/network/garnet2.0/OutputUnit.hh"
 #include "mem/ruby/network/garnet2.0/Router.hh"
 #include "mem/ruby/slicc_interface/Message.hh"
 
 RoutingUnit::RoutingUnit(Router *router)
+    : m_rng(router->get_id())
 {
     m_router = router;
     m_routing_table.clear();
     m_weight_table.clear();
+    resetStats();
+}
+
+void
+RoutingUnit::resetStats()
+{
+    m_adaptive_routes = 0;
+    m_escape_routes = 0;
+    m_congestion_sum = 0;
+    m_congestion_samples = 0;
+}
+
+double
+RoutingUnit::get_congestion()
+{
+    if (m_congestion_samples == 0)
+        return 0;
+    return m_congestion_sum / m_congestion_samples;
 }
 
 void
@@ -65,7 +85,7 @@ RoutingUnit::addWeight(int link_weight)
  */
 
 int
-RoutingUnit::lookupRoutingTable(int vnet, NetDest msg_destination)
+RoutingUnit::lookupRoutingTable(int vnet, const NetDest &msg_destination)
 {
     // First find all possible output link candidates
     // For ordered vnet, just choose the first
@@ -107,8 +127,8 @@ RoutingUnit::lookupRoutingTable(int vnet, NetDest msg_destination)
 
     // Randomly select any candidate output link
     int candidate = 0;
-    if (!(m_router->get_net_ptr())->isVNetOrdered(vnet))
-        candidate = rand() % num_candidates;
+    if (num_candidates > 1 && !(m_router->get_net_ptr())->isVNetOrdered(vnet))
+        candidate = m_rng.random<int>(0, num_candidates - 1);
 
     output_link = output_link_candidates.at(candidate);
     return output_link;
@@ -136,11 +156,21 @@ RoutingUnit::addOutDirection(PortDirection outport_dirn, int outport_idx)
 // table is provided here.
 
 int
-RoutingUnit::outportCompute(RouteInfo route, int inport,
+RoutingUnit::outportCompute(RouteInfo route, int inport, int invc,
                             PortDirection inport_dirn)
 {
     int outport = -1;
 
+    // Sample how full the downstream buffers of this router are
+    int free_credits = 0;
+    int max_credits = 0;
+    for (OutputUnit *output_unit : m_router->get_outputUnit_ref()) {
+        free_credits += output_unit->get_free_credits();
+        max_credits += output_unit->get_max_credits();
+    }
+    m_congestion_sum += 1.0 - (double)free_credits / max_credits;
+    m_congestion_samples++;
+
     if (route.dest_router == m_router->get_id()) {
 
         // Multiple NIs may be connected to this router,
@@ -163,6 +193,12 @@ RoutingUnit::outportCompute(RouteInfo route, int inport,
         // any custom algorithm
         case CUSTOM_: outport =
             outportComputeCustom(route, inport, inport_dirn); break;
+        case WEST_FIRST_: outport =
+            outportComputeWestFirst(route, inport, inport_dirn); break;
+        case ODD_EVEN_: outport =
+            outportComputeOddEven(route, inport, inport_dirn); break;
+        case ESCAPE_VC_: outport =
+            outportComputeEscapeVC(route, inport, invc, inport_dirn); break;
         default: outport =
             lookupRoutingTable(route.vnet, route.net_dest); break;
     }
@@ -240,3 +276,212 @@ RoutingUnit::outportComputeCustom(RouteInfo route,
     assert(0);
     return -1;
 }
+
+void
+RoutingUnit::getCoords(int router, int &x, int &y)
+{
+    int num_cols = m_router->get_net_ptr()->getNumCols();
+    assert(num_cols > 0);
+
+    x = router % num_cols;
+    y = router / num_cols;
+}
+
+int
+RoutingUnit::minimalDirections(const RouteInfo &route, PortDirection *dirns)
+{
+    int my_x, my_y, dest_x, dest_y;
+    getCoords(m_router->get_id(), my_x, my_y);
+    getCoords(route.dest_router, dest_x, dest_y);
+
+    int num_dirns = 0;
+    if (dest_x != my_x)
+        dirns[num_dirns++] = (dest_x > my_x) ? "East" : "West";
+    if (dest_y != my_y)
+        dirns[num_dirns++] = (dest_y > my_y) ? "North" : "South";
+
+    // already checked that in outportCompute() function
+    assert(num_dirns > 0);
+    return num_dirns;
+}
+
+// Congestion-aware selection: among the admissible outports, pick the
+// one with the most free buffer slots for this vnet at the downstream
+// router, as tracked by the credits in OutVcState.
+// Ordered vnets always take the first candidate, so that all packets
+// between a pair of nodes follow the same path.
+int
+RoutingUnit::selectOutport(const PortDirection *dirns, int num_dirns,
+                           int vnet)
+{
+    int outport = m_outports_dirn2idx[dirns[0]];
+    if (num_dirns == 1 || m_router->get_net_ptr()->isVNetOrdered(vnet))
+        return outport;
+
+    m_adaptive_routes++;
+
+    std::vector<OutputUnit *> &output_units = m_router->get_outputUnit_ref();
+    int max_free = output_units[outport]->get_free_credits(vnet);
+    for (int i = 1; i < num_dirns; i++) {
+        int candidate = m_outports_dirn2idx[dirns[i]];
+        int free_credits = output_units[candidate]->get_free_credits(vnet);
+        if (free_credits > max_free) {
+            outport = candidate;
+            max_free = free_credits;
+        }
+    }
+
+    return outport;
+}
+
+// West-first turn model: packets headed west go west first,
+// all others may adaptively take any productive direction.
+int
+RoutingUnit::outportComputeWestFirst(RouteInfo route,
+                                     int inport,
+                                     PortDirection inport_dirn)
+{
+    PortDirection dirns[2];
+    int num_dirns = minimalDirections(route, dirns);
+
+    if (dirns[0] == "West") {
+        assert(inport_dirn == "Local" || inport_dirn == "East");
+        num_dirns = 1;
+    }
+
+    return selectOutport(dirns, num_dirns, route.vnet);
+}
+
+// Odd-even turn model (Chiu, IEEE TPDS 2000): east-north and east-south
+// turns are forbidden in even columns, north-west and south-west turns
+// in odd columns.
+int
+RoutingUnit::outportComputeOddEven(RouteInfo route,
+                                   int inport,
+                                   PortDirection inport_dirn)
+{
+    int my_x, my_y, dest_x, dest_y, src_x, src_y;
+    getCoords(m_router->get_id(), my_x, my_y);
+    getCoords(route.dest_router, dest_x, dest_y);
+    getCoords(route.src_router, src_x, src_y);
+
+    int x_offset = dest_x - my_x;
+    int y_offset = dest_y - my_y;
+    PortDirection y_dirn = (y_offset > 0) ? "North" : "South";
+
+    PortDirection dirns[2];
+    int num_dirns = 0;
+
+    if (x_offset == 0) {
+        assert(y_offset != 0);
+        dirns[num_dirns++] = y_dirn;
+    } else if (x_offset > 0) {
+        if (y_offset == 0) {
+            dirns[num_dirns++] = "East";
+        } else {
+            if (my_x % 2 == 1 || my_x == src_x)
+                dirns[num_dirns++] = y_dirn;
+            // do not arrive in an even destination column heading east,
+            // as turning north or south there is not allowed
+            if (dest_x % 2 == 1 || x_offset != 1)
+                dirns[num_dirns++] = "East";
+        }
+    } else {
+        dirns[num_dirns++] = "West";
+        if (y_offset != 0 && my_x % 2 == 0)
+            dirns[num_dirns++] = y_dirn;
+    }
+
+    assert(num_dirns > 0);
+    return selectOutport(dirns, num_dirns, route.vnet);
+}
+
+/*
+ * Escape VC routing (Duato's protocol).
+ * The first VC of every vnet forms an escape network that is routed XY
+ * and is therefore deadlock-free. Packets on the other VCs may take any
+ * productive direction. A head flit that finds no free VC at its
+ * adaptive outport is moved to the XY outport by the SwitchAllocator
+ * (see escapeOutport()), where it may also use the escape VC.
+ * Once on the escape network, a packet stays there until it is ejected.
+ */
+
+bool
+RoutingUnit::isEscapeVC(int vc)
+{
+    return (vc % m_router->get_vc_per_vnet()) == 0;
+}
+
+// Newly injected packets are routed adaptively whatever VC the
+// NetworkInterface picked.
+bool
+RoutingUnit::onEscapeNetwork(int inport, int invc)
+{
+    return isEscapeVC(invc) && m_inports_idx2dirn[inport] != "Local";
+}
+
+PortDirection
+RoutingUnit::xyDirection(const RouteInfo &route)
+{
+    PortDirection dirns[2];
+    minimalDirections(route, dirns);
+    return dirns[0];
+}
+
+int
+RoutingUnit::outportComputeEscapeVC(RouteInfo route,
+                                    int inport,
+                                    int invc,
+                                    PortDirection inport_dirn)
+{
+    if (onEscapeNetwork(inport, invc) ||
+        m_router->get_net_ptr()->isVNetOrdered(route.vnet)) {
+        return m_outports_dirn2idx[xyDirection(route)];
+    }
+
+    PortDirection dirns[2];
+    int num_dirns = minimalDirections(route, dirns);
+    return selectOutport(dirns, num_dirns, route.vnet);
+}
+
+void
+RoutingUnit::outvcRange(const RouteInfo &route, int inport, int invc,
+                        int outport, int &first_vc, int &last_vc)
+{
+    int vc_per_vnet = m_router->get_vc_per_vnet();
+    int vnet = invc / vc_per_vnet;
+    first_vc = vnet * vc_per_vnet;
+    last_vc = first_vc + vc_per_vnet - 1;
+
+    if (m_router->get_net_ptr()->getRoutingAlgorithm() != ESCAPE_VC_ ||
+        route.dest_router == m_router->get_id() ||
+        m_router->get_net_ptr()->isVNetOrdered(vnet)) {
+        return;
+    }
+
+    if (onEscapeNetwork(inport, invc)) {
+        last_vc = first_vc;
+    } else if (outport != m_outports_dirn2idx[xyDirection(route)]) {
+        // only a hop along the XY route may enter the escape VC
+        first_vc++;
+    }
+}
+
+int
+RoutingUnit::escapeOutport(const RouteInfo &route, int inport, int invc,
+                           int outport)
+{
+    if (m_router->get_net_ptr()->getRoutingAlgorithm() != ESCAPE_VC_ ||
+        route.dest_router == m_router->get_id() ||
+        m_router->get_net_ptr()->isVNetOrdered(route.vnet) ||
+        onEscapeNetwork(inport, invc)) {
+        return -1;
+    }
+
+    int escape_outport = m_outports_dirn2idx[xyDirection(route)];
+    if (escape_outport == outport)
+        return -1;
+
+    m_escape_routes++;
+    return escape_outport;
+}
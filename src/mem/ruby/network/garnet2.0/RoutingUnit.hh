@@ -34,6 +34,7 @@
 #ifndef __MEM_RUBY_NETWORK_GARNET_ROUTING_UNIT_HH__
 #define __MEM_RUBY_NETWORK_GARNET_ROUTING_UNIT_HH__
 
+#include "base/random.hh"
 #include "mem/ruby/common/Consumer.hh"
 #include "mem/ruby/common/NetDest.hh"
 #include "mem/ruby/network/garnet2.0/CommonTypes.hh"
@@ -49,6 +50,7 @@ class RoutingUnit
     RoutingUnit(Router *router);
     int outportCompute(RouteInfo route,
                       int inport,
+                      int invc,
                       PortDirection inport_dirn);
 
     // Topology-agnostic Routing Table based routing (default)
@@ -56,7 +58,7 @@ class RoutingUnit
     void addWeight(int link_weight);
 
     // get output port from routing table
-    int  lookupRoutingTable(int vnet, NetDest net_dest);
+    int  lookupRoutingTable(int vnet, const NetDest &net_dest);
 
     // Topology-specific direction based routing
     void addInDirection(PortDirection inport_dirn, int inport);
@@ -72,18 +74,75 @@ class RoutingUnit
                              int inport,
                              PortDirection inport_dirn);
 
+    // Turn-model adaptive routing for Mesh
+    int outportComputeWestFirst(RouteInfo route,
+                                int inport,
+                                PortDirection inport_dirn);
+    int outportComputeOddEven(RouteInfo route,
+                              int inport,
+                              PortDirection inport_dirn);
+
+    // Fully adaptive minimal routing for Mesh, kept deadlock-free by
+    // an escape VC per vnet that only follows XY routes
+    int outportComputeEscapeVC(RouteInfo route,
+                               int inport,
+                               int invc,
+                               PortDirection inport_dirn);
+
+    // Output VCs [first_vc, last_vc] a head flit at (inport, invc) may be
+    // allocated at outport
+    void outvcRange(const RouteInfo &route, int inport, int invc,
+                    int outport, int &first_vc, int &last_vc);
+
+    // XY outport on the escape network for an adaptively routed head
+    // flit that found no free VC at outport, or -1 if it cannot move
+    int escapeOutport(const RouteInfo &route, int inport, int invc,
+                      int outport);
+
+    // Activity counters, collated into the router stats
+    double get_adaptive_routes() { return m_adaptive_routes; }
+    double get_escape_routes() { return m_escape_routes; }
+    double get_congestion();
+    void resetStats();
+
   private:
+    // Mesh coordinates of a router
+    void getCoords(int router, int &x, int &y);
+
+    // Productive directions towards the destination, X first
+    int minimalDirections(const RouteInfo &route, PortDirection *dirns);
+
+    // Escape VC routing: the first VC of every vnet
+    bool isEscapeVC(int vc);
+    bool onEscapeNetwork(int inport, int invc);
+    PortDirection xyDirection(const RouteInfo &route);
+
+    // Pick the least congested of the admissible outports
+    int selectOutport(const PortDirection *dirns, int num_dirns, int vnet);
+
     Router *m_router;
 
     // Routing Table
     std::vector<NetDest> m_routing_table;
     std::vector<int> m_weight_table;
+    // Breaks ties between table entries. Each router draws from its own
+    // generator, so that routes do not depend on the order routers on
+    // different event queues happen to run in.
+    Random m_rng;
 
     // Inport and Outport direction to idx maps
     std::map<PortDirection, int> m_inports_dirn2idx;
     std::map<int, PortDirection> m_inports_idx2dirn;
     std::map<int, PortDirection> m_outports_idx2dirn;
     std::map<PortDirection, int> m_outports_dirn2idx;
+
+    // Route computations with more than one admissible outport, head
+    // flits moved to the escape network, and the sum of the fractions of
+    // downstream buffers occupied sampled at every route computation
+    double m_adaptive_routes;
+    double m_escape_routes;
+    double m_congestion_sum;
+    double m_congestion_samples;
 };
 
 #endif // __MEM_RUBY_NETWORK_GARNET_ROUTING_UNIT_HH__
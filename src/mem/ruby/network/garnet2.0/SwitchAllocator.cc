@@ -48,6 +48,7 @@ SwitchAllocator::SwitchAllocator(Router *router)
 
     m_input_arbiter_activity = 0;
     m_output_arbiter_activity = 0;
+    m_num_rounds = 0;
 }
 
 void
@@ -55,11 +56,15 @@ SwitchAllocator::init()
 {
     m_input_unit = m_router->get_inputUnit_ref();
     m_output_unit = m_router->get_outputUnit_ref();
+    m_escape_vc_routing =
+        (m_router->get_net_ptr()->getRoutingAlgorithm() == ESCAPE_VC_);
 
     m_num_inports = m_router->get_num_inports();
     m_num_outports = m_router->get_num_outports();
     m_round_robin_inport.resize(m_num_outports);
     m_round_robin_invc.resize(m_num_inports);
+    m_invc_rr_update.resize(m_num_inports, 0);
+    m_inport_rr_update.resize(m_num_outports, 0);
     m_port_requests.resize(m_num_outports);
     m_vc_winners.resize(m_num_outports);
 
@@ -91,6 +96,8 @@ SwitchAllocator::init()
 void
 SwitchAllocator::wakeup()
 {
+    m_num_rounds++;
+
     arbitrate_inports(); // First stage of allocation
     arbitrate_outports(); // Second stage of allocation
 
@@ -113,15 +120,12 @@ SwitchAllocator::arbitrate_inports()
 {
     // Select a VC from each input in a round robin manner
     // Independent arbiter at each input port
-    for (int inport = 0; inport < m_num_inports; inport++) {
-        int invc = m_round_robin_invc[inport];
-
-        // Select next round robin vc candidate within valid vnet
-        int next_round_robin_invc = invc;
-        next_round_robin_invc++;
-        if (next_round_robin_invc >= m_num_vcs)
-            next_round_robin_invc = 0;
-        m_round_robin_invc[inport] = next_round_robin_invc;
+    // Only inports with buffered flits can place a request
+    const PortSet &active_inports = m_router->get_active_inports();
+    for (int inport = active_inports.first(); inport >= 0;
+         inport = active_inports.next(inport + 1)) {
+        int invc = next_round_robin(m_round_robin_invc[inport],
+                                    m_invc_rr_update[inport], m_num_vcs);
 
         for (int invc_iter = 0; invc_iter < m_num_vcs; invc_iter++) {
 
@@ -138,10 +142,26 @@ SwitchAllocator::arbitrate_inports()
                 bool make_request =
                     send_allowed(inport, invc, outport, outvc);
 
+                if (!make_request && outvc == -1 && m_escape_vc_routing) {
+                    // No free VC at the adaptive outport of this head
+                    // flit, fall back to the escape network
+                    int escape_outport = m_router->escape_route(
+                        m_input_unit[inport]->peekTopFlit(invc)->get_route(),
+                        inport, invc, outport);
+                    if (escape_outport != -1) {
+                        m_input_unit[inport]->grant_outport(invc,
+                                                            escape_outport);
+                        outport = escape_outport;
+                        make_request =
+                            send_allowed(inport, invc, outport, outvc);
+                    }
+                }
+
                 if (make_request) {
                     m_input_arbiter_activity++;
                     m_port_requests[outport][inport] = true;
                     m_vc_winners[outport][inport]= invc;
+                    m_requested_outports.set(outport);
                     break; // got one vc winner for this port
                 }
             }
@@ -173,12 +193,11 @@ SwitchAllocator::arbitrate_outports()
     // Now there are a set of input vc requests for output vcs.
     // Again do round robin arbitration on these requests
     // Independent arbiter at each output port
-    for (int outport = 0; outport < m_num_outports; outport++) {
-        int inport = m_round_robin_inport[outport];
-        m_round_robin_inport[outport]++;
-
-        if (m_round_robin_inport[outport] >= m_num_inports)
-            m_round_robin_inport[outport] = 0;
+    for (int outport = m_requested_outports.first(); outport >= 0;
+         outport = m_requested_outports.next(outport + 1)) {
+        int inport = next_round_robin(m_round_robin_inport[outport],
+                                      m_inport_rr_update[outport],
+                                      m_num_inports);
 
         for (int inport_iter = 0; inport_iter < m_num_inports;
                  inport_iter++) {
@@ -296,7 +315,19 @@ SwitchAllocator::send_allowed(int inport, int invc, int outport, int outvc)
         // needs outvc
         // this is only true for HEAD and HEAD_TAIL flits.
 
-        if (m_output_unit[outport]->has_free_vc(vnet)) {
+        bool has_free_vc;
+        if (m_escape_vc_routing) {
+            int first_vc, last_vc;
+            m_router->outvc_range(
+                m_input_unit[inport]->peekTopFlit(invc)->get_route(),
+                inport, invc, outport, first_vc, last_vc);
+            has_free_vc =
+                m_output_unit[outport]->has_free_vc(first_vc, last_vc);
+        } else {
+            has_free_vc = m_output_unit[outport]->has_free_vc(vnet);
+        }
+
+        if (has_free_vc) {
 
             has_outvc = true;
 
@@ -342,7 +373,16 @@ int
 SwitchAllocator::vc_allocate(int outport, int inport, int invc)
 {
     // Select a free VC from the output port
-    int outvc = m_output_unit[outport]->select_free_vc(get_vnet(invc));
+    int outvc;
+    if (m_escape_vc_routing) {
+        int first_vc, last_vc;
+        m_router->outvc_range(
+            m_input_unit[inport]->peekTopFlit(invc)->get_route(),
+            inport, invc, outport, first_vc, last_vc);
+        outvc = m_output_unit[outport]->select_free_vc(first_vc, last_vc);
+    } else {
+        outvc = m_output_unit[outport]->select_free_vc(get_vnet(invc));
+    }
 
     // has to get a valid VC since it checked before performing SA
     assert(outvc != -1);
@@ -357,7 +397,9 @@ SwitchAllocator::check_for_wakeup()
 {
     Cycles nextCycle = m_router->curCycle() + Cycles(1);
 
-    for (int i = 0; i < m_num_inports; i++) {
+    const PortSet &active_inports = m_router->get_active_inports();
+    for (int i = active_inports.first(); i >= 0;
+         i = active_inports.next(i + 1)) {
         for (int j = 0; j < m_num_vcs; j++) {
             if (m_input_unit[i]->need_stage(j, SA_, nextCycle)) {
                 m_router->schedule_wakeup(Cycles(1));
@@ -381,9 +423,24 @@ SwitchAllocator::get_vnet(int invc)
 void
 SwitchAllocator::clear_request_vector()
 {
-    for (int i = 0; i < m_num_outports; i++) {
+    for (int i = m_requested_outports.first(); i >= 0;
+         i = m_requested_outports.next(i + 1)) {
         for (int j = 0; j < m_num_inports; j++) {
             m_port_requests[i][j] = false;
         }
+        m_requested_outports.clear(i);
     }
 }
+
+// Returns the current round robin candidate and advances the pointer.
+// A pointer moves by one every allocation round whether or not its port
+// is visited, so first catch up on the rounds since its last update.
+int
+SwitchAllocator::next_round_robin(int &pointer, uint64_t &last_update,
+                                  int size)
+{
+    int current = (pointer + (m_num_rounds - 1 - last_update) % size) % size;
+    pointer = (current + 1) % size;
+    last_update = m_num_rounds;
+    return current;
+}
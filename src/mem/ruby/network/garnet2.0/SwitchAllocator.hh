@@ -58,6 +58,7 @@ class SwitchAllocator : public Consumer
     void arbitrate_outports();
     bool send_allowed(int inport, int invc, int outport, int outvc);
     int vc_allocate(int outport, int inport, int invc);
+    int next_round_robin(int &pointer, uint64_t &last_update, int size);
 
     inline double
     get_input_arbiter_activity()
@@ -73,12 +74,22 @@ class SwitchAllocator : public Consumer
   private:
     int m_num_inports, m_num_outports;
     int m_num_vcs, m_vc_per_vnet;
+    // Escape VC routing restricts which output VCs a head flit may take
+    bool m_escape_vc_routing;
 
     double m_input_arbiter_activity, m_output_arbiter_activity;
 
     Router *m_router;
+    // Number of allocation rounds so far. The round robin pointers move
+    // every round, but are only brought up to date when their port is
+    // visited (see next_round_robin()).
+    uint64_t m_num_rounds;
     std::vector<int> m_round_robin_invc;
+    std::vector<uint64_t> m_invc_rr_update;
     std::vector<int> m_round_robin_inport;
+    std::vector<uint64_t> m_inport_rr_update;
+    // Outports that received a request in SA-I this round
+    PortSet m_requested_outports;
     std::vector<std::vector<bool>> m_port_requests;
     std::vector<std::vector<int>> m_vc_winners; // a list for each outport
     std::vector<InputUnit *> m_input_unit;
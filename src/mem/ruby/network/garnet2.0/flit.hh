@@ -40,6 +40,7 @@
 #include "base/types.hh"
 #include "mem/ruby/network/garnet2.0/CommonTypes.hh"
 #include "mem/ruby/slicc_interface/Message.hh"
+#include "mem/ruby/slicc_interface/MessagePool.hh"
 
 class flit
 {
@@ -47,6 +48,16 @@ class flit
     flit() {}
     flit(int id, int vc, int vnet, RouteInfo route, int size,
          MsgPtr msg_ptr, Cycles curTime);
+    // Credits are deleted through flit pointers, and have to go back
+    // to their own pool
+    virtual ~flit() {}
+
+    // Flits are created and destroyed at every hop; recycle their
+    // storage instead of going to the heap each time
+    static void *operator new(size_t size)
+    { return MessagePool<flit>::allocate(size); }
+    static void operator delete(void *p, size_t size)
+    { MessagePool<flit>::release(p, size); }
 
     int get_outport() {return m_outport; }
     int get_size() { return m_size; }
@@ -56,7 +67,7 @@ class flit
     Cycles get_time() { return m_time; }
     int get_vnet() { return m_vnet; }
     int get_vc() { return m_vc; }
-    RouteInfo get_route() { return m_route; }
+    const RouteInfo& get_route() { return m_route; }
     MsgPtr& get_msg_ptr() { return m_msg_ptr; }
     flit_type get_type() { return m_type; }
     std::pair<flit_stage, Cycles> get_stage() { return m_stage; }
@@ -95,6 +95,23 @@ PerfectSwitch::addOutPort(const vector<MessageBuffer*>& out,
     // Add to routing table
     m_out.push_back(out);
     m_routing_table.push_back(routing_table_entry);
+
+    // Update the destination to link lookup. Links are added in their
+    // static search order, so the new one only gets the destinations
+    // that no earlier link reaches.
+    NetDest first_reached = routing_table_entry;
+    first_reached.removeNetDest(m_reached);
+    m_reached.addNetDest(routing_table_entry);
+
+    for (int node = first_reached.firstElement(); node >= 0;
+         node = first_reached.nextElement(node)) {
+        if (node >= m_dest_link.size()) {
+            m_dest_link.resize(node + 1, -1);
+        }
+        m_dest_link[node] = l.m_link;
+    }
+    m_link_dests.push_back(first_reached);
+    m_link_used.push_back(false);
 }
 
 PerfectSwitch::~PerfectSwitch()
@@ -102,7 +119,7 @@ PerfectSwitch::~PerfectSwitch()
 }
 
 void
-PerfectSwitch::operateVnet(int vnet)
+PerfectSwitch::operateVnet(int vnet, Tick current_time)
 {
     // This is for round-robin scheduling
     int incoming = m_round_robin_start;
@@ -130,23 +147,125 @@ PerfectSwitch::operateVnet(int vnet)
                 continue;
             }
 
-            operateMessageBuffer(buffer, incoming, vnet);
+            operateMessageBuffer(buffer, incoming, vnet, current_time);
+
+            // Stop once every message of this vnet has been forwarded
+            if (m_pending_message_count[vnet] == 0) {
+                break;
+            }
+        }
+    }
+}
+
+void
+PerfectSwitch::routeAdaptive(const NetDest& dsts, int vnet,
+                             Tick current_time)
+{
+    NetDest msg_dsts = dsts;
+
+    // Find how clogged each link is
+    for (int out = 0; out < m_out.size(); out++) {
+        int out_queue_length = 0;
+        for (int v = 0; v < m_virtual_networks; v++) {
+            out_queue_length += m_out[out][v]->getSize(current_time);
+        }
+        int value =
+            (out_queue_length << 8) |
+            random_mt.random(0, 0xff);
+        m_link_order[out].m_link = out;
+        m_link_order[out].m_value = value;
+    }
+
+    // Look at the most empty link first
+    sort(m_link_order.begin(), m_link_order.end());
+
+    for (int i = 0; i < m_routing_table.size(); i++) {
+        // pick the next link to look at
+        int link = m_link_order[i].m_link;
+        const NetDest &dst = m_routing_table[link];
+        DPRINTF(RubyNetwork, "dst: %s\n", dst);
+
+        if (!msg_dsts.intersectionIsNotEmpty(dst))
+            continue;
+
+        // Remember what link we're using
+        m_output_links.push_back(link);
+
+        // Need to remember which destinations need this message in
+        // another vector.  This Set is the intersection of the
+        // routing_table entry and the current destination set.  The
+        // intersection must not be empty, since we are inside "if"
+        m_output_link_destinations.push_back(msg_dsts.AND(dst));
+
+        // Next, we update the msg_destination not to include
+        // those nodes that were already handled by this link
+        msg_dsts.removeNetDest(dst);
+    }
+
+    assert(msg_dsts.count() == 0);
+}
+
+void
+PerfectSwitch::routeStatic(const NetDest& msg_dsts)
+{
+    // Unfortunately, the token-protocol sends some
+    // zero-destination messages, these are simply dropped
+    int node = msg_dsts.firstElement();
+    if (node < 0) {
+        return;
+    }
+
+    // Unicast: the destination set does not change
+    if (msg_dsts.nextElement(node) < 0) {
+        assert(node < m_dest_link.size() && m_dest_link[node] >= 0);
+        m_output_links.push_back(m_dest_link[node]);
+        return;
+    }
+
+    int num_links = 0;
+    for (; node >= 0; node = msg_dsts.nextElement(node)) {
+        assert(node < m_dest_link.size() && m_dest_link[node] >= 0);
+        int link = m_dest_link[node];
+        if (!m_link_used[link]) {
+            m_link_used[link] = true;
+            num_links++;
         }
     }
+
+    // Keep the links in their search order, as the message copies are
+    // enqueued in that order
+    for (int link = 0; num_links > 0; link++) {
+        if (!m_link_used[link]) {
+            continue;
+        }
+        m_link_used[link] = false;
+        num_links--;
+
+        m_output_links.push_back(link);
+        m_output_link_destinations.push_back(msg_dsts.AND(m_link_dests[link]));
+    }
+
+    if (m_output_links.size() == 1) {
+        m_output_link_destinations.clear();
+    }
 }
 
 void
 PerfectSwitch::operateMessageBuffer(MessageBuffer *buffer, int incoming,
-                                    int vnet)
+                                    int vnet, Tick current_time)
 {
     MsgPtr msg_ptr;
     Message *net_msg_ptr = NULL;
 
-    // temporary vectors to store the routing results
-    vector<LinkID> output_links;
-    vector<NetDest> output_link_destinations;
-    Tick current_time = m_switch->clockEdge();
+    assert(m_link_order.size() == m_routing_table.size());
+    assert(m_link_order.size() == m_out.size());
+
+    // Only unordered vnets are routed adaptively, all others search the
+    // links in their static order and can use the lookup table
+    bool adaptive = m_network_ptr->getAdaptiveRouting() &&
+        !m_network_ptr->isVNetOrdered(vnet);
 
+    // Forward every ready message of this buffer in one pass
     while (buffer->isReady(current_time)) {
         DPRINTF(RubyNetwork, "incoming: %d\n", incoming);
 
@@ -155,72 +274,19 @@ PerfectSwitch::operateMessageBuffer(MessageBuffer *buffer, int incoming,
         net_msg_ptr = msg_ptr.get();
         DPRINTF(RubyNetwork, "Message: %s\n", (*net_msg_ptr));
 
-        output_links.clear();
-        output_link_destinations.clear();
-        NetDest msg_dsts = net_msg_ptr->getDestination();
-
-        // Unfortunately, the token-protocol sends some
-        // zero-destination messages, so this assert isn't valid
-        // assert(msg_dsts.count() > 0);
-
-        assert(m_link_order.size() == m_routing_table.size());
-        assert(m_link_order.size() == m_out.size());
-
-        if (m_network_ptr->getAdaptiveRouting()) {
-            if (m_network_ptr->isVNetOrdered(vnet)) {
-                // Don't adaptively route
-                for (int out = 0; out < m_out.size(); out++) {
-                    m_link_order[out].m_link = out;
-                    m_link_order[out].m_value = 0;
-                }
-            } else {
-                // Find how clogged each link is
-                for (int out = 0; out < m_out.size(); out++) {
-                    int out_queue_length = 0;
-                    for (int v = 0; v < m_virtual_networks; v++) {
-                        out_queue_length += m_out[out][v]->getSize(current_time);
-                    }
-                    int value =
-                        (out_queue_length << 8) |
-                        random_mt.random(0, 0xff);
-                    m_link_order[out].m_link = out;
-                    m_link_order[out].m_value = value;
-                }
-
-                // Look at the most empty link first
-                sort(m_link_order.begin(), m_link_order.end());
-            }
-        }
-
-        for (int i = 0; i < m_routing_table.size(); i++) {
-            // pick the next link to look at
-            int link = m_link_order[i].m_link;
-            NetDest dst = m_routing_table[link];
-            DPRINTF(RubyNetwork, "dst: %s\n", dst);
-
-            if (!msg_dsts.intersectionIsNotEmpty(dst))
-                continue;
-
-            // Remember what link we're using
-            output_links.push_back(link);
-
-            // Need to remember which destinations need this message in
-            // another vector.  This Set is the intersection of the
-            // routing_table entry and the current destination set.  The
-            // intersection must not be empty, since we are inside "if"
-            output_link_destinations.push_back(msg_dsts.AND(dst));
+        m_output_links.clear();
+        m_output_link_destinations.clear();
 
-            // Next, we update the msg_destination not to include
-            // those nodes that were already handled by this link
-            msg_dsts.removeNetDest(dst);
+        if (adaptive) {
+            routeAdaptive(net_msg_ptr->getDestination(), vnet, current_time);
+        } else {
+            routeStatic(net_msg_ptr->getDestination());
         }
 
-        assert(msg_dsts.count() == 0);
-
         // Check for resources - for all outgoing queues
         bool enough = true;
-        for (int i = 0; i < output_links.size(); i++) {
-            int outgoing = output_links[i];
+        for (int i = 0; i < m_output_links.size(); i++) {
+            int outgoing = m_output_links[i];
 
             if (!m_out[outgoing][vnet]->areNSlotsAvailable(1, current_time))
                 enough = false;
@@ -241,7 +307,7 @@ PerfectSwitch::operateMessageBuffer(MessageBuffer *buffer, int incoming,
 
         MsgPtr unmodified_msg_ptr;
 
-        if (output_links.size() > 1) {
+        if (m_output_links.size() > 1) {
             // If we are sending this message down more than one link
             // (size>1), we need to make a copy of the message so each
             // branch can have a different internal destination we need
@@ -257,8 +323,8 @@ PerfectSwitch::operateMessageBuffer(MessageBuffer *buffer, int incoming,
         m_pending_message_count[vnet]--;
 
         // Enqueue it - for all outgoing queues
-        for (int i=0; i<output_links.size(); i++) {
-            int outgoing = output_links[i];
+        for (int i=0; i<m_output_links.size(); i++) {
+            int outgoing = m_output_links[i];
 
             if (i > 0) {
                 // create a private copy of the unmodified message
@@ -268,7 +334,9 @@ PerfectSwitch::operateMessageBuffer(MessageBuffer *buffer, int incoming,
             // Change the internal destination set of the message so it
             // knows which destinations this link is responsible for.
             net_msg_ptr = msg_ptr.get();
-            net_msg_ptr->getDestination() = output_link_destinations[i];
+            if (!m_output_link_destinations.empty()) {
+                net_msg_ptr->getDestination() = m_output_link_destinations[i];
+            }
 
             // Enqeue msg
             DPRINTF(RubyNetwork, "Enqueuing net msg from "
@@ -299,10 +367,11 @@ PerfectSwitch::wakeup()
     }
 
     // For all components incoming queues
+    Tick current_time = m_switch->clockEdge();
     for (int vnet = highest_prio_vnet;
          (vnet * decrementer) >= (decrementer * lowest_prio_vnet);
          vnet -= decrementer) {
-        operateVnet(vnet);
+        operateVnet(vnet, current_time);
     }
 }
 
@@ -41,10 +41,10 @@
 #include <vector>
 
 #include "mem/ruby/common/Consumer.hh"
+#include "mem/ruby/common/NetDest.hh"
 #include "mem/ruby/common/TypeDefines.hh"
 
 class MessageBuffer;
-class NetDest;
 class SimpleNetwork;
 class Switch;
 
@@ -85,8 +85,13 @@ class PerfectSwitch : public Consumer
     PerfectSwitch(const PerfectSwitch& obj);
     PerfectSwitch& operator=(const PerfectSwitch& obj);
 
-    void operateVnet(int vnet);
-    void operateMessageBuffer(MessageBuffer *b, int incoming, int vnet);
+    void operateVnet(int vnet, Tick current_time);
+    void operateMessageBuffer(MessageBuffer *b, int incoming, int vnet,
+                              Tick current_time);
+
+    // Fill m_output_links (and m_output_link_destinations) for a message
+    void routeAdaptive(const NetDest& msg_dsts, int vnet, Tick current_time);
+    void routeStatic(const NetDest& msg_dsts);
 
     const SwitchID m_switch_id;
     Switch * const m_switch;
@@ -98,6 +103,22 @@ class PerfectSwitch : public Consumer
     std::vector<NetDest> m_routing_table;
     std::vector<LinkOrder> m_link_order;
 
+    // When the links are searched in their static order, every
+    // destination goes to the first link whose routing table entry
+    // reaches it. m_dest_link holds that link for every destination
+    // node (-1 if none), m_link_dests the destinations each link is the
+    // first to reach, and m_reached the union of all entries.
+    std::vector<int> m_dest_link;
+    std::vector<NetDest> m_link_dests;
+    NetDest m_reached;
+
+    // Routing results of the message being forwarded, kept across
+    // messages to avoid reallocating them. An empty destination vector
+    // means the message goes out on a single link unmodified.
+    std::vector<LinkID> m_output_links;
+    std::vector<NetDest> m_output_link_destinations;
+    std::vector<bool> m_link_used;
+
     uint32_t m_virtual_networks;
     int m_round_robin_start;
     int m_wakeups_wo_switch;
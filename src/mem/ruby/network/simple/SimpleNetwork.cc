@@ -69,6 +69,14 @@ SimpleNetwork::init()
     // the parent class network constructor.
     assert(m_topology_ptr != NULL);
     m_topology_ptr->createLinks(this);
+
+    // Switches may run on different event queues, the throttles feeding
+    // the link buffers being the boundary between them. Adaptive routing
+    // breaks ties with the shared random number generator, which needs
+    // all of them on a single queue.
+    fatal_if(m_adaptive_routing && numMainEventQueues > 1,
+             "%s: adaptive routing is not supported with %d event queues\n",
+             name(), numMainEventQueues);
 }
 
 SimpleNetwork::~SimpleNetwork()
@@ -46,8 +46,6 @@ const int MESSAGE_SIZE_MULTIPLIER = 1000;
 const int BROADCAST_SCALING = 1;
 const int PRIORITY_SWITCH_LIMIT = 128;
 
-static int network_message_to_size(Message* net_msg_ptr);
-
 Throttle::Throttle(int sID, RubySystem *rs, NodeID node, Cycles link_latency,
                    int link_bandwidth_multiplier, int endpoint_bandwidth,
                    Switch *em)
@@ -72,6 +70,13 @@ Throttle::addLinks(const vector<MessageBuffer*>& in_vec,
 {
     assert(in_vec.size() == out_vec.size());
 
+    // The message sizes are only known once the network is constructed
+    for (MessageSizeType type = MessageSizeType_FIRST;
+         type < MessageSizeType_NUM; ++type) {
+        m_msg_units[type] =
+            Network::MessageSizeType_to_int(type) * MESSAGE_SIZE_MULTIPLIER;
+    }
+
     for (int vnet = 0; vnet < in_vec.size(); ++vnet) {
         MessageBuffer *in_ptr = in_vec[vnet];
         MessageBuffer *out_ptr = out_vec[vnet];
@@ -89,32 +94,45 @@ Throttle::addLinks(const vector<MessageBuffer*>& in_vec,
 }
 
 void
-Throttle::operateVnet(int vnet, int &bw_remaining, bool &schedule_wakeup,
-                      MessageBuffer *in, MessageBuffer *out)
+Throttle::operateVnet(int vnet, Tick current_time, int &bw_remaining,
+                      bool &schedule_wakeup, MessageBuffer *in,
+                      MessageBuffer *out)
 {
     if (out == nullptr || in == nullptr) {
         return;
     }
 
     assert(m_units_remaining[vnet] >= 0);
-    Tick current_time = m_switch->clockEdge();
 
-    while (bw_remaining > 0 && (in->isReady(current_time) ||
-                                m_units_remaining[vnet] > 0) &&
-           out->areNSlotsAvailable(1, current_time)) {
+    // Move as many messages of this vnet as the bandwidth left in this
+    // cycle allows
+    while (bw_remaining > 0) {
+        // Nothing left to transfer on this virtual network
+        if (m_units_remaining[vnet] == 0 && !in->isReady(current_time)) {
+            break;
+        }
+
+        if (!out->areNSlotsAvailable(1, current_time)) {
+            DPRINTF(RubyNetwork, "vnet: %d", vnet);
+
+            // schedule me to wakeup again because I'm waiting for my
+            // output queue to become available
+            schedule_wakeup = true;
+            break;
+        }
+
         // See if we are done transferring the previous message on
         // this virtual network
-        if (m_units_remaining[vnet] == 0 && in->isReady(current_time)) {
+        if (m_units_remaining[vnet] == 0) {
             // Find the size of the message we are moving
             MsgPtr msg_ptr = in->peekMsgPtr();
             Message *net_msg_ptr = msg_ptr.get();
-            m_units_remaining[vnet] +=
-                network_message_to_size(net_msg_ptr);
+            m_units_remaining[vnet] += messageUnits(net_msg_ptr);
 
             DPRINTF(RubyNetwork, "throttle: %d my bw %d bw spent "
                     "enqueueing net msg %d time: %lld.\n",
                     m_node, getLinkBandwidth(), m_units_remaining[vnet],
-                    m_ruby_system->curCycle());
+                    m_switch->curCycle());
 
             // Move the message
             in->dequeue(current_time);
@@ -131,16 +149,6 @@ Throttle::operateVnet(int vnet, int &bw_remaining, bool &schedule_wakeup,
         m_units_remaining[vnet] = max(0, diff);
         bw_remaining = max(0, -diff);
     }
-
-    if (bw_remaining > 0 && (in->isReady(current_time) ||
-                             m_units_remaining[vnet] > 0) &&
-        !out->areNSlotsAvailable(1, current_time)) {
-        DPRINTF(RubyNetwork, "vnet: %d", vnet);
-
-        // schedule me to wakeup again because I'm waiting for my
-        // output queue to become available
-        schedule_wakeup = true;
-    }
 }
 
 void
@@ -152,6 +160,7 @@ Throttle::wakeup()
 
     m_wakeups_wo_switch++;
     bool schedule_wakeup = false;
+    Tick current_time = m_switch->clockEdge();
 
     // variable for deciding the direction in which to iterate
     bool iteration_direction = false;
@@ -165,12 +174,12 @@ Throttle::wakeup()
 
     if (iteration_direction) {
         for (int vnet = 0; vnet < m_vnets; ++vnet) {
-            operateVnet(vnet, bw_remaining, schedule_wakeup,
+            operateVnet(vnet, current_time, bw_remaining, schedule_wakeup,
                         m_in[vnet], m_out[vnet]);
         }
     } else {
         for (int vnet = m_vnets-1; vnet >= 0; --vnet) {
-            operateVnet(vnet, bw_remaining, schedule_wakeup,
+            operateVnet(vnet, current_time, bw_remaining, schedule_wakeup,
                         m_in[vnet], m_out[vnet]);
         }
     }
@@ -246,12 +255,11 @@ Throttle::print(ostream& out) const
 }
 
 int
-network_message_to_size(Message *net_msg_ptr)
+Throttle::messageUnits(Message *net_msg_ptr) const
 {
     assert(net_msg_ptr != NULL);
 
-    int size = Network::MessageSizeType_to_int(net_msg_ptr->getMessageSize());
-    size *=  MESSAGE_SIZE_MULTIPLIER;
+    int size = m_msg_units[net_msg_ptr->getMessageSize()];
 
     // Artificially increase the size of broadcast messages
     if (BROADCAST_SCALING > 1 && net_msg_ptr->getDestination().isBroadcast())
@@ -83,8 +83,10 @@ class Throttle : public Consumer
   private:
     void init(NodeID node, Cycles link_latency, int link_bandwidth_multiplier,
               int endpoint_bandwidth);
-    void operateVnet(int vnet, int &bw_remainin, bool &schedule_wakeup,
-                     MessageBuffer *in, MessageBuffer *out);
+    void operateVnet(int vnet, Tick current_time, int &bw_remaining,
+                     bool &schedule_wakeup, MessageBuffer *in,
+                     MessageBuffer *out);
+    int messageUnits(Message *net_msg_ptr) const;
 
     // Private copy constructor and assignment operator
     Throttle(const Throttle& obj);
@@ -105,6 +107,9 @@ class Throttle : public Consumer
     int m_endpoint_bandwidth;
     RubySystem *m_ruby_system;
 
+    // Bandwidth units taken by a message of each size type
+    int m_msg_units[MessageSizeType_NUM];
+
     // Statistical variables
     Stats::Scalar m_link_utilization;
     Stats::Vector m_msg_counts[MessageSizeType_NUM];
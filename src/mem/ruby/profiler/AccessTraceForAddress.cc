@@ -38,6 +38,22 @@ AccessTraceForAddress::~AccessTraceForAddress()
     }
 }
 
+void
+AccessTraceForAddress::clear()
+{
+    m_loads = 0;
+    m_stores = 0;
+    m_atomics = 0;
+    m_total = 0;
+    m_user = 0;
+    m_sharing = 0;
+    m_touched_by.clear();
+    if (m_histogram_ptr) {
+        delete m_histogram_ptr;
+        m_histogram_ptr = NULL;
+    }
+}
+
 void
 AccessTraceForAddress::print(std::ostream& out) const
 {
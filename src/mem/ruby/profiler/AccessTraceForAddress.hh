@@ -48,6 +48,7 @@ class AccessTraceForAddress
     ~AccessTraceForAddress();
 
     void setAddress(Addr addr) { m_addr = addr; }
+    void clear();
     void update(RubyRequestType type, RubyAccessMode access_mode, NodeID cpu,
                 bool sharing_miss);
     int getTotal() const;
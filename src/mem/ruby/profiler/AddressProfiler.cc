@@ -30,6 +30,7 @@
 
 #include <vector>
 
+#include "base/callback.hh"
 #include "base/stl_helpers.hh"
 #include "mem/protocol/RubyRequest.hh"
 #include "mem/ruby/profiler/Profiler.hh"
@@ -40,23 +41,14 @@ typedef AddressProfiler::AddressMap AddressMap;
 using m5::stl_helpers::operator<<;
 
 // Helper functions
-AccessTraceForAddress&
+AccessTraceForAddress*
 lookupTraceForAddress(Addr addr, AddressMap& record_map)
 {
-    // we create a static default object here that is used to insert
-    // since the insertion will create a copy of the object in the
-    // process.  Perhaps this is optimizing early, but it doesn't seem
-    // like it could hurt.
-    static const AccessTraceForAddress dflt;
-
-    pair<AddressMap::iterator, bool> r =
-        record_map.insert(make_pair(addr, dflt));
-    AddressMap::iterator i = r.first;
-    AccessTraceForAddress &access_trace = i->second;
-    if (r.second) {
-        // there was nothing there and the insert succeed, so we need
-        // to actually set the address.
-        access_trace.setAddress(addr);
+    // only the hottest addresses are traced, the record is NULL when
+    // addr is not one of them
+    AccessTraceForAddress *access_trace = record_map.sample(addr);
+    if (access_trace) {
+        access_trace->setAddress(addr);
     }
 
     return access_trace;
@@ -68,17 +60,8 @@ printSorted(ostream& out, int num_of_sequencers, const AddressMap &record_map,
 {
     const int records_printed = 100;
 
-    uint64_t misses = 0;
-    std::vector<const AccessTraceForAddress *> sorted;
-
-    AddressMap::const_iterator i = record_map.begin();
-    AddressMap::const_iterator end = record_map.end();
-    for (; i != end; ++i) {
-        const AccessTraceForAddress* record = &i->second;
-        misses += record->getTotal();
-        sorted.push_back(record);
-    }
-    sort(sorted.begin(), sorted.end(), AccessTraceForAddress::less_equal);
+    uint64_t misses = record_map.getTotal();
+    std::vector<const AddressMap::Entry *> sorted = record_map.sorted();
 
     out << "Total_entries_" << description << ": " << record_map.size()
         << endl;
@@ -87,8 +70,8 @@ printSorted(ostream& out, int num_of_sequencers, const AddressMap &record_map,
     else
         out << "Total_data_misses_" << description << ": " << misses << endl;
 
-    out << "total | load store atomic | user supervisor | sharing | touched-by"
-        << endl;
+    out << "estimate | total | load store atomic | user supervisor | "
+        << "sharing | touched-by" << endl;
 
     Histogram remaining_records(1, 100);
     Histogram all_records(1, 100);
@@ -105,27 +88,31 @@ printSorted(ostream& out, int num_of_sequencers, const AddressMap &record_map,
         m_touched_weighted_vec[j] = 0;
     }
 
+    // The counts are the sketch estimates of the whole profile, the
+    // records only cover the time an entry has been tracked
     int counter = 0;
     int max = sorted.size();
     while (counter < max && counter < records_printed) {
-        const AccessTraceForAddress* record = sorted[counter];
-        double percent = 100.0 * (record->getTotal() / double(misses));
-        out << description << " | " << percent << " % " << *record << endl;
-        all_records.add(record->getTotal());
-        all_records_log.add(record->getTotal());
+        const AddressMap::Entry* entry = sorted[counter];
+        double percent = 100.0 * (entry->count / double(misses));
+        out << description << " | " << percent << " % " << entry->count
+            << " " << entry->record << endl;
+        all_records.add(entry->count);
+        all_records_log.add(entry->count);
         counter++;
-        m_touched_vec[record->getTouchedBy()]++;
-        m_touched_weighted_vec[record->getTouchedBy()] += record->getTotal();
+        m_touched_vec[entry->record.getTouchedBy()]++;
+        m_touched_weighted_vec[entry->record.getTouchedBy()] += entry->count;
     }
 
     while (counter < max) {
-        const AccessTraceForAddress* record = sorted[counter];
-        all_records.add(record->getTotal());
-        remaining_records.add(record->getTotal());
-        all_records_log.add(record->getTotal());
-        remaining_records_log.add(record->getTotal());
-        m_touched_vec[record->getTouchedBy()]++;
-        m_touched_weighted_vec[record->getTouchedBy()] += record->getTotal();
+        const AddressMap::Entry* entry = sorted[counter];
+        all_records.add(entry->count);
+        remaining_records.add(entry->count);
+        all_records_log.add(entry->count);
+        remaining_records_log.add(entry->count);
+        counter++;
+        m_touched_vec[entry->record.getTouchedBy()]++;
+        m_touched_weighted_vec[entry->record.getTouchedBy()] += entry->count;
     }
     out << endl;
     out << "all_records_" << description << ": "
@@ -143,8 +130,51 @@ printSorted(ostream& out, int num_of_sequencers, const AddressMap &record_map,
         << endl;
 }
 
-AddressProfiler::AddressProfiler(int num_of_sequencers, Profiler *profiler)
-    : m_profiler(profiler)
+void
+AddressProfiler::HotStats::regStats(const string &name, const string &what,
+                                    int entries)
+{
+    samples
+        .name(name + ".samples")
+        .desc("Number of " + what + " samples")
+        .flags(Stats::nozero);
+
+    address
+        .init(entries)
+        .name(name + ".address")
+        .desc("The hottest " + what + "s, hottest first")
+        .precision(0)
+        .flags(Stats::nozero);
+
+    count
+        .init(entries)
+        .name(name + ".count")
+        .desc("Estimated samples of each of the hottest " + what + "s")
+        .precision(0)
+        .flags(Stats::nozero);
+}
+
+void
+AddressProfiler::HotStats::collate(const AddressMap &record_map)
+{
+    std::vector<const AddressMap::Entry *> sorted = record_map.sorted();
+
+    samples = record_map.getTotal();
+    for (int i = 0; i < record_map.getCapacity(); i++) {
+        address[i] = i < sorted.size() ? sorted[i]->key : 0;
+        count[i] = i < sorted.size() ? sorted[i]->count : 0;
+    }
+}
+
+AddressProfiler::AddressProfiler(int num_of_sequencers, Profiler *profiler,
+                                 int hot_entries, int sketch_width,
+                                 int sketch_depth)
+    : m_dataAccessTrace(hot_entries, sketch_width, sketch_depth),
+      m_macroBlockAccessTrace(hot_entries, sketch_width, sketch_depth),
+      m_programCounterAccessTrace(hot_entries, sketch_width, sketch_depth),
+      m_retryProfileMap(hot_entries, sketch_width, sketch_depth),
+      m_sharerPatternTrace(hot_entries, sketch_width, sketch_depth),
+      m_profiler(profiler)
 {
     m_num_of_sequencers = num_of_sequencers;
     clearStats();
@@ -166,6 +196,35 @@ AddressProfiler::setAllInstructions(bool all_instructions)
     m_all_instructions = all_instructions;
 }
 
+void
+AddressProfiler::regStats(const string &name)
+{
+    m_hotBlockStats.regStats(name + ".hot_blocks", "block",
+                             m_dataAccessTrace.getCapacity());
+    m_hotMacroBlockStats.regStats(name + ".hot_macroblocks", "macroblock",
+                                  m_macroBlockAccessTrace.getCapacity());
+    m_hotPCStats.regStats(name + ".hot_pcs", "PC",
+                          m_programCounterAccessTrace.getCapacity());
+    m_sharerPatternStats.regStats(name + ".sharer_patterns",
+                                  "sharer pattern",
+                                  m_sharerPatternTrace.getCapacity());
+
+    // Start a new profile whenever the stats are reset, e.g. by
+    // periodic stats dumps
+    Stats::registerResetCallback(
+        new MakeCallback<AddressProfiler, &AddressProfiler::clearStats>(
+            this));
+}
+
+void
+AddressProfiler::collateStats()
+{
+    m_hotBlockStats.collate(m_dataAccessTrace);
+    m_hotMacroBlockStats.collate(m_macroBlockAccessTrace);
+    m_hotPCStats.collate(m_programCounterAccessTrace);
+    m_sharerPatternStats.collate(m_sharerPatternTrace);
+}
+
 void
 AddressProfiler::printStats(ostream& out) const
 {
@@ -198,6 +257,12 @@ AddressProfiler::printStats(ostream& out) const
         out << endl;
         printSorted(out, m_num_of_sequencers, m_programCounterAccessTrace,
                     "pc_address", m_profiler);
+
+        out << "Hot Sharer Patterns" << endl;
+        out << "-------------------" << endl;
+        out << endl;
+        printSorted(out, m_num_of_sequencers, m_sharerPatternTrace,
+                    "sharer_pattern", m_profiler);
     }
 
     if (m_all_instructions) {
@@ -237,6 +302,7 @@ AddressProfiler::clearStats()
     m_macroBlockAccessTrace.clear();
     m_programCounterAccessTrace.clear();
     m_retryProfileMap.clear();
+    m_sharerPatternTrace.clear();
     m_retryProfileHisto.clear();
     m_retryProfileHistoRead.clear();
     m_retryProfileHistoWrite.clear();
@@ -258,6 +324,15 @@ AddressProfiler::profileGetX(Addr datablock, Addr PC,
     m_getx_sharing_histogram.add(num_indirections);
     bool indirection_miss = (num_indirections > 0);
 
+    if (m_hot_lines) {
+        AccessTraceForAddress *trace = lookupTraceForAddress(
+            sharerPatternKey(indirection_set), m_sharerPatternTrace);
+        if (trace) {
+            trace->update(RubyRequestType_ST, RubyAccessMode(0), requestor,
+                          indirection_miss);
+        }
+    }
+
     addTraceSample(datablock, PC, RubyRequestType_ST, RubyAccessMode(0),
                    requestor, indirection_miss);
 }
@@ -275,6 +350,15 @@ AddressProfiler::profileGetS(Addr datablock, Addr PC,
     m_gets_sharing_histogram.add(num_indirections);
     bool indirection_miss = (num_indirections > 0);
 
+    if (m_hot_lines) {
+        AccessTraceForAddress *trace = lookupTraceForAddress(
+            sharerPatternKey(indirection_set), m_sharerPatternTrace);
+        if (trace) {
+            trace->update(RubyRequestType_LD, RubyAccessMode(0), requestor,
+                          indirection_miss);
+        }
+    }
+
     addTraceSample(datablock, PC, RubyRequestType_LD, RubyAccessMode(0),
                    requestor, indirection_miss);
 }
@@ -285,34 +369,37 @@ AddressProfiler::addTraceSample(Addr data_addr, Addr pc_addr,
                                 RubyAccessMode access_mode, NodeID id,
                                 bool sharing_miss)
 {
-    if (m_all_instructions) {
+    if (m_hot_lines) {
         if (sharing_miss) {
             m_sharing_miss_counter++;
         }
 
         // record data address trace info
         data_addr = makeLineAddress(data_addr);
-        lookupTraceForAddress(data_addr, m_dataAccessTrace).
-            update(type, access_mode, id, sharing_miss);
+        AccessTraceForAddress *trace =
+            lookupTraceForAddress(data_addr, m_dataAccessTrace);
+        if (trace) {
+            trace->update(type, access_mode, id, sharing_miss);
+        }
 
         // record macro data address trace info
 
         // 6 for datablock, 4 to make it 16x more coarse
         Addr macro_addr = maskLowOrderBits(data_addr, 10);
-        lookupTraceForAddress(macro_addr, m_macroBlockAccessTrace).
-            update(type, access_mode, id, sharing_miss);
-
-        // record program counter address trace info
-        lookupTraceForAddress(pc_addr, m_programCounterAccessTrace).
-            update(type, access_mode, id, sharing_miss);
+        trace = lookupTraceForAddress(macro_addr, m_macroBlockAccessTrace);
+        if (trace) {
+            trace->update(type, access_mode, id, sharing_miss);
+        }
     }
 
-    if (m_all_instructions) {
-        // This code is used if the address profiler is an
-        // all-instructions profiler record program counter address
-        // trace info
-        lookupTraceForAddress(pc_addr, m_programCounterAccessTrace).
-            update(type, access_mode, id, sharing_miss);
+    if (m_hot_lines || m_all_instructions) {
+        // record program counter address trace info, this is also
+        // the profile of an all-instructions profiler
+        AccessTraceForAddress *trace =
+            lookupTraceForAddress(pc_addr, m_programCounterAccessTrace);
+        if (trace) {
+            trace->update(type, access_mode, id, sharing_miss);
+        }
     }
 }
 
@@ -326,6 +413,23 @@ AddressProfiler::profileRetry(Addr data_addr, AccessType type, int count)
         m_retryProfileHistoWrite.add(count);
     }
     if (count > 1) {
-        lookupTraceForAddress(data_addr, m_retryProfileMap).addSample(count);
+        AccessTraceForAddress *trace =
+            lookupTraceForAddress(data_addr, m_retryProfileMap);
+        if (trace) {
+            trace->addSample(count);
+        }
+    }
+}
+
+uint64_t
+AddressProfiler::sharerPatternKey(const Set& sharers)
+{
+    // a Set has at most 64 members, so its bitmask identifies it
+    uint64_t key = 0;
+    for (int i = 0; i < sharers.getSize(); i++) {
+        if (sharers.isElement(i)) {
+            key |= ULL(1) << i;
+        }
     }
+    return key;
 }
@@ -30,13 +30,15 @@
 #define __MEM_RUBY_PROFILER_ADDRESSPROFILER_HH__
 
 #include <iostream>
-#include <unordered_map>
+#include <string>
 
+#include "base/statistics.hh"
 #include "mem/protocol/AccessType.hh"
 #include "mem/protocol/RubyRequest.hh"
 #include "mem/ruby/common/Address.hh"
 #include "mem/ruby/common/Histogram.hh"
 #include "mem/ruby/profiler/AccessTraceForAddress.hh"
+#include "mem/ruby/profiler/HeavyHitters.hh"
 #include "mem/ruby/profiler/Profiler.hh"
 
 class Set;
@@ -44,10 +46,15 @@ class Set;
 class AddressProfiler
 {
   public:
-    typedef std::unordered_map<Addr, AccessTraceForAddress> AddressMap;
+    /**
+     * The hottest addresses (or PCs, or sharer patterns) and their
+     * traces, in fixed memory
+     */
+    typedef HeavyHitters<AccessTraceForAddress> AddressMap;
 
   public:
-    AddressProfiler(int num_of_sequencers, Profiler *profiler);
+    AddressProfiler(int num_of_sequencers, Profiler *profiler,
+                    int hot_entries, int sketch_width, int sketch_depth);
     ~AddressProfiler();
 
     void printStats(std::ostream& out) const;
@@ -67,10 +74,24 @@ class AddressProfiler
     //added by SS
     void setHotLines(bool hot_lines);
     void setAllInstructions(bool all_instructions);
-    void regStats(const std::string &name) {}
-    void collateStats() {}
+    void regStats(const std::string &name);
+    void collateStats();
 
   private:
+    /** Stats view of the tracked entries of one AddressMap */
+    struct HotStats
+    {
+        void regStats(const std::string &name, const std::string &what,
+                      int entries);
+        void collate(const AddressMap &record_map);
+
+        Stats::Scalar samples;
+        Stats::Vector address;
+        Stats::Vector count;
+    };
+
+    static uint64_t sharerPatternKey(const Set& sharers);
+
     // Private copy constructor and assignment operator
     AddressProfiler(const AddressProfiler& obj);
     AddressProfiler& operator=(const AddressProfiler& obj);
@@ -81,12 +102,18 @@ class AddressProfiler
     AddressMap m_macroBlockAccessTrace;
     AddressMap m_programCounterAccessTrace;
     AddressMap m_retryProfileMap;
+    AddressMap m_sharerPatternTrace;
     Histogram m_retryProfileHisto;
     Histogram m_retryProfileHistoWrite;
     Histogram m_retryProfileHistoRead;
     Histogram m_getx_sharing_histogram;
     Histogram m_gets_sharing_histogram;
 
+    HotStats m_hotBlockStats;
+    HotStats m_hotMacroBlockStats;
+    HotStats m_hotPCStats;
+    HotStats m_sharerPatternStats;
+
     Profiler *m_profiler;
 
     //added by SS
@@ -96,7 +123,7 @@ class AddressProfiler
     int m_num_of_sequencers;
 };
 
-AccessTraceForAddress& lookupTraceForAddress(Addr addr,
+AccessTraceForAddress* lookupTraceForAddress(Addr addr,
                                              AddressProfiler::AddressMap&
                                              record_map);
 
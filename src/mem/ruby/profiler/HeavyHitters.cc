@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Authors: agent
+ */
+
+#include "mem/ruby/profiler/HeavyHitters.hh"
+
+#include "base/intmath.hh"
+#include "base/misc.hh"
+
+using namespace std;
+
+CountMinSketch::CountMinSketch(int width, int depth)
+    : m_width_bits(ceilLog2(width)), m_depth(depth)
+{
+    fatal_if(width < 2 || depth < 1,
+             "A count-min sketch needs at least 2 columns and 1 row, "
+             "not %d and %d\n", width, depth);
+
+    // Odd multipliers for the multiply-shift hash of each row, taken
+    // from a fixed generator so that runs are repeatable
+    uint64_t seed = 0x9e3779b97f4a7c15ULL;
+    for (int row = 0; row < m_depth; row++) {
+        seed = mix(seed + row);
+        m_seeds.push_back(seed | 1);
+    }
+
+    m_counters.resize(m_depth << m_width_bits);
+}
+
+uint64_t
+CountMinSketch::mix(uint64_t key)
+{
+    // Finalizer of MurmurHash3, spreads line and page aligned
+    // addresses over all bits
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return key;
+}
+
+uint64_t
+CountMinSketch::add(uint64_t key, uint64_t count)
+{
+    uint64_t hash = mix(key);
+    uint64_t estimate = estimateHashed(hash) + count;
+
+    for (int row = 0; row < m_depth; row++) {
+        uint64_t &counter = m_counters[index(hash, row)];
+        counter = max(counter, estimate);
+    }
+    return estimate;
+}
+
+uint64_t
+CountMinSketch::estimate(uint64_t key) const
+{
+    return estimateHashed(mix(key));
+}
+
+uint64_t
+CountMinSketch::estimateHashed(uint64_t hash) const
+{
+    uint64_t estimate = m_counters[index(hash, 0)];
+    for (int row = 1; row < m_depth; row++) {
+        estimate = min(estimate, m_counters[index(hash, row)]);
+    }
+    return estimate;
+}
+
+void
+CountMinSketch::clear()
+{
+    fill(m_counters.begin(), m_counters.end(), 0);
+}
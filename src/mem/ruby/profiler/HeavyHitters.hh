@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Authors: agent
+ */
+
+#ifndef __MEM_RUBY_PROFILER_HEAVYHITTERS_HH__
+#define __MEM_RUBY_PROFILER_HEAVYHITTERS_HH__
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "base/misc.hh"
+
+/**
+ * Count-min sketch of 64-bit keys. Every key is counted in one of
+ * width counters in each of depth rows, and its count is estimated by
+ * the smallest of them. Estimates never fall below the true count.
+ * The width is rounded up to a power of two.
+ * Counters are updated conservatively, i.e. only raised as far as the
+ * new estimate, which keeps the over-estimate of cold keys small.
+ */
+class CountMinSketch
+{
+  public:
+    CountMinSketch(int width, int depth);
+
+    /** Add count to key and return its new estimate. */
+    uint64_t add(uint64_t key, uint64_t count);
+    uint64_t estimate(uint64_t key) const;
+    void clear();
+
+    int getWidth() const { return 1 << m_width_bits; }
+    int getDepth() const { return m_depth; }
+
+  private:
+    int
+    index(uint64_t hash, int row) const
+    {
+        return (row << m_width_bits) +
+            ((hash * m_seeds[row]) >> (64 - m_width_bits));
+    }
+
+    static uint64_t mix(uint64_t key);
+    uint64_t estimateHashed(uint64_t hash) const;
+
+    int m_width_bits;
+    int m_depth;
+    std::vector<uint64_t> m_seeds;
+    std::vector<uint64_t> m_counters;
+};
+
+/**
+ * Bounded heavy-hitter tracker. Keys are counted in a count-min
+ * sketch, and the capacity keys with the largest estimates are kept in
+ * a min-heap, space-saving style: a key that is not tracked replaces
+ * the coldest tracked key once its estimate exceeds that key's count.
+ * Each tracked key carries a Record, which is cleared (Record::clear())
+ * when its slot is taken over, so it only covers the samples since the
+ * key was last admitted. Memory use is fixed at construction.
+ */
+template <class Record>
+class HeavyHitters
+{
+  public:
+    struct Entry
+    {
+        Entry() : key(0), count(0) {}
+
+        uint64_t key;
+        uint64_t count;
+        Record record;
+    };
+
+    HeavyHitters(int capacity, int width, int depth)
+        : m_sketch(width, depth), m_entries(capacity), m_pos(capacity),
+          m_total(0)
+    {
+        fatal_if(capacity < 1,
+                 "Heavy hitters need at least 1 entry, not %d\n", capacity);
+        m_heap.reserve(capacity);
+        m_slots.reserve(capacity);
+    }
+
+    /**
+     * Count a sample of key. Returns the record of key when it is
+     * tracked, and NULL otherwise.
+     */
+    Record *
+    sample(uint64_t key, uint64_t count = 1)
+    {
+        m_total += count;
+        uint64_t estimate = m_sketch.add(key, count);
+
+        auto it = m_slots.find(key);
+        if (it != m_slots.end()) {
+            Entry &entry = m_entries[it->second];
+            entry.count = estimate;
+            siftDown(m_pos[it->second]);
+            return &entry.record;
+        }
+
+        int slot;
+        if (m_heap.size() < m_entries.size()) {
+            slot = m_heap.size();
+            m_pos[slot] = m_heap.size();
+            m_heap.push_back(slot);
+        } else {
+            slot = m_heap[0];
+            if (estimate <= m_entries[slot].count)
+                return NULL;
+            m_slots.erase(m_entries[slot].key);
+            m_entries[slot].record.clear();
+        }
+
+        Entry &entry = m_entries[slot];
+        entry.key = key;
+        entry.count = estimate;
+        m_slots[key] = slot;
+        // a new slot may be colder than its parents, a replaced root
+        // is hotter than its children
+        siftUp(m_pos[slot]);
+        siftDown(m_pos[slot]);
+        return &entry.record;
+    }
+
+    void
+    clear()
+    {
+        for (int slot : m_heap)
+            m_entries[slot].record.clear();
+        m_heap.clear();
+        m_slots.clear();
+        m_sketch.clear();
+        m_total = 0;
+    }
+
+    /** Total count of all samples, tracked or not. */
+    uint64_t getTotal() const { return m_total; }
+    int size() const { return m_heap.size(); }
+    int getCapacity() const { return m_entries.size(); }
+
+    /** Tracked entries, hottest first. */
+    std::vector<const Entry *>
+    sorted() const
+    {
+        std::vector<const Entry *> result;
+        for (int slot : m_heap)
+            result.push_back(&m_entries[slot]);
+        std::sort(result.begin(), result.end(),
+                  [](const Entry *a, const Entry *b) {
+                      return a->count > b->count ||
+                          (a->count == b->count && a->key < b->key);
+                  });
+        return result;
+    }
+
+  private:
+    uint64_t count(int pos) const { return m_entries[m_heap[pos]].count; }
+
+    void
+    swap(int a, int b)
+    {
+        std::swap(m_heap[a], m_heap[b]);
+        m_pos[m_heap[a]] = a;
+        m_pos[m_heap[b]] = b;
+    }
+
+    void
+    siftUp(int pos)
+    {
+        while (pos > 0 && count(pos) < count((pos - 1) / 2)) {
+            swap(pos, (pos - 1) / 2);
+            pos = (pos - 1) / 2;
+        }
+    }
+
+    void
+    siftDown(int pos)
+    {
+        int size = m_heap.size();
+        while (true) {
+            int child = 2 * pos + 1;
+            if (child >= size)
+                break;
+            if (child + 1 < size && count(child + 1) < count(child))
+                child++;
+            if (count(pos) <= count(child))
+                break;
+            swap(pos, child);
+            pos = child;
+        }
+    }
+
+    CountMinSketch m_sketch;
+
+    //! Fixed record slots, the heap orders them by count
+    std::vector<Entry> m_entries;
+    std::vector<int> m_heap;
+    std::vector<int> m_pos;
+    std::unordered_map<uint64_t, int> m_slots;
+
+    uint64_t m_total;
+};
+
+#endif // __MEM_RUBY_PROFILER_HEAVYHITTERS_HH__
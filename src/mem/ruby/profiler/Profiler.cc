@@ -84,12 +84,19 @@ Profiler::Profiler(const RubySystemParams *p, RubySystem *rs)
       m_all_instructions(p->all_instructions),
       m_num_vnets(p->number_of_virtual_networks)
 {
-    m_address_profiler_ptr = new AddressProfiler(p->num_of_sequencers, this);
+    m_address_profiler_ptr =
+        new AddressProfiler(p->num_of_sequencers, this, p->hot_lines_entries,
+                            p->hot_lines_sketch_width,
+                            p->hot_lines_sketch_depth);
     m_address_profiler_ptr->setHotLines(m_hot_lines);
     m_address_profiler_ptr->setAllInstructions(m_all_instructions);
 
     if (m_all_instructions) {
-        m_inst_profiler_ptr = new AddressProfiler(p->num_of_sequencers, this);
+        m_inst_profiler_ptr =
+            new AddressProfiler(p->num_of_sequencers, this,
+                                p->hot_lines_entries,
+                                p->hot_lines_sketch_width,
+                                p->hot_lines_sketch_depth);
         m_inst_profiler_ptr->setHotLines(m_hot_lines);
         m_inst_profiler_ptr->setAllInstructions(m_all_instructions);
     }
@@ -102,12 +109,12 @@ Profiler::~Profiler()
 void
 Profiler::regStats(const std::string &pName)
 {
-    if (!m_all_instructions) {
-        m_address_profiler_ptr->regStats(pName);
-    }
+    // Data accesses are always profiled, instructions only with
+    // all_instructions
+    m_address_profiler_ptr->regStats(pName);
 
     if (m_all_instructions) {
-        m_inst_profiler_ptr->regStats(pName);
+        m_inst_profiler_ptr->regStats(pName + ".inst");
     }
 
     delayHistogram
@@ -346,9 +353,7 @@ Profiler::regStats(const std::string &pName)
 void
 Profiler::collateStats()
 {
-    if (!m_all_instructions) {
-        m_address_profiler_ptr->collateStats();
-    }
+    m_address_profiler_ptr->collateStats();
 
     if (m_all_instructions) {
         m_inst_profiler_ptr->collateStats();
@@ -83,6 +83,22 @@ AbstractController::regStats()
         .name(name() + ".fully_busy_cycles")
         .desc("cycles for which number of transistions == max transitions")
         .flags(Stats::nozero);
+
+    m_wakeups
+        .name(name() + ".wakeups")
+        .desc("number of times the controller was woken up")
+        .flags(Stats::nozero);
+
+    m_transitions
+        .name(name() + ".transitions")
+        .desc("number of transitions carried out")
+        .flags(Stats::nozero);
+
+    m_wakeups_per_transition
+        .name(name() + ".wakeups_per_transition")
+        .desc("wakeups per transition carried out")
+        .flags(Stats::nozero);
+    m_wakeups_per_transition = m_wakeups / m_transitions;
 }
 
 void
@@ -320,7 +336,7 @@ AbstractController::recvTimingResp(PacketPtr pkt)
     assert(getMemoryQueue());
     assert(pkt->isResponse());
 
-    std::shared_ptr<MemoryMsg> msg = std::make_shared<MemoryMsg>(clockEdge());
+    RefCountingPtr<MemoryMsg> msg = new MemoryMsg(clockEdge());
     (*msg).m_addr = pkt->getAddr();
     (*msg).m_Sender = m_machineID;
 
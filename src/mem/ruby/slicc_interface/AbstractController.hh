@@ -89,6 +89,25 @@ class AbstractController : public MemObject, public Consumer
     virtual Sequencer* getCPUSequencer() const = 0;
     virtual GPUCoalescer* getGPUCoalescer() const = 0;
 
+    /**
+     * Install a block recorded in a cache trace directly in one of the
+     * controller's caches, in the stable state the protocol marks for
+     * the request type that recorded it (see the warmup pair of SLICC
+     * states). Returns false if the block was not installed, in which
+     * case it is warmed up by replaying its request instead.
+     */
+    virtual bool installCacheBlock(Addr addr, RubyRequestType type,
+                                   const DataBlock& data)
+    { return false; }
+
+    /**
+     * Whether the controller keeps state about the blocks held in
+     * other controllers' caches, such as a probe filter or a full-bit
+     * directory, which installCacheBlock() would leave out of date (see
+     * the tracks_sharers pair of SLICC machines).
+     */
+    virtual bool tracksSharers() const { return false; }
+
     //! These functions are used by ruby system to read/write the data blocks
     //! that exist with in the controller.
     virtual void functionalRead(const Addr &addr, PacketPtr) = 0;
@@ -169,6 +188,12 @@ class AbstractController : public MemObject, public Consumer
     //! were equal to the maximum allowed
     Stats::Scalar m_fully_busy_cycles;
 
+    //! Number of wakeups and of transitions they carried out, to tell
+    //! how many wakeups find nothing to do
+    Stats::Scalar m_wakeups;
+    Stats::Scalar m_transitions;
+    Stats::Formula m_wakeups_per_transition;
+
     //! Histogram for profiling delay for the messages this controller
     //! cares for
     Stats::Histogram m_delayHistogram;
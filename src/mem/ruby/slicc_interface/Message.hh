@@ -30,17 +30,25 @@
 #define __MEM_RUBY_SLICC_INTERFACE_MESSAGE_HH__
 
 #include <iostream>
-#include <memory>
 #include <stack>
 
+#include "base/refcnt.hh"
 #include "mem/packet.hh"
 #include "mem/protocol/MessageSizeType.hh"
 #include "mem/ruby/common/NetDest.hh"
+#include "mem/ruby/slicc_interface/MessagePool.hh"
 
 class Message;
-typedef std::shared_ptr<Message> MsgPtr;
 
-class Message
+/**
+ * Messages are reference counted intrusively and the count is not
+ * atomic: a message is only ever touched by the thread that owns the
+ * event queue it is currently travelling on. Messages crossing to
+ * another event queue are copied, see MessageBuffer::enqueueRemote().
+ */
+typedef RefCountingPtr<Message> MsgPtr;
+
+class Message : public RefCounted
 {
   public:
     Message(Tick curTime)
@@ -49,8 +57,10 @@ class Message
           m_DelayedTicks(0), m_msg_counter(0)
     { }
 
+    // A copy is a new message, so it starts with its own reference
+    // count rather than the one of the message it was cloned from.
     Message(const Message &other)
-        : m_time(other.m_time),
+        : RefCounted(), m_time(other.m_time),
           m_LastEnqueueTime(other.m_LastEnqueueTime),
           m_DelayedTicks(other.m_DelayedTicks),
           m_msg_counter(other.m_msg_counter)
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Authors: agent
+ */
+
+#ifndef __MEM_RUBY_SLICC_INTERFACE_MESSAGEPOOL_HH__
+#define __MEM_RUBY_SLICC_INTERFACE_MESSAGEPOOL_HH__
+
+#include <cstddef>
+#include <new>
+
+/**
+ * Per-type free list for Ruby messages. Every message hop used to be
+ * a heap allocation; messages are instead recycled through a free
+ * list that is private to the thread running the event queue, so no
+ * locking is needed. A message released on a different thread than
+ * the one that allocated it simply migrates to that thread's list.
+ *
+ * Message classes hook into the pool by defining class-specific
+ * operator new and delete (SLICC generates these for every message
+ * type). Requests for a size other than sizeof(T), e.g. from a
+ * derived class that does not provide its own operators, bypass the
+ * pool.
+ */
+template <class T>
+class MessagePool
+{
+  private:
+    struct FreeNode
+    {
+        FreeNode *next;
+    };
+
+    struct FreeList
+    {
+        FreeNode *head;
+
+        FreeList() : head(nullptr) { }
+
+        ~FreeList()
+        {
+            while (head) {
+                FreeNode *next = head->next;
+                ::operator delete(head);
+                head = next;
+            }
+        }
+    };
+
+    static thread_local FreeList freeList;
+
+  public:
+    static void *
+    allocate(size_t size)
+    {
+        if (size != sizeof(T) || !freeList.head)
+            return ::operator new(size);
+
+        FreeNode *node = freeList.head;
+        freeList.head = node->next;
+        return node;
+    }
+
+    static void
+    release(void *p, size_t size)
+    {
+        if (!p)
+            return;
+
+        if (size != sizeof(T)) {
+            ::operator delete(p);
+            return;
+        }
+
+        FreeNode *node = static_cast<FreeNode *>(p);
+        node->next = freeList.head;
+        freeList.head = node;
+    }
+};
+
+template <class T>
+thread_local typename MessagePool<T>::FreeList MessagePool<T>::freeList;
+
+#endif // __MEM_RUBY_SLICC_INTERFACE_MESSAGEPOOL_HH__
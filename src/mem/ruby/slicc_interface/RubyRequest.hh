@@ -142,7 +142,12 @@ class RubyRequest : public Message
 
     RubyRequest(Tick curTime) : Message(curTime) {}
     MsgPtr clone() const
-    { return std::shared_ptr<Message>(new RubyRequest(*this)); }
+    { return MsgPtr(new RubyRequest(*this)); }
+
+    static void *operator new(size_t size)
+    { return MessagePool<RubyRequest>::allocate(size); }
+    static void operator delete(void *p, size_t size)
+    { MessagePool<RubyRequest>::release(p, size); }
 
     Addr getLineAddress() const { return m_LineAddress; }
     Addr getPhysicalAddress() const { return m_PhysicalAddress; }
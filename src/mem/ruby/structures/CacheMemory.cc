@@ -82,19 +82,16 @@ CacheMemory::init()
     m_cache_num_set_bits = floorLog2(m_cache_num_sets);
     assert(m_cache_num_set_bits > 0);
 
-    m_cache.resize(m_cache_num_sets,
-                    std::vector<AbstractCacheEntry*>(m_cache_assoc, nullptr));
+    m_tags.resize(m_cache_num_sets * m_cache_assoc, MaxAddr);
+    m_cache.resize(m_cache_num_sets * m_cache_assoc, nullptr);
 }
 
 CacheMemory::~CacheMemory()
 {
     if (m_replacementPolicy_ptr)
         delete m_replacementPolicy_ptr;
-    for (int i = 0; i < m_cache_num_sets; i++) {
-        for (int j = 0; j < m_cache_assoc; j++) {
-            delete m_cache[i][j];
-        }
-    }
+    for (auto entry : m_cache)
+        delete entry;
 }
 
 // convert a Address to its location in the cache
@@ -111,13 +108,11 @@ CacheMemory::addressToCacheSet(Addr address) const
 int
 CacheMemory::findTagInSet(int64_t cacheSet, Addr tag) const
 {
-    assert(tag == makeLineAddress(tag));
-    // search the set for the tags
-    auto it = m_tag_index.find(tag);
-    if (it != m_tag_index.end())
-        if (m_cache[cacheSet][it->second]->m_Permission !=
-            AccessPermission_NotPresent)
-            return it->second;
+    int loc = findTagInSetIgnorePermissions(cacheSet, tag);
+    if (loc != -1 &&
+        m_cache[blockIndex(cacheSet, loc)]->m_Permission !=
+        AccessPermission_NotPresent)
+        return loc;
     return -1; // Not found
 }
 
@@ -129,9 +124,11 @@ CacheMemory::findTagInSetIgnorePermissions(int64_t cacheSet,
 {
     assert(tag == makeLineAddress(tag));
     // search the set for the tags
-    auto it = m_tag_index.find(tag);
-    if (it != m_tag_index.end())
-        return it->second;
+    const Addr *tags = &m_tags[blockIndex(cacheSet, 0)];
+    for (int i = 0; i < m_cache_assoc; i++) {
+        if (tags[i] == tag)
+            return i;
+    }
     return -1; // Not found
 }
 
@@ -143,13 +140,9 @@ CacheMemory::getAddressAtIdx(int idx) const
 {
     Addr tmp(0);
 
-    int set = idx / m_cache_assoc;
-    assert(set < m_cache_num_sets);
-
-    int way = idx - set * m_cache_assoc;
-    assert (way < m_cache_assoc);
+    assert(idx < m_cache_num_sets * m_cache_assoc);
 
-    AbstractCacheEntry* entry = m_cache[set][way];
+    AbstractCacheEntry* entry = m_cache[idx];
     if (entry == NULL ||
         entry->m_Permission == AccessPermission_Invalid ||
         entry->m_Permission == AccessPermission_NotPresent) {
@@ -168,7 +161,7 @@ CacheMemory::tryCacheAccess(Addr address, RubyRequestType type,
     int loc = findTagInSet(cacheSet, address);
     if (loc != -1) {
         // Do we even have a tag match?
-        AbstractCacheEntry* entry = m_cache[cacheSet][loc];
+        AbstractCacheEntry* entry = m_cache[blockIndex(cacheSet, loc)];
         m_replacementPolicy_ptr->touch(cacheSet, loc, curTick());
         data_ptr = &(entry->getDataBlk());
 
@@ -196,12 +189,11 @@ CacheMemory::testCacheAccess(Addr address, RubyRequestType type,
 
     if (loc != -1) {
         // Do we even have a tag match?
-        AbstractCacheEntry* entry = m_cache[cacheSet][loc];
+        AbstractCacheEntry* entry = m_cache[blockIndex(cacheSet, loc)];
         m_replacementPolicy_ptr->touch(cacheSet, loc, curTick());
         data_ptr = &(entry->getDataBlk());
 
-        return m_cache[cacheSet][loc]->m_Permission !=
-            AccessPermission_NotPresent;
+        return entry->m_Permission != AccessPermission_NotPresent;
     }
 
     data_ptr = NULL;
@@ -236,7 +228,7 @@ CacheMemory::cacheAvail(Addr address) const
     int64_t cacheSet = addressToCacheSet(address);
 
     for (int i = 0; i < m_cache_assoc; i++) {
-        AbstractCacheEntry* entry = m_cache[cacheSet][i];
+        AbstractCacheEntry* entry = m_cache[blockIndex(cacheSet, i)];
         if (entry != NULL) {
             if (entry->m_Address == address ||
                 entry->m_Permission == AccessPermission_NotPresent) {
@@ -260,7 +252,7 @@ CacheMemory::allocate(Addr address, AbstractCacheEntry *entry, bool touch)
 
     // Find the first open slot
     int64_t cacheSet = addressToCacheSet(address);
-    std::vector<AbstractCacheEntry*> &set = m_cache[cacheSet];
+    AbstractCacheEntry **set = &m_cache[blockIndex(cacheSet, 0)];
     for (int i = 0; i < m_cache_assoc; i++) {
         if (!set[i] || set[i]->m_Permission == AccessPermission_NotPresent) {
             if (set[i] && (set[i] != entry)) {
@@ -276,7 +268,7 @@ CacheMemory::allocate(Addr address, AbstractCacheEntry *entry, bool touch)
             DPRINTF(RubyCache, "Allocate clearing lock for addr: %x\n",
                     address);
             set[i]->m_locked = -1;
-            m_tag_index[address] = i;
+            m_tags[blockIndex(cacheSet, i)] = address;
             entry->setSetIndex(cacheSet);
             entry->setWayIndex(i);
 
@@ -299,9 +291,10 @@ CacheMemory::deallocate(Addr address)
     int64_t cacheSet = addressToCacheSet(address);
     int loc = findTagInSet(cacheSet, address);
     if (loc != -1) {
-        delete m_cache[cacheSet][loc];
-        m_cache[cacheSet][loc] = NULL;
-        m_tag_index.erase(address);
+        int64_t idx = blockIndex(cacheSet, loc);
+        delete m_cache[idx];
+        m_cache[idx] = NULL;
+        m_tags[idx] = MaxAddr;
     }
 }
 
@@ -313,8 +306,8 @@ CacheMemory::cacheProbe(Addr address) const
     assert(!cacheAvail(address));
 
     int64_t cacheSet = addressToCacheSet(address);
-    return m_cache[cacheSet][m_replacementPolicy_ptr->getVictim(cacheSet)]->
-        m_Address;
+    int loc = m_replacementPolicy_ptr->getVictim(cacheSet);
+    return m_cache[blockIndex(cacheSet, loc)]->m_Address;
 }
 
 // looks an address up in the cache
@@ -325,7 +318,7 @@ CacheMemory::lookup(Addr address)
     int64_t cacheSet = addressToCacheSet(address);
     int loc = findTagInSet(cacheSet, address);
     if (loc == -1) return NULL;
-    return m_cache[cacheSet][loc];
+    return m_cache[blockIndex(cacheSet, loc)];
 }
 
 // looks an address up in the cache
@@ -336,7 +329,7 @@ CacheMemory::lookup(Addr address) const
     int64_t cacheSet = addressToCacheSet(address);
     int loc = findTagInSet(cacheSet, address);
     if (loc == -1) return NULL;
-    return m_cache[cacheSet][loc];
+    return m_cache[blockIndex(cacheSet, loc)];
 }
 
 // Sets the most recently used bit for a cache block
@@ -381,8 +374,9 @@ CacheMemory::getReplacementWeight(int64_t set, int64_t loc)
     assert(set < m_cache_num_sets);
     assert(loc < m_cache_assoc);
     int ret = 0;
-    if (m_cache[set][loc] != NULL) {
-        ret = m_cache[set][loc]->getNumValidBlocks();
+    AbstractCacheEntry *entry = m_cache[blockIndex(set, loc)];
+    if (entry != NULL) {
+        ret = entry->getNumValidBlocks();
         assert(ret >= 0);
     }
 
@@ -398,8 +392,9 @@ CacheMemory::recordCacheContents(int cntrl, CacheRecorder* tr) const
 
     for (int i = 0; i < m_cache_num_sets; i++) {
         for (int j = 0; j < m_cache_assoc; j++) {
-            if (m_cache[i][j] != NULL) {
-                AccessPermission perm = m_cache[i][j]->m_Permission;
+            AbstractCacheEntry *entry = m_cache[blockIndex(i, j)];
+            if (entry != NULL) {
+                AccessPermission perm = entry->m_Permission;
                 RubyRequestType request_type = RubyRequestType_NULL;
                 if (perm == AccessPermission_Read_Only) {
                     if (m_is_instruction_only_cache) {
@@ -412,10 +407,10 @@ CacheMemory::recordCacheContents(int cntrl, CacheRecorder* tr) const
                 }
 
                 if (request_type != RubyRequestType_NULL) {
-                    tr->addRecord(cntrl, m_cache[i][j]->m_Address,
+                    tr->addRecord(cntrl, entry->m_Address,
                                   0, request_type,
                                   m_replacementPolicy_ptr->getLastAccess(i, j),
-                                  m_cache[i][j]->getDataBlk());
+                                  entry->getDataBlk());
                     warmedUpBlocks++;
                 }
             }
@@ -433,10 +428,11 @@ CacheMemory::print(ostream& out) const
     out << "Cache dump: " << name() << endl;
     for (int i = 0; i < m_cache_num_sets; i++) {
         for (int j = 0; j < m_cache_assoc; j++) {
-            if (m_cache[i][j] != NULL) {
+            const AbstractCacheEntry *entry = m_cache[blockIndex(i, j)];
+            if (entry != NULL) {
                 out << "  Index: " << i
                     << " way: " << j
-                    << " entry: " << *m_cache[i][j] << endl;
+                    << " entry: " << *entry << endl;
             } else {
                 out << "  Index: " << i
                     << " way: " << j
@@ -460,7 +456,7 @@ CacheMemory::setLocked(Addr address, int context)
     int64_t cacheSet = addressToCacheSet(address);
     int loc = findTagInSet(cacheSet, address);
     assert(loc != -1);
-    m_cache[cacheSet][loc]->setLocked(context);
+    m_cache[blockIndex(cacheSet, loc)]->setLocked(context);
 }
 
 void
@@ -471,7 +467,7 @@ CacheMemory::clearLocked(Addr address)
     int64_t cacheSet = addressToCacheSet(address);
     int loc = findTagInSet(cacheSet, address);
     assert(loc != -1);
-    m_cache[cacheSet][loc]->clearLocked();
+    m_cache[blockIndex(cacheSet, loc)]->clearLocked();
 }
 
 bool
@@ -481,9 +477,10 @@ CacheMemory::isLocked(Addr address, int context)
     int64_t cacheSet = addressToCacheSet(address);
     int loc = findTagInSet(cacheSet, address);
     assert(loc != -1);
+    AbstractCacheEntry *entry = m_cache[blockIndex(cacheSet, loc)];
     DPRINTF(RubyCache, "Testing Lock for addr: %#llx cur %d con %d\n",
-            address, m_cache[cacheSet][loc]->m_locked, context);
-    return m_cache[cacheSet][loc]->isLocked(context);
+            address, entry->m_locked, context);
+    return entry->isLocked(context);
 }
 
 void
@@ -645,11 +642,13 @@ CacheMemory::checkResourceAvailable(CacheResourceType res, Addr addr)
 bool
 CacheMemory::isBlockInvalid(int64_t cache_set, int64_t loc)
 {
-  return (m_cache[cache_set][loc]->m_Permission == AccessPermission_Invalid);
+  return (m_cache[blockIndex(cache_set, loc)]->m_Permission ==
+          AccessPermission_Invalid);
 }
 
 bool
 CacheMemory::isBlockNotBusy(int64_t cache_set, int64_t loc)
 {
-  return (m_cache[cache_set][loc]->m_Permission != AccessPermission_Busy);
+  return (m_cache[blockIndex(cache_set, loc)]->m_Permission !=
+          AccessPermission_Busy);
 }
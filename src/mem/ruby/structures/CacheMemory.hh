@@ -31,7 +31,6 @@
 #define __MEM_RUBY_STRUCTURES_CACHEMEMORY_HH__
 
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 #include "base/statistics.hh"
@@ -68,6 +67,8 @@ class CacheMemory : public SimObject
     // tests to see if an address is present in the cache
     bool isTagPresent(Addr address) const;
 
+    bool isInstructionOnly() const { return m_is_instruction_only_cache; }
+
     // Returns true if there is:
     //   a) a tag match on this address or there is
     //   b) an unused line in the same cache "way"
@@ -160,6 +161,13 @@ class CacheMemory : public SimObject
     int findTagInSet(int64_t line, Addr tag) const;
     int findTagInSetIgnorePermissions(int64_t cacheSet, Addr tag) const;
 
+    // position of a way in the flat m_tags/m_cache arrays
+    int64_t
+    blockIndex(int64_t cacheSet, int loc) const
+    {
+        return cacheSet * m_cache_assoc + loc;
+    }
+
     // Private copy constructor and assignment operator
     CacheMemory(const CacheMemory& obj);
     CacheMemory& operator=(const CacheMemory& obj);
@@ -168,10 +176,13 @@ class CacheMemory : public SimObject
     // Data Members (m_prefix)
     bool m_is_instruction_only_cache;
 
-    // The first index is the # of cache lines.
-    // The second index is the the amount associativity.
-    std::unordered_map<Addr, int> m_tag_index;
-    std::vector<std::vector<AbstractCacheEntry*> > m_cache;
+    // Both arrays are indexed by set * associativity + way, so the
+    // ways of a set are contiguous. m_tags holds the line address
+    // stored in each way (MaxAddr when the way is empty), which lets a
+    // lookup scan a single run of tags and only touch the entry that
+    // matches.
+    std::vector<Addr> m_tags;
+    std::vector<AbstractCacheEntry*> m_cache;
 
     AbstractReplacementPolicy *m_replacementPolicy_ptr;
 
@@ -48,15 +48,20 @@ DirectoryMemory::DirectoryMemory(const Params *p)
     m_size_bits = floorLog2(m_size_bytes);
     m_num_entries = 0;
     m_numa_high_bit = p->numa_high_bit;
+
+    fatal_if(!isPowerOf2(p->entries_per_page),
+             "%s: entries_per_page must be a power of 2\n", name());
+    m_page_entries = p->entries_per_page;
+    m_page_bits = floorLog2(m_page_entries);
+    m_num_pages = 0;
 }
 
 void
 DirectoryMemory::init()
 {
     m_num_entries = m_size_bytes / RubySystem::getBlockSizeBytes();
-    m_entries = new AbstractEntry*[m_num_entries];
-    for (int i = 0; i < m_num_entries; i++)
-        m_entries[i] = NULL;
+    m_num_pages = divCeil(m_num_entries, m_page_entries);
+    m_pages.resize(m_num_pages, nullptr);
 
     m_num_directories++;
     m_num_directories_bits = ceilLog2(m_num_directories);
@@ -70,12 +75,13 @@ DirectoryMemory::init()
 DirectoryMemory::~DirectoryMemory()
 {
     // free up all the directory entries
-    for (uint64_t i = 0; i < m_num_entries; i++) {
-        if (m_entries[i] != NULL) {
-            delete m_entries[i];
-        }
+    for (auto page : m_pages) {
+        if (page == nullptr)
+            continue;
+        for (uint64_t i = 0; i < m_page_entries; i++)
+            delete page[i];
+        delete [] page;
     }
-    delete [] m_entries;
 }
 
 uint64_t
@@ -119,7 +125,10 @@ DirectoryMemory::lookup(Addr address)
 
     uint64_t idx = mapAddressToLocalIdx(address);
     assert(idx < m_num_entries);
-    return m_entries[idx];
+    AbstractEntry **page = m_pages[idx >> m_page_bits];
+    if (page == nullptr)
+        return NULL;
+    return page[idx & (m_page_entries - 1)];
 }
 
 AbstractEntry*
@@ -132,7 +141,14 @@ DirectoryMemory::allocate(Addr address, AbstractEntry *entry)
     idx = mapAddressToLocalIdx(address);
     assert(idx < m_num_entries);
     entry->changePermission(AccessPermission_Read_Only);
-    m_entries[idx] = entry;
+
+    AbstractEntry **&page = m_pages[idx >> m_page_bits];
+    if (page == nullptr) {
+        DPRINTF(RubyCache, "Allocating directory page %d\n",
+                idx >> m_page_bits);
+        page = new AbstractEntry*[m_page_entries]();
+    }
+    page[idx & (m_page_entries - 1)] = entry;
 
     return entry;
 }
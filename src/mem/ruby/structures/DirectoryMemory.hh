@@ -31,6 +31,7 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
 
 #include "mem/protocol/DirectoryRequestType.hh"
 #include "mem/ruby/common/Address.hh"
@@ -66,7 +67,19 @@ class DirectoryMemory : public SimObject
 
   private:
     const std::string m_name;
-    AbstractEntry **m_entries;
+
+    /**
+     * The entries are kept in a two-level table, like a page table: a
+     * directory of page pointers that covers the whole range, and
+     * pages of m_page_entries entries that are only allocated once an
+     * entry in them is allocated. Large memories that are only
+     * sparsely touched therefore cost little host memory, and none of
+     * it is spent up front.
+     */
+    std::vector<AbstractEntry **> m_pages;
+    uint64_t m_page_entries;
+    int m_page_bits;
+    uint64_t m_num_pages;
     // int m_size;  // # of memory module blocks this directory is
                     // responsible for
     uint64_t m_size_bytes;
@@ -29,19 +29,27 @@
 #ifndef __MEM_RUBY_STRUCTURES_TBETABLE_HH__
 #define __MEM_RUBY_STRUCTURES_TBETABLE_HH__
 
+#include <algorithm>
 #include <iostream>
-#include <unordered_map>
+#include <vector>
 
+#include "base/intmath.hh"
 #include "mem/ruby/common/Address.hh"
-
+#include "mem/ruby/system/RubySystem.hh"
+
+/**
+ * The TBEs live in a pool that is allocated once, with room for
+ * exactly m_number_of_TBEs entries, so pointers handed out by lookup()
+ * stay valid until the entry is deallocated. The pool is indexed by a
+ * small open-addressing table (linear probing, at most half full)
+ * keyed on the line number, which avoids both hashing the full
+ * address and chasing bucket lists.
+ */
 template<class ENTRY>
 class TBETable
 {
   public:
-    TBETable(int number_of_TBEs)
-        : m_number_of_TBEs(number_of_TBEs)
-    {
-    }
+    TBETable(int number_of_TBEs);
 
     bool isPresent(Addr address) const;
     void allocate(Addr address);
@@ -49,11 +57,17 @@ class TBETable
     bool
     areNSlotsAvailable(int n, Tick current_time) const
     {
-        return (m_number_of_TBEs - m_map.size()) >= n;
+        return (m_number_of_TBEs - m_size) >= n;
     }
 
     ENTRY *lookup(Addr address);
 
+    int size() const { return m_size; }
+
+    /** Call f(address, entry) for every allocated entry */
+    template<class F>
+    void forEachEntry(F f) const;
+
     // Print cache contents
     void print(std::ostream& out) const;
 
@@ -62,8 +76,29 @@ class TBETable
     TBETable(const TBETable& obj);
     TBETable& operator=(const TBETable& obj);
 
+    /** Home bucket of a line address */
+    int
+    bucket(Addr address) const
+    {
+        return (address >> m_block_size_bits) & m_index_mask;
+    }
+
+    /** Bucket holding address, or -1 if it is not in the table */
+    int findBucket(Addr address) const;
+
+    struct IndexEntry
+    {
+        Addr address;
+        int slot;
+    };
+
     // Data Members (m_prefix)
-    std::unordered_map<Addr, ENTRY> m_map;
+    std::vector<ENTRY> m_entries;
+    std::vector<int> m_free_slots;
+    std::vector<IndexEntry> m_index;
+    int m_index_mask;
+    int m_block_size_bits;
+    int m_size;
 
   private:
     int m_number_of_TBEs;
@@ -78,13 +113,41 @@ operator<<(std::ostream& out, const TBETable<ENTRY>& obj)
     return out;
 }
 
+template<class ENTRY>
+TBETable<ENTRY>::TBETable(int number_of_TBEs)
+    : m_entries(number_of_TBEs),
+      m_index(ceilPow2(2 * std::max(number_of_TBEs, 1)),
+              IndexEntry{MaxAddr, -1}),
+      m_index_mask(m_index.size() - 1),
+      m_block_size_bits(RubySystem::getBlockSizeBits()),
+      m_size(0),
+      m_number_of_TBEs(number_of_TBEs)
+{
+    // Hand out the low slots first
+    m_free_slots.reserve(number_of_TBEs);
+    for (int i = number_of_TBEs - 1; i >= 0; i--)
+        m_free_slots.push_back(i);
+}
+
+template<class ENTRY>
+inline int
+TBETable<ENTRY>::findBucket(Addr address) const
+{
+    for (int i = bucket(address); m_index[i].slot != -1;
+         i = (i + 1) & m_index_mask) {
+        if (m_index[i].address == address)
+            return i;
+    }
+    return -1;
+}
+
 template<class ENTRY>
 inline bool
 TBETable<ENTRY>::isPresent(Addr address) const
 {
     assert(address == makeLineAddress(address));
-    assert(m_map.size() <= m_number_of_TBEs);
-    return !!m_map.count(address);
+    assert(m_size <= m_number_of_TBEs);
+    return findBucket(address) != -1;
 }
 
 template<class ENTRY>
@@ -92,8 +155,18 @@ inline void
 TBETable<ENTRY>::allocate(Addr address)
 {
     assert(!isPresent(address));
-    assert(m_map.size() < m_number_of_TBEs);
-    m_map[address] = ENTRY();
+    assert(m_size < m_number_of_TBEs);
+
+    int slot = m_free_slots.back();
+    m_free_slots.pop_back();
+    m_entries[slot] = ENTRY();
+
+    int i = bucket(address);
+    while (m_index[i].slot != -1)
+        i = (i + 1) & m_index_mask;
+    m_index[i].address = address;
+    m_index[i].slot = slot;
+    m_size++;
 }
 
 template<class ENTRY>
@@ -101,8 +174,31 @@ inline void
 TBETable<ENTRY>::deallocate(Addr address)
 {
     assert(isPresent(address));
-    assert(m_map.size() > 0);
-    m_map.erase(address);
+    assert(m_size > 0);
+
+    int i = findBucket(address);
+    m_free_slots.push_back(m_index[i].slot);
+    m_size--;
+
+    // Backward-shift deletion: pull later members of the probe
+    // sequence into the hole so that lookups never need tombstones.
+    int j = i;
+    while (true) {
+        j = (j + 1) & m_index_mask;
+        if (m_index[j].slot == -1)
+            break;
+        int home = bucket(m_index[j].address);
+        // Move j into the hole unless its home lies cyclically in
+        // (i, j], in which case it is still reachable from there
+        bool reachable = (i <= j) ? (i < home && home <= j)
+                                  : (i < home || home <= j);
+        if (!reachable) {
+            m_index[i] = m_index[j];
+            i = j;
+        }
+    }
+    m_index[i].address = MaxAddr;
+    m_index[i].slot = -1;
 }
 
 // looks an address up in the cache
@@ -110,10 +206,22 @@ template<class ENTRY>
 inline ENTRY*
 TBETable<ENTRY>::lookup(Addr address)
 {
-  if (m_map.find(address) != m_map.end()) return &(m_map.find(address)->second);
-  return NULL;
+    int i = findBucket(address);
+    if (i == -1)
+        return NULL;
+    return &m_entries[m_index[i].slot];
 }
 
+template<class ENTRY>
+template<class F>
+inline void
+TBETable<ENTRY>::forEachEntry(F f) const
+{
+    for (const auto &index : m_index) {
+        if (index.slot != -1)
+            f(index.address, m_entries[index.slot]);
+    }
+}
 
 template<class ENTRY>
 inline void
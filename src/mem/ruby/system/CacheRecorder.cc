@@ -30,6 +30,7 @@
 #include "mem/ruby/system/CacheRecorder.hh"
 
 #include "debug/RubyCacheTrace.hh"
+#include "mem/ruby/slicc_interface/AbstractController.hh"
 #include "mem/ruby/system/RubySystem.hh"
 #include "mem/ruby/system/Sequencer.hh"
 
@@ -145,6 +146,44 @@ CacheRecorder::enqueueNextFetchRequest()
     }
 }
 
+void
+CacheRecorder::installRecords(const vector<AbstractController*>& cntrls)
+{
+    uint64_t record_size = sizeof(TraceRecord) + m_block_size_bytes;
+    uint64_t block_size = RubySystem::getBlockSizeBytes();
+    uint64_t kept_bytes = 0;
+    uint64_t installed = 0;
+
+    for (uint64_t offset = m_bytes_read; offset < m_uncompressed_trace_size;
+         offset += record_size) {
+        TraceRecord* rec = (TraceRecord*)(m_uncompressed_trace + offset);
+        AbstractController* cntrl = cntrls[rec->m_cntrl_id];
+
+        bool done = true;
+        for (uint64_t rec_bytes = 0; rec_bytes < m_block_size_bytes;
+             rec_bytes += block_size) {
+            DataBlock data;
+            data.setData(rec->m_data + rec_bytes, 0, block_size);
+            done &= cntrl->installCacheBlock(rec->m_data_address + rec_bytes,
+                                             rec->m_type, data);
+        }
+
+        if (done) {
+            DPRINTF(RubyCacheTrace, "Installed %s\n", *rec);
+            installed++;
+        } else {
+            // Keep the record, in order, for the request replay
+            memmove(m_uncompressed_trace + m_bytes_read + kept_bytes, rec,
+                    record_size);
+            kept_bytes += record_size;
+        }
+    }
+
+    m_uncompressed_trace_size = m_bytes_read + kept_bytes;
+    DPRINTF(RubyCacheTrace, "Installed %d records, %d left to fetch\n",
+            installed, kept_bytes / record_size);
+}
+
 void
 CacheRecorder::addRecord(int cntrl, Addr data_addr, Addr pc_addr,
                          RubyRequestType type, Tick time, DataBlock& data)
@@ -43,6 +43,7 @@
 #include "mem/ruby/common/DataBlock.hh"
 #include "mem/ruby/common/TypeDefines.hh"
 
+class AbstractController;
 class Sequencer;
 
 /*!
@@ -97,6 +98,17 @@ class CacheRecorder
      */
     void enqueueNextFetchRequest();
 
+    /*!
+     * Function for installing the recorded cache contents directly in
+     * the controllers the records belong to, without issuing any
+     * request. Only the records some controller could not install are
+     * kept, to be fetched by enqueueNextFetchRequest() afterwards.
+     */
+    void installRecords(const std::vector<AbstractController*>& cntrls);
+
+    bool hasRecordsToFetch() const
+    { return m_bytes_read < m_uncompressed_trace_size; }
+
   private:
     // Private copy constructor and assignment operator
     CacheRecorder(const CacheRecorder& obj);
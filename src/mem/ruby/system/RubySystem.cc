@@ -58,7 +58,7 @@ bool RubySystem::m_cooldown_enabled = false;
 
 RubySystem::RubySystem(const Params *p)
     : ClockedObject(p), m_access_backing_store(p->access_backing_store),
-      m_cache_recorder(NULL)
+      m_direct_cache_warmup(p->direct_cache_warmup), m_cache_recorder(NULL)
 {
     m_randomization = p->randomization;
 
@@ -131,9 +131,22 @@ RubySystem::makeCacheRecorder(uint8_t *uncompressed_trace,
                                          sequencer_map, block_size_bytes);
 }
 
+void
+RubySystem::checkSingleEventQueue(const char *what) const
+{
+    // The cache recorder replays its trace on this object's event queue
+    // alone, with the other queues stopped
+    for (auto cntrl : m_abs_cntrl_vec) {
+        fatal_if(cntrl->eventQueue() != eventQueue(),
+                 "%s needs all Ruby controllers on the event queue of %s, "
+                 "%s is not\n", what, name(), cntrl->name());
+    }
+}
+
 void
 RubySystem::memWriteback()
 {
+    checkSingleEventQueue("Ruby cache writeback");
     m_cooldown_enabled = true;
 
     // Make the trace so we know what to write back.
@@ -348,7 +361,21 @@ RubySystem::startup()
     // Ruby finishes restoring the state is less than the time when the
     // state was checkpointed.
 
+    // Controllers and network routers may be placed on different event
+    // queues, with the network links between them as the boundary (see
+    // MessageBuffer::enqueue). Randomized message latencies draw from
+    // the shared random number generator, so they need a single queue.
+    fatal_if(m_randomization && numMainEventQueues > 1,
+             "Ruby randomization is not supported with %d event queues\n",
+             numMainEventQueues);
+
+    // The address profiler is shared by all sequencers
+    fatal_if(m_profiler->getHotLines() && numMainEventQueues > 1,
+             "Ruby hot line profiling is not supported with %d event "
+             "queues\n", numMainEventQueues);
+
     if (m_warmup_enabled) {
+        checkSingleEventQueue("Ruby cache warmup");
         DPRINTF(RubyCacheTrace, "Starting ruby cache warmup\n");
         // save the current tick value
         Tick curtick_original = curTick();
@@ -358,9 +385,23 @@ RubySystem::startup()
         setCurTick(0);
         resetClock();
 
+        // Install what the controllers can take directly, and replay the
+        // requests for the rest
+        if (m_direct_cache_warmup) {
+            for (auto cntrl : m_abs_cntrl_vec) {
+                fatal_if(cntrl->tracksSharers(), "Direct cache warmup "
+                         "does not update the sharers tracked by %s, "
+                         "disable direct_cache_warmup or its probe filter "
+                         "or directory\n", cntrl->name());
+            }
+            m_cache_recorder->installRecords(m_abs_cntrl_vec);
+        }
+
         // Schedule an event to start cache warmup
-        enqueueRubyEvent(curTick());
-        simulate();
+        if (m_cache_recorder->hasRecordsToFetch()) {
+            enqueueRubyEvent(curTick());
+            simulate();
+        }
 
         delete m_cache_recorder;
         m_cache_recorder = NULL;
@@ -395,9 +436,45 @@ RubySystem::resetStats()
     m_start_cycle = curCycle();
 }
 
+/**
+ * Functional accesses touch the state of every controller and of the
+ * network, which may belong to the threads of other event queues.
+ * Stop all the queues for the duration of the access by taking their
+ * service locks, always in the same order so that two threads doing
+ * the same cannot deadlock. The current queue is released first, as
+ * its lock is held while the event issuing the access is serviced.
+ */
+class FunctionalAccessGuard
+{
+  public:
+    FunctionalAccessGuard()
+        : parallel(inParallelMode)
+    {
+        if (!parallel)
+            return;
+        curEventQueue()->unlock();
+        for (uint32_t i = 0; i < numMainEventQueues; ++i)
+            mainEventQueue[i]->lock();
+    }
+
+    ~FunctionalAccessGuard()
+    {
+        if (!parallel)
+            return;
+        for (uint32_t i = numMainEventQueues; i-- > 0; )
+            mainEventQueue[i]->unlock();
+        curEventQueue()->lock();
+    }
+
+  private:
+    const bool parallel;
+};
+
 bool
 RubySystem::functionalRead(PacketPtr pkt)
 {
+    FunctionalAccessGuard guard;
+
     Addr address(pkt->getAddr());
     Addr line_address = makeLineAddress(address);
 
@@ -481,6 +558,8 @@ RubySystem::functionalRead(PacketPtr pkt)
 bool
 RubySystem::functionalWrite(PacketPtr pkt)
 {
+    FunctionalAccessGuard guard;
+
     Addr addr(pkt->getAddr());
     Addr line_addr = makeLineAddress(addr);
     AccessPermission access_perm = AccessPermission_NotPresent;
@@ -123,6 +123,7 @@ class RubySystem : public ClockedObject
     void makeCacheRecorder(uint8_t *uncompressed_trace,
                            uint64_t cache_trace_size,
                            uint64_t block_size_bytes);
+    void checkSingleEventQueue(const char *what) const;
 
     static void readCompressedTrace(std::string filename,
                                     uint8_t *&raw_data,
@@ -142,6 +143,7 @@ class RubySystem : public ClockedObject
     static bool m_cooldown_enabled;
     SimpleMemory *m_phys_mem;
     const bool m_access_backing_store;
+    const bool m_direct_cache_warmup;
 
     Network* m_network;
     std::vector<AbstractController *> m_abs_cntrl_vec;
@@ -149,7 +151,14 @@ class RubySystem : public ClockedObject
 
   public:
     Profiler* m_profiler;
+
+    // Only used while warming up or writing back the caches, which
+    // happens before or after simulation proper, outside parallel mode,
+    // with all the controllers on this object's event queue
     CacheRecorder* m_cache_recorder;
+
+    // Filled in by registerAbstractController() during construction and
+    // read-only afterwards, so the controllers' threads can share it
     std::vector<std::map<uint32_t, AbstractController *> > m_abstract_controls;
 };
 
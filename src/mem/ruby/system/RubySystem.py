@@ -45,9 +45,21 @@ class RubySystem(ClockedObject):
 
     access_backing_store = Param.Bool(False, "Use phys_mem as the functional \
         store and only use ruby for timing.")
+    direct_cache_warmup = Param.Bool(False, "Install the cache blocks of a \
+        checkpoint directly in the warmup states of the protocol instead \
+        of replaying their requests. Only coherent for protocols whose \
+        warmup states need no directory state, e.g. MOESI_hammer without \
+        a probe filter.")
 
     # Profiler related configuration variables
-    hot_lines = Param.Bool(False, "")
+    hot_lines = Param.Bool(False, "Profile the hottest blocks, PCs and \
+        sharer patterns")
     all_instructions = Param.Bool(False, "")
+    hot_lines_entries = Param.Unsigned(100, "Number of hottest blocks, PCs \
+        and sharer patterns tracked by the address profiler")
+    hot_lines_sketch_width = Param.Unsigned(4096, "Counters per row of the \
+        count-min sketches the address profiler ranks entries with")
+    hot_lines_sketch_depth = Param.Unsigned(4, "Rows of the address \
+        profiler's count-min sketches")
     num_of_sequencers = Param.Int("")
     number_of_virtual_networks = Param.Unsigned("")
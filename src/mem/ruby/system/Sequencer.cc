@@ -53,7 +53,8 @@ RubySequencerParams::create()
 }
 
 Sequencer::Sequencer(const Params *p)
-    : RubyPort(p), m_IncompleteTimes(MachineType_NUM), deadlockCheckEvent(this)
+    : RubyPort(p), m_requestTable(p->max_outstanding_requests),
+      m_IncompleteTimes(MachineType_NUM), deadlockCheckEvent(this)
 {
     m_outstanding_count = 0;
 
@@ -63,6 +64,8 @@ Sequencer::Sequencer(const Params *p)
     m_inst_cache_hit_latency = p->icache_hit_latency;
     m_max_outstanding_requests = p->max_outstanding_requests;
     m_deadlock_threshold = p->deadlock_threshold;
+    m_deadlock_check = true;
+    m_max_coalesced_loads = p->max_coalesced_loads;
 
     m_coreId = p->coreid; // for tracking the two CorePair sequencers
     assert(m_max_outstanding_requests > 0);
@@ -71,6 +74,10 @@ Sequencer::Sequencer(const Params *p)
     assert(m_dataCache_ptr != NULL);
     assert(m_data_cache_hit_latency > 0);
     assert(m_inst_cache_hit_latency > 0);
+    fatal_if(m_max_coalesced_loads < 0 ||
+             m_max_coalesced_loads > SEQUENCER_MAX_COALESCED_LOADS,
+             "%s: max_coalesced_loads must be between 0 and %d\n",
+             name(), SEQUENCER_MAX_COALESCED_LOADS);
 
     m_runningGarnetStandalone = p->garnet_standalone;
 }
@@ -88,42 +95,20 @@ Sequencer::wakeup()
     Cycles current_time = curCycle();
 
     // Check across all outstanding requests
-    int total_outstanding = 0;
-
-    RequestTable::iterator read = m_readRequestTable.begin();
-    RequestTable::iterator read_end = m_readRequestTable.end();
-    for (; read != read_end; ++read) {
-        SequencerRequest* request = read->second;
-        if (current_time - request->issue_time < m_deadlock_threshold)
-            continue;
-
-        panic("Possible Deadlock detected. Aborting!\n"
-              "version: %d request.paddr: 0x%x m_readRequestTable: %d "
-              "current time: %u issue_time: %d difference: %d\n", m_version,
-              request->pkt->getAddr(), m_readRequestTable.size(),
-              current_time * clockPeriod(), request->issue_time * clockPeriod(),
-              (current_time * clockPeriod()) - (request->issue_time * clockPeriod()));
-    }
-
-    RequestTable::iterator write = m_writeRequestTable.begin();
-    RequestTable::iterator write_end = m_writeRequestTable.end();
-    for (; write != write_end; ++write) {
-        SequencerRequest* request = write->second;
-        if (current_time - request->issue_time < m_deadlock_threshold)
-            continue;
+    m_requestTable.forEachEntry(
+        [&](Addr line_addr, const SequencerRequest& request) {
+        if (current_time - request.issue_time < m_deadlock_threshold)
+            return;
 
         panic("Possible Deadlock detected. Aborting!\n"
-              "version: %d request.paddr: 0x%x m_writeRequestTable: %d "
+              "version: %d request.paddr: 0x%x m_requestTable: %d "
               "current time: %u issue_time: %d difference: %d\n", m_version,
-              request->pkt->getAddr(), m_writeRequestTable.size(),
-              current_time * clockPeriod(), request->issue_time * clockPeriod(),
-              (current_time * clockPeriod()) - (request->issue_time * clockPeriod()));
-    }
-
-    total_outstanding += m_writeRequestTable.size();
-    total_outstanding += m_readRequestTable.size();
+              request.pkt->getAddr(), m_requestTable.size(),
+              current_time * clockPeriod(), request.issue_time * clockPeriod(),
+              (current_time * clockPeriod()) - (request.issue_time * clockPeriod()));
+    });
 
-    assert(m_outstanding_count == total_outstanding);
+    assert(m_outstanding_count == m_requestTable.size());
 
     if (m_outstanding_count > 0) {
         // If there are still outstanding requests, keep checking
@@ -159,16 +144,30 @@ void Sequencer::resetStats()
     }
 }
 
-// Insert the request on the correct request table.  Return true if
-// the entry was already present.
+static bool
+isWriteRequestType(RubyRequestType type)
+{
+    return (type == RubyRequestType_ST) ||
+           (type == RubyRequestType_RMW_Read) ||
+           (type == RubyRequestType_RMW_Write) ||
+           (type == RubyRequestType_Load_Linked) ||
+           (type == RubyRequestType_Store_Conditional) ||
+           (type == RubyRequestType_Locked_RMW_Read) ||
+           (type == RubyRequestType_Locked_RMW_Write) ||
+           (type == RubyRequestType_FLUSH);
+}
+
+// Insert the request in the request table. Returns Aliased if the line
+// already has an outstanding request the new one cannot join, and
+// Issued if it was merged into an outstanding load and therefore needs
+// no Ruby request of its own.
 RequestStatus
 Sequencer::insertRequest(PacketPtr pkt, RubyRequestType request_type)
 {
-    assert(m_outstanding_count ==
-        (m_writeRequestTable.size() + m_readRequestTable.size()));
+    assert(m_outstanding_count == m_requestTable.size());
 
     // See if we should schedule a deadlock check
-    if (!deadlockCheckEvent.scheduled() &&
+    if (m_deadlock_check && !deadlockCheckEvent.scheduled() &&
         drainState() != DrainState::Draining) {
         schedule(deadlockCheckEvent, clockEdge(m_deadlock_threshold));
     }
@@ -184,73 +183,67 @@ Sequencer::insertRequest(PacketPtr pkt, RubyRequestType request_type)
         return RequestStatus_Aliased;
     }
 
-    // Create a default entry, mapping the address to NULL, the cast is
-    // there to make gcc 4.4 happy
-    RequestTable::value_type default_entry(line_addr,
-                                           (SequencerRequest*) NULL);
-
-    if ((request_type == RubyRequestType_ST) ||
-        (request_type == RubyRequestType_RMW_Read) ||
-        (request_type == RubyRequestType_RMW_Write) ||
-        (request_type == RubyRequestType_Load_Linked) ||
-        (request_type == RubyRequestType_Store_Conditional) ||
-        (request_type == RubyRequestType_Locked_RMW_Read) ||
-        (request_type == RubyRequestType_Locked_RMW_Write) ||
-        (request_type == RubyRequestType_FLUSH)) {
-
-        // Check if there is any outstanding read request for the same
-        // cache line.
-        if (m_readRequestTable.count(line_addr) > 0) {
-            m_store_waiting_on_load++;
-            return RequestStatus_Aliased;
-        }
-
-        pair<RequestTable::iterator, bool> r =
-            m_writeRequestTable.insert(default_entry);
-        if (r.second) {
-            RequestTable::iterator i = r.first;
-            i->second = new SequencerRequest(pkt, request_type, curCycle());
-            m_outstanding_count++;
-        } else {
-          // There is an outstanding write request for the cache line
-          m_store_waiting_on_store++;
-          return RequestStatus_Aliased;
-        }
-    } else {
-        // Check if there is any outstanding write request for the same
-        // cache line.
-        if (m_writeRequestTable.count(line_addr) > 0) {
+    SequencerRequest* pending = m_requestTable.lookup(line_addr);
+    if (pending) {
+        bool pending_write = isWriteRequestType(pending->m_type);
+        if (isWriteRequestType(request_type)) {
+            // There is an outstanding request for the cache line
+            if (pending_write)
+                m_store_waiting_on_store++;
+            else
+                m_store_waiting_on_load++;
+        } else if (pending_write) {
             m_load_waiting_on_store++;
-            return RequestStatus_Aliased;
-        }
-
-        pair<RequestTable::iterator, bool> r =
-            m_readRequestTable.insert(default_entry);
-
-        if (r.second) {
-            RequestTable::iterator i = r.first;
-            i->second = new SequencerRequest(pkt, request_type, curCycle());
-            m_outstanding_count++;
+        } else if (coalesceLoad(pending, pkt, request_type)) {
+            return RequestStatus_Issued;
         } else {
-            // There is an outstanding read request for the cache line
             m_load_waiting_on_load++;
-            return RequestStatus_Aliased;
         }
+        return RequestStatus_Aliased;
     }
 
+    m_requestTable.allocate(line_addr);
+    *m_requestTable.lookup(line_addr) =
+        SequencerRequest(pkt, request_type, curCycle());
+    m_outstanding_count++;
+
     m_outstandReqHist.sample(m_outstanding_count);
-    assert(m_outstanding_count ==
-        (m_writeRequestTable.size() + m_readRequestTable.size()));
+    assert(m_outstanding_count == m_requestTable.size());
 
     return RequestStatus_Ready;
 }
 
+// Attach a load to an outstanding load of the same kind for the same
+// line, so it completes with that load's data instead of sending its own
+// request through the L1 controller.
+bool
+Sequencer::coalesceLoad(SequencerRequest* pending, PacketPtr pkt,
+                        RubyRequestType request_type)
+{
+    if (pending->m_type != request_type ||
+        pending->num_coalesced >= m_max_coalesced_loads) {
+        return false;
+    }
+
+    assert((request_type == RubyRequestType_LD) ||
+           (request_type == RubyRequestType_IFETCH));
+
+    DPRINTF(RubySequencer, "Coalescing %s 0x%x with pending 0x%x\n",
+            RubyRequestType_to_string(request_type), pkt->getAddr(),
+            pending->pkt->getAddr());
+
+    pending->coalesced_pkt[pending->num_coalesced] = pkt;
+    pending->coalesced_issue_time[pending->num_coalesced] = curCycle();
+    pending->num_coalesced++;
+    m_load_coalesced++;
+    return true;
+}
+
 void
 Sequencer::markRemoved()
 {
     m_outstanding_count--;
-    assert(m_outstanding_count ==
-           m_writeRequestTable.size() + m_readRequestTable.size());
+    assert(m_outstanding_count == m_requestTable.size());
 }
 
 void
@@ -364,24 +357,18 @@ Sequencer::writeCallback(Addr address, DataBlock& data,
                          const Cycles firstResponseTime)
 {
     assert(address == makeLineAddress(address));
-    assert(m_writeRequestTable.count(makeLineAddress(address)));
 
-    RequestTable::iterator i = m_writeRequestTable.find(address);
-    assert(i != m_writeRequestTable.end());
-    SequencerRequest* request = i->second;
+    // Free the slot before calling back, the CPU may reissue right away
+    SequencerRequest* entry = m_requestTable.lookup(address);
+    assert(entry);
+    SequencerRequest request = *entry;
 
-    m_writeRequestTable.erase(i);
+    m_requestTable.deallocate(address);
     markRemoved();
 
-    assert((request->m_type == RubyRequestType_ST) ||
-           (request->m_type == RubyRequestType_ATOMIC) ||
-           (request->m_type == RubyRequestType_RMW_Read) ||
-           (request->m_type == RubyRequestType_RMW_Write) ||
-           (request->m_type == RubyRequestType_Load_Linked) ||
-           (request->m_type == RubyRequestType_Store_Conditional) ||
-           (request->m_type == RubyRequestType_Locked_RMW_Read) ||
-           (request->m_type == RubyRequestType_Locked_RMW_Write) ||
-           (request->m_type == RubyRequestType_FLUSH));
+    assert((request.m_type == RubyRequestType_ATOMIC) ||
+           isWriteRequestType(request.m_type));
+    assert(request.num_coalesced == 0);
 
     //
     // For Alpha, properly handle LL, SC, and write requests with respect to
@@ -391,23 +378,23 @@ Sequencer::writeCallback(Addr address, DataBlock& data,
     //
     bool success = true;
     if (!m_runningGarnetStandalone)
-        success = handleLlsc(address, request);
+        success = handleLlsc(address, &request);
 
     // Handle SLICC block_on behavior for Locked_RMW accesses. NOTE: the
     // address variable here is assumed to be a line address, so when
     // blocking buffers, must check line addresses.
-    if (request->m_type == RubyRequestType_Locked_RMW_Read) {
+    if (request.m_type == RubyRequestType_Locked_RMW_Read) {
         // blockOnQueue blocks all first-level cache controller queues
         // waiting on memory accesses for the specified address that go to
         // the specified queue. In this case, a Locked_RMW_Write must go to
         // the mandatory_q before unblocking the first-level controller.
         // This will block standard loads, stores, ifetches, etc.
         m_controller->blockOnQueue(address, m_mandatory_q_ptr);
-    } else if (request->m_type == RubyRequestType_Locked_RMW_Write) {
+    } else if (request.m_type == RubyRequestType_Locked_RMW_Write) {
         m_controller->unblock(address);
     }
 
-    hitCallback(request, data, success, mach, externalHit,
+    hitCallback(&request, data, success, mach, externalHit,
                 initialRequestTime, forwardRequestTime, firstResponseTime);
 }
 
@@ -419,20 +406,28 @@ Sequencer::readCallback(Addr address, DataBlock& data,
                         Cycles firstResponseTime)
 {
     assert(address == makeLineAddress(address));
-    assert(m_readRequestTable.count(makeLineAddress(address)));
 
-    RequestTable::iterator i = m_readRequestTable.find(address);
-    assert(i != m_readRequestTable.end());
-    SequencerRequest* request = i->second;
+    // Free the slot before calling back, the CPU may reissue right away
+    SequencerRequest* entry = m_requestTable.lookup(address);
+    assert(entry);
+    SequencerRequest request = *entry;
 
-    m_readRequestTable.erase(i);
+    m_requestTable.deallocate(address);
     markRemoved();
 
-    assert((request->m_type == RubyRequestType_LD) ||
-           (request->m_type == RubyRequestType_IFETCH));
+    assert((request.m_type == RubyRequestType_LD) ||
+           (request.m_type == RubyRequestType_IFETCH));
 
-    hitCallback(request, data, true, mach, externalHit,
+    hitCallback(&request, data, true, mach, externalHit,
                 initialRequestTime, forwardRequestTime, firstResponseTime);
+
+    for (int i = 0; i < request.num_coalesced; i++) {
+        SequencerRequest merged(request.coalesced_pkt[i], request.m_type,
+                                request.coalesced_issue_time[i]);
+        hitCallback(&merged, data, true, mach, externalHit,
+                    initialRequestTime, forwardRequestTime,
+                    firstResponseTime);
+    }
 }
 
 void
@@ -508,8 +503,6 @@ Sequencer::hitCallback(SequencerRequest* srequest, DataBlock& data,
         testerSenderState->subBlock.mergeFrom(data);
     }
 
-    delete srequest;
-
     RubySystem *rs = m_ruby_system;
     if (RubySystem::getWarmupEnabled()) {
         assert(pkt->req);
@@ -528,7 +521,7 @@ Sequencer::hitCallback(SequencerRequest* srequest, DataBlock& data,
 bool
 Sequencer::empty() const
 {
-    return m_writeRequestTable.empty() && m_readRequestTable.empty();
+    return m_requestTable.size() == 0;
 }
 
 RequestStatus
@@ -638,19 +631,23 @@ Sequencer::issueRequest(PacketPtr pkt, RubyRequestType secondary_type)
 
     // check if the packet has data as for example prefetch and flush
     // requests do not
-    std::shared_ptr<RubyRequest> msg =
-        std::make_shared<RubyRequest>(clockEdge(), pkt->getAddr(),
-                                      pkt->isFlush() ?
-                                      nullptr : pkt->getPtr<uint8_t>(),
-                                      pkt->getSize(), pc, secondary_type,
-                                      RubyAccessMode_Supervisor, pkt,
-                                      PrefetchBit_No, proc_id, core_id);
+    RefCountingPtr<RubyRequest> msg =
+        new RubyRequest(clockEdge(), pkt->getAddr(),
+                        pkt->isFlush() ? nullptr : pkt->getPtr<uint8_t>(),
+                        pkt->getSize(), pc, secondary_type,
+                        RubyAccessMode_Supervisor, pkt,
+                        PrefetchBit_No, proc_id, core_id);
 
     DPRINTFR(ProtocolTrace, "%15s %3s %10s%20s %6s>%-6s %#x %s\n",
             curTick(), m_version, "Seq", "Begin", "", "",
             printAddress(msg->getPhysicalAddress()),
             RubyRequestType_to_string(secondary_type));
 
+    Profiler *profiler = m_ruby_system->getProfiler();
+    if (profiler->getHotLines()) {
+        profiler->addAddressTraceSample(*msg, m_version);
+    }
+
     // The Sequencer currently assesses instruction and data cache hit latency
     // for the top-level caches at the beginning of a memory access.
     // TODO: Eventually, this latency should be moved to represent the actual
@@ -670,29 +667,18 @@ Sequencer::issueRequest(PacketPtr pkt, RubyRequestType secondary_type)
     m_mandatory_q_ptr->enqueue(msg, clockEdge(), cyclesToTicks(latency));
 }
 
-template <class KEY, class VALUE>
-std::ostream &
-operator<<(ostream &out, const std::unordered_map<KEY, VALUE> &map)
-{
-    auto i = map.begin();
-    auto end = map.end();
-
-    out << "[";
-    for (; i != end; ++i)
-        out << " " << i->first << "=" << i->second;
-    out << " ]";
-
-    return out;
-}
-
 void
 Sequencer::print(ostream& out) const
 {
     out << "[Sequencer: " << m_version
         << ", outstanding requests: " << m_outstanding_count
-        << ", read request table: " << m_readRequestTable
-        << ", write request table: " << m_writeRequestTable
-        << "]";
+        << ", request table: [";
+    m_requestTable.forEachEntry(
+        [&](Addr line_addr, const SequencerRequest& request) {
+        out << " " << line_addr << "="
+            << RubyRequestType_to_string(request.m_type);
+    });
+    out << " ]]";
 }
 
 // this can be called from setState whenever coherence permissions are
@@ -740,6 +726,10 @@ Sequencer::regStats()
         .name(name() + ".load_waiting_on_store")
         .desc("Number of times a load aliased with a pending store")
         .flags(Stats::nozero);
+    m_load_coalesced
+        .name(name() + ".load_coalesced")
+        .desc("Number of loads merged into a pending load")
+        .flags(Stats::nozero);
 
     // These statistical variables are not for display.
     // The profiler will collate these across different
@@ -30,25 +30,41 @@
 #define __MEM_RUBY_SYSTEM_SEQUENCER_HH__
 
 #include <iostream>
-#include <unordered_map>
 
 #include "mem/protocol/MachineType.hh"
 #include "mem/protocol/RubyRequestType.hh"
 #include "mem/protocol/SequencerRequestType.hh"
 #include "mem/ruby/common/Address.hh"
 #include "mem/ruby/structures/CacheMemory.hh"
+#include "mem/ruby/structures/TBETable.hh"
 #include "mem/ruby/system/RubyPort.hh"
 #include "params/RubySequencer.hh"
 
+// Upper bound on max_coalesced_loads; the merged loads are kept inline
+// in the request slot so the table never allocates.
+const int SEQUENCER_MAX_COALESCED_LOADS = 8;
+
 struct SequencerRequest
 {
     PacketPtr pkt;
     RubyRequestType m_type;
     Cycles issue_time;
 
+    // Same-line loads that were merged into this request and are
+    // completed with its data
+    int num_coalesced;
+    PacketPtr coalesced_pkt[SEQUENCER_MAX_COALESCED_LOADS];
+    Cycles coalesced_issue_time[SEQUENCER_MAX_COALESCED_LOADS];
+
+    SequencerRequest()
+        : pkt(NULL), m_type(RubyRequestType_NULL), issue_time(0),
+          num_coalesced(0)
+    {}
+
     SequencerRequest(PacketPtr _pkt, RubyRequestType _m_type,
                      Cycles _issue_time)
-        : pkt(_pkt), m_type(_m_type), issue_time(_issue_time)
+        : pkt(_pkt), m_type(_m_type), issue_time(_issue_time),
+          num_coalesced(0)
     {}
 };
 
@@ -93,6 +109,10 @@ class Sequencer : public RubyPort
     void descheduleDeadlockEvent()
     { deschedule(deadlockCheckEvent); }
 
+    // Stop checking for deadlocks, for when the requests are not
+    // expected to complete, e.g. while the network replays a trace
+    void disableDeadlockCheck() { m_deadlock_check = false; }
+
     void print(std::ostream& out) const;
     void checkCoherence(Addr address);
 
@@ -166,6 +186,8 @@ class Sequencer : public RubyPort
                            Cycles completionTime);
 
     RequestStatus insertRequest(PacketPtr pkt, RubyRequestType request_type);
+    bool coalesceLoad(SequencerRequest* pending, PacketPtr pkt,
+                      RubyRequestType request_type);
     bool handleLlsc(Addr address, SequencerRequest* request);
 
     // Private copy constructor and assignment operator
@@ -175,6 +197,7 @@ class Sequencer : public RubyPort
   private:
     int m_max_outstanding_requests;
     Cycles m_deadlock_threshold;
+    bool m_deadlock_check;
 
     CacheMemory* m_dataCache_ptr;
     CacheMemory* m_instCache_ptr;
@@ -186,11 +209,14 @@ class Sequencer : public RubyPort
     Cycles m_data_cache_hit_latency;
     Cycles m_inst_cache_hit_latency;
 
-    typedef std::unordered_map<Addr, SequencerRequest*> RequestTable;
-    RequestTable m_writeRequestTable;
-    RequestTable m_readRequestTable;
-    // Global outstanding request count, across all request tables
+    // Outstanding reads and writes, at most one per line. Slots are
+    // preallocated for m_max_outstanding_requests requests.
+    typedef TBETable<SequencerRequest> RequestTable;
+    RequestTable m_requestTable;
+    // Global outstanding request count, i.e., requests issued to Ruby
     int m_outstanding_count;
+    // Loads merged into each outstanding load, 0 disables coalescing
+    int m_max_coalesced_loads;
     bool m_deadlock_check_scheduled;
 
     //! Counters for recording aliasing information.
@@ -198,6 +224,7 @@ class Sequencer : public RubyPort
     Stats::Scalar m_store_waiting_on_store;
     Stats::Scalar m_load_waiting_on_store;
     Stats::Scalar m_load_waiting_on_load;
+    Stats::Scalar m_load_coalesced;
 
     int m_coreId;
 
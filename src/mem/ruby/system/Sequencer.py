@@ -71,6 +71,8 @@ class RubySequencer(RubyPort):
    dcache_hit_latency = Param.Cycles(1, "Data cache hit latency")
    max_outstanding_requests = Param.Int(16,
        "max requests (incl. prefetches) outstanding")
+   max_coalesced_loads = Param.Int(0,
+       "max same-line loads merged into an outstanding load (0 disables)")
    deadlock_threshold = Param.Cycles(500000,
        "max outstanding cycles for a request before deadlock/livelock declared")
    garnet_standalone = Param.Bool(False, "")
@@ -64,6 +64,10 @@ def main(args=None):
                       help="print traceback on error")
     parser.add_option("-q", "--quiet",
                       help="don't print messages")
+    parser.add_option("--dispatch", default="switch",
+                      choices=["switch", "table"],
+                      help="transition dispatch code to generate "
+                           "(switch or table)")
     opts,files = parser.parse_args(args=args)
 
     if len(files) != 1:
@@ -75,7 +79,8 @@ def main(args=None):
     output("SLICC v0.4")
     output("Parsing...")
 
-    slicc = SLICC(files[0], verbose=True, debug=opts.debug, traceback=opts.tb)
+    slicc = SLICC(files[0], verbose=True, debug=opts.debug, traceback=opts.tb,
+                  dispatch=opts.dispatch)
 
     if opts.print_files:
         for i in sorted(slicc.files()):
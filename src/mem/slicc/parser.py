@@ -38,10 +38,14 @@ import slicc.util as util
 from slicc.symbols import SymbolTable
 
 class SLICC(Grammar):
-    def __init__(self, filename, base_dir, verbose=False, traceback=False, **kwargs):
+    def __init__(self, filename, base_dir, verbose=False, traceback=False,
+                 dispatch="switch", **kwargs):
         self.protocol = None
         self.traceback = traceback
         self.verbose = verbose
+        if dispatch not in ("switch", "table"):
+            sys.exit("Unknown SLICC transition dispatch: %s" % dispatch)
+        self.dispatch = dispatch
         self.symtab = SymbolTable(self)
         self.base_dir = base_dir
 
@@ -209,6 +209,123 @@ class StateMachine(Symbol):
                 in_msg_bufs[buf_name].append(port)
         return port_to_buf_map, in_msg_bufs, msg_bufs
 
+    def getTransitionCases(self):
+        '''Return the unique transition code blocks, each mapped to the
+        list of (state, event) pairs that share it'''
+
+        ident = self.ident
+
+        # This map will allow suppress generating duplicate code
+        cases = orderdict()
+
+        for trans in self.transitions:
+
+            case = self.symtab.codeFormatter()
+            # Only set next_state if it changes
+            if trans.state != trans.nextState:
+                if trans.nextState.isWildcard():
+                    # When * is encountered as an end state of a transition,
+                    # the next state is determined by calling the
+                    # machine-specific getNextState function. The next state
+                    # is determined before any actions of the transition
+                    # execute, and therefore the next state calculation cannot
+                    # depend on any of the transitionactions.
+                    case('next_state = getNextState(addr);')
+                else:
+                    ns_ident = trans.nextState.ident
+                    case('next_state = ${ident}_State_${ns_ident};')
+
+            actions = trans.actions
+            request_types = trans.request_types
+
+            # Check for resources
+            case_sorter = []
+            res = trans.resources
+            for key,val in res.iteritems():
+                val = '''
+if (!%s.areNSlotsAvailable(%s, clockEdge()))
+    return TransitionResult_ResourceStall;
+''' % (key.code, val)
+                case_sorter.append(val)
+
+            # Check all of the request_types for resource constraints
+            for request_type in request_types:
+                val = '''
+if (!checkResourceAvailable(%s_RequestType_%s, addr)) {
+    return TransitionResult_ResourceStall;
+}
+''' % (self.ident, request_type.ident)
+                case_sorter.append(val)
+
+            # Emit the code sequences in a sorted order.  This makes the
+            # output deterministic (without this the output order can vary
+            # since Map's keys() on a vector of pointers is not deterministic
+            for c in sorted(case_sorter):
+                case("$c")
+
+            # Record access types for this transition
+            for request_type in request_types:
+                case('recordRequestType('
+                     '${ident}_RequestType_${{request_type.ident}}, addr);')
+
+            # Figure out if we stall
+            stall = False
+            for action in actions:
+                if action.ident == "z_stall":
+                    stall = True
+                    break
+
+            if stall:
+                case('return TransitionResult_ProtocolStall;')
+            else:
+                if self.TBEType != None and self.EntryType != None:
+                    for action in actions:
+                        case('${{action.ident}}(m_tbe_ptr, '
+                             'm_cache_entry_ptr, addr);')
+                elif self.TBEType != None:
+                    for action in actions:
+                        case('${{action.ident}}(m_tbe_ptr, addr);')
+                elif self.EntryType != None:
+                    for action in actions:
+                        case('${{action.ident}}(m_cache_entry_ptr, addr);')
+                else:
+                    for action in actions:
+                        case('${{action.ident}}(addr);')
+                case('return TransitionResult_Valid;')
+
+            case = str(case)
+
+            # Look to see if this transition code is unique.
+            if case not in cases:
+                cases[case] = []
+
+            cases[case].append((trans.state.ident, trans.event.ident))
+
+        return cases
+
+    def transitionBodyParams(self):
+        '''Parameter list shared by the generated transition bodies'''
+
+        params = [ "%s_State& next_state" % self.ident ]
+        if self.TBEType != None:
+            params.append("%s*& m_tbe_ptr" % self.TBEType.c_ident)
+        if self.EntryType != None:
+            params.append("%s*& m_cache_entry_ptr" % self.EntryType.c_ident)
+        params.append("Addr addr")
+        return ", ".join(params)
+
+    def actionQualifier(self, action):
+        '''With table dispatch the transition bodies live next to the
+        actions, so mark the short actions inline to fold them into the
+        bodies that call them'''
+
+        if self.symtab.slicc.dispatch != "table":
+            return ""
+        lines = [ l for l in action["c_code"].splitlines() if l.strip() ]
+        if len(lines) <= 3:
+            return "inline "
+        return ""
+
     def writeCodeFiles(self, path, includes):
         self.printControllerPython(path)
         self.printControllerHH(path)
@@ -311,6 +428,18 @@ class $c_ident : public AbstractController
     void recordCacheTrace(int cntrl, CacheRecorder* tr);
     Sequencer* getCPUSequencer() const;
     GPUCoalescer* getGPUCoalescer() const;
+''')
+
+        if self.getWarmupStates():
+            code('''
+    bool installCacheBlock(Addr addr, RubyRequestType type,
+                           const DataBlock& data);
+''')
+
+        if self.getSharerParams():
+            code('    bool tracksSharers() const;')
+
+        code('''
 
     int functionalWriteBuffers(PacketPtr&);
 
@@ -363,6 +492,23 @@ TransitionResult doTransitionWorker(${ident}_Event event,
 
         code('''
                                     Addr addr);
+''')
+
+        if self.symtab.slicc.dispatch == "table":
+            # One member per unique transition body, indexed by a dense
+            # [state][event] table in place of the switch statement
+            code('''
+
+typedef TransitionResult
+    (${ident}_Controller::*TransitionFunc)(${{self.transitionBodyParams()}});
+static const TransitionFunc
+    s_transitionTable[${ident}_State_NUM][${ident}_Event_NUM];
+''')
+            for i in range(len(self.getTransitionCases())):
+                code('TransitionResult transitionBody$i('
+                     '${{self.transitionBodyParams()}});')
+
+        code('''
 
 int m_counters[${ident}_State_NUM][${ident}_Event_NUM];
 int m_event_counters[${ident}_Event_NUM];
@@ -814,6 +960,7 @@ $c_ident::countTransition(${ident}_State state, ${ident}_Event event)
     assert(m_possible[state][event]);
     m_counters[state][event]++;
     m_event_counters[event]++;
+    m_transitions++;
 }
 void
 $c_ident::possibleTransition(${ident}_State state,
@@ -931,8 +1078,23 @@ $c_ident::recordCacheTrace(int cntrl, CacheRecorder* tr)
                 code('m_${{param.ident}}_ptr->recordCacheContents(cntrl, tr);')
 
         code.dedent()
-        code('''
+        code('}')
+
+        if self.getWarmupStates():
+            self.printInstallCacheBlock(code)
+
+        sharer_params = self.getSharerParams()
+        if sharer_params:
+            cond = " || ".join("m_%s" % param for param in sharer_params)
+            code('''
+bool
+$c_ident::tracksSharers() const
+{
+    return $cond;
 }
+''')
+
+        code('''
 
 // Actions
 ''')
@@ -943,7 +1105,7 @@ $c_ident::recordCacheTrace(int cntrl, CacheRecorder* tr)
 
                 code('''
 /** \\brief ${{action.desc}} */
-void
+${{self.actionQualifier(action)}}void
 $c_ident::${{action.ident}}(${{self.TBEType.c_ident}}*& m_tbe_ptr, ${{self.EntryType.c_ident}}*& m_cache_entry_ptr, Addr addr)
 {
     DPRINTF(RubyGenerated, "executing ${{action.ident}}\\n");
@@ -964,7 +1126,7 @@ $c_ident::${{action.ident}}(${{self.TBEType.c_ident}}*& m_tbe_ptr, ${{self.Entry
 
                 code('''
 /** \\brief ${{action.desc}} */
-void
+${{self.actionQualifier(action)}}void
 $c_ident::${{action.ident}}(${{self.TBEType.c_ident}}*& m_tbe_ptr, Addr addr)
 {
     DPRINTF(RubyGenerated, "executing ${{action.ident}}\\n");
@@ -979,7 +1141,7 @@ $c_ident::${{action.ident}}(${{self.TBEType.c_ident}}*& m_tbe_ptr, Addr addr)
 
                 code('''
 /** \\brief ${{action.desc}} */
-void
+${{self.actionQualifier(action)}}void
 $c_ident::${{action.ident}}(${{self.EntryType.c_ident}}*& m_cache_entry_ptr, Addr addr)
 {
     DPRINTF(RubyGenerated, "executing ${{action.ident}}\\n");
@@ -994,7 +1156,7 @@ $c_ident::${{action.ident}}(${{self.EntryType.c_ident}}*& m_cache_entry_ptr, Add
 
                 code('''
 /** \\brief ${{action.desc}} */
-void
+${{self.actionQualifier(action)}}void
 $c_ident::${{action.ident}}(Addr addr)
 {
     DPRINTF(RubyGenerated, "executing ${{action.ident}}\\n");
@@ -1002,6 +1164,9 @@ $c_ident::${{action.ident}}(Addr addr)
 }
 
 ''')
+        if self.symtab.slicc.dispatch == "table":
+            self.printTransitionTable(code)
+
         for func in self.functions:
             code(func.generateCode())
 
@@ -1031,6 +1196,171 @@ $c_ident::functionalWriteBuffers(PacketPtr& pkt)
 
         code.write(path, "%s.cc" % c_ident)
 
+    def getWarmupStates(self):
+        '''Return the stable state blocks recorded by each request type
+        are installed in, as marked with the warmup pair of the states'''
+
+        warmup_states = orderdict()
+        for state in self.states.itervalues():
+            if "warmup" not in state:
+                continue
+            for request_type in state["warmup"].split(","):
+                request_type = request_type.strip()
+                if request_type not in ("LD", "IFETCH", "ST"):
+                    state.error("Unknown warmup request type: %s" %
+                                request_type)
+                if request_type in warmup_states:
+                    state.error("Duplicate warmup state for %s" %
+                                request_type)
+                warmup_states[request_type] = state
+
+        if warmup_states and self.EntryType == None:
+            self.error("Warmup states need a cache entry type")
+        return warmup_states
+
+    def getSharerParams(self):
+        '''Return the bool parameters enabling the state the machine
+        keeps about the blocks in other caches, as listed in its
+        tracks_sharers pair'''
+
+        if "tracks_sharers" not in self:
+            return []
+
+        params = [ param.strip() for param in
+                   self["tracks_sharers"].split(",") ]
+        bool_params = [ param.ident for param in self.config_parameters
+                        if param.type_ast.type.ident == "bool" ]
+        for param in params:
+            if param not in bool_params:
+                self.error("Unknown bool parameter in tracks_sharers: %s" %
+                           param)
+        return params
+
+    def printInstallCacheBlock(self, code):
+        '''Output the function installing recorded blocks directly in
+        the caches of the controller'''
+
+        ident = self.ident
+        c_ident = "%s_Controller" % self.ident
+        entry = self.EntryType.c_ident
+
+        code('''
+bool
+$c_ident::installCacheBlock(Addr addr, RubyRequestType type,
+                           const DataBlock& data)
+{
+    ${ident}_State state;
+    switch (type) {
+''')
+        for request_type, state in self.getWarmupStates().iteritems():
+            code('''
+      case RubyRequestType_${request_type}:
+        state = ${ident}_State_${{state.ident}};
+        break;
+''')
+
+        caches = [ "m_%s_ptr" % param.ident for param in self.config_parameters
+                   if param.type_ast.type.ident == "CacheMemory" ]
+        code('''
+      default:
+        return false;
+    }
+
+    CacheMemory *caches[] = { ${{", ".join(caches)}} };
+    for (CacheMemory *cache : caches) {
+        // An earlier record brought the block in already
+        if (cache->isTagPresent(addr))
+            return true;
+    }
+
+    // Instruction fetches prefer the instruction caches, data stays out
+    // of them
+    CacheMemory *target = NULL;
+    for (int pass = type == RubyRequestType_IFETCH ? 0 : 1;
+         pass < 2 && target == NULL; pass++) {
+        for (CacheMemory *cache : caches) {
+            if (cache->isInstructionOnly() == (pass == 0) &&
+                cache->cacheAvail(addr)) {
+                target = cache;
+                break;
+            }
+        }
+    }
+    if (target == NULL)
+        return false;
+
+    $entry* m_cache_entry_ptr = new $entry;
+    target->allocate(addr, m_cache_entry_ptr);
+''')
+        code.indent()
+        if "DataBlk" in self.EntryType.data_members:
+            code('m_cache_entry_ptr->getDataBlk() = data;')
+        if self.TBEType != None:
+            code('${{self.TBEType.c_ident}}* m_tbe_ptr = NULL;')
+            code('setState(m_tbe_ptr, m_cache_entry_ptr, addr, state);')
+        else:
+            code('setState(m_cache_entry_ptr, addr, state);')
+        code('setAccessPermission(m_cache_entry_ptr, addr, state);')
+        code('return true;')
+        code.dedent()
+        code('}')
+
+    def printTransitionTable(self, code):
+        '''Output one function per unique transition body and the
+        [state][event] table used to dispatch to them'''
+
+        ident = self.ident
+        c_ident = "%s_Controller" % self.ident
+        params = self.transitionBodyParams()
+
+        # Remember which body handles each (state, event) pair
+        cases = self.getTransitionCases()
+        body_of = {}
+        for i,(case,transitions) in enumerate(cases.iteritems()):
+            code('''
+TransitionResult
+$c_ident::transitionBody$i($params)
+{''')
+            code.indent()
+            for state, event in transitions:
+                code('// ${ident}_State_${state}, ${ident}_Event_${event}')
+                body_of[(state, event)] = i
+            code('$case')
+            code.dedent()
+            code('}')
+            code()
+
+        code('''
+const $c_ident::TransitionFunc
+$c_ident::s_transitionTable[${ident}_State_NUM][${ident}_Event_NUM] = {''')
+        code.indent()
+        for state in self.states.itervalues():
+            code('{ // ${{state.ident}}')
+            code.indent()
+            for event in self.events.itervalues():
+                if (state.ident, event.ident) in body_of:
+                    i = body_of[(state.ident, event.ident)]
+                    code('&$c_ident::transitionBody$i, // ${{event.ident}}')
+                else:
+                    code('NULL, // ${{event.ident}}')
+            code.dedent()
+            code('},')
+        code.dedent()
+        code('};')
+        code()
+
+        # The table is laid out in declaration order, which has to be
+        # the order of the enumerations it is indexed with
+        code('''
+static_assert(${ident}_State_NUM == ${{len(self.states)}} &&
+              ${ident}_Event_NUM == ${{len(self.events)}},
+              "Transition table size does not match the enumerations");''')
+        for kind, symbols in (("State", self.states), ("Event", self.events)):
+            for i,symbol in enumerate(symbols.itervalues()):
+                code('static_assert(${ident}_${kind}_${{symbol.ident}} == $i, '
+                     '"Transition table out of ${kind} order");')
+        code()
+
     def printCWakeup(self, path, includes):
         '''Output the wakeup loop for the events'''
 
@@ -1086,6 +1416,7 @@ void
 ${ident}_Controller::wakeup()
 {
     int counter = 0;
+    m_wakeups++;
     while (true) {
         unsigned char rejected[${{len(msg_bufs)}}];
         memset(rejected, 0, sizeof(unsigned char)*${{len(msg_bufs)}});
@@ -1104,11 +1435,34 @@ ${ident}_Controller::wakeup()
         code.indent()
         code.indent()
 
+        # With table dispatch, sample each input buffer once per pass and
+        # skip the in_ports whose buffer has nothing ready.  Transitions
+        # that do not succeed leave the buffers untouched, and a successful
+        # one restarts the pass, so the bitmap stays valid for the pass.
+        ready_bitmap = self.symtab.slicc.dispatch == "table" and \
+                       len(msg_bufs) <= 64
+        if ready_bitmap:
+            code.indent()
+            code('uint64_t ready = 0;')
+            bufs = sorted((port_to_buf_map[ports[0]], buf_name)
+                          for buf_name, ports in in_msg_bufs.items())
+            for bit, buf_name in bufs:
+                code('if (${buf_name}->isReady(clockEdge()))')
+                code('    ready |= ULL(1) << $bit;')
+            code('''
+if (ready == 0)
+    break;
+''')
+            code.dedent()
+
         # InPorts
         #
         for port in self.in_ports:
             code.indent()
             code('// ${ident}InPort $port')
+            if ready_bitmap:
+                code('if (ready & (ULL(1) << ${{port_to_buf_map[port]}})) {')
+                code.indent()
             if port.pairs.has_key("rank"):
                 code('m_cur_in_port = ${{port.pairs["rank"]}};')
             else:
@@ -1125,6 +1479,9 @@ ${ident}_Controller::wakeup()
                 rejected[${{port_to_buf_map[port]}}]++;
             }
 ''')
+            if ready_bitmap:
+                code.dedent()
+                code('}')
             code.dedent()
             code('')
 
@@ -1299,102 +1656,44 @@ ${ident}_Controller::doTransitionWorker(${ident}_Event event,
         code('''
                                         Addr addr)
 {
-    switch(HASH_FUN(state, event)) {
 ''')
 
-        # This map will allow suppress generating duplicate code
-        cases = orderdict()
-
-        for trans in self.transitions:
-            case_string = "%s_State_%s, %s_Event_%s" % \
-                (self.ident, trans.state.ident, self.ident, trans.event.ident)
-
-            case = self.symtab.codeFormatter()
-            # Only set next_state if it changes
-            if trans.state != trans.nextState:
-                if trans.nextState.isWildcard():
-                    # When * is encountered as an end state of a transition,
-                    # the next state is determined by calling the
-                    # machine-specific getNextState function. The next state
-                    # is determined before any actions of the transition
-                    # execute, and therefore the next state calculation cannot
-                    # depend on any of the transitionactions.
-                    case('next_state = getNextState(addr);')
-                else:
-                    ns_ident = trans.nextState.ident
-                    case('next_state = ${ident}_State_${ns_ident};')
-
-            actions = trans.actions
-            request_types = trans.request_types
-
-            # Check for resources
-            case_sorter = []
-            res = trans.resources
-            for key,val in res.iteritems():
-                val = '''
-if (!%s.areNSlotsAvailable(%s, clockEdge()))
-    return TransitionResult_ResourceStall;
-''' % (key.code, val)
-                case_sorter.append(val)
+        if self.symtab.slicc.dispatch == "table":
+            args = [ "next_state" ]
+            if self.TBEType != None:
+                args.append("m_tbe_ptr")
+            if self.EntryType != None:
+                args.append("m_cache_entry_ptr")
+            args.append("addr")
+            args = ", ".join(args)
+            code('''
+    TransitionFunc body = s_transitionTable[state][event];
+    if (body == NULL) {
+        panic("Invalid transition\\n"
+              "%s time: %d addr: %s event: %s state: %s\\n",
+              name(), curCycle(), addr, event, state);
+    }
 
-            # Check all of the request_types for resource constraints
-            for request_type in request_types:
-                val = '''
-if (!checkResourceAvailable(%s_RequestType_%s, addr)) {
-    return TransitionResult_ResourceStall;
+    return (this->*body)($args);
 }
-''' % (self.ident, request_type.ident)
-                case_sorter.append(val)
-
-            # Emit the code sequences in a sorted order.  This makes the
-            # output deterministic (without this the output order can vary
-            # since Map's keys() on a vector of pointers is not deterministic
-            for c in sorted(case_sorter):
-                case("$c")
-
-            # Record access types for this transition
-            for request_type in request_types:
-                case('recordRequestType(${ident}_RequestType_${{request_type.ident}}, addr);')
-
-            # Figure out if we stall
-            stall = False
-            for action in actions:
-                if action.ident == "z_stall":
-                    stall = True
-                    break
-
-            if stall:
-                case('return TransitionResult_ProtocolStall;')
-            else:
-                if self.TBEType != None and self.EntryType != None:
-                    for action in actions:
-                        case('${{action.ident}}(m_tbe_ptr, m_cache_entry_ptr, addr);')
-                elif self.TBEType != None:
-                    for action in actions:
-                        case('${{action.ident}}(m_tbe_ptr, addr);')
-                elif self.EntryType != None:
-                    for action in actions:
-                        case('${{action.ident}}(m_cache_entry_ptr, addr);')
-                else:
-                    for action in actions:
-                        case('${{action.ident}}(addr);')
-                case('return TransitionResult_Valid;')
-
-            case = str(case)
+''')
+            code.write(path, "%s_Transitions.cc" % self.ident)
+            return
 
-            # Look to see if this transition code is unique.
-            if case not in cases:
-                cases[case] = []
+        code('''
+    switch(HASH_FUN(state, event)) {
+''')
 
-            cases[case].append(case_string)
+        cases = self.getTransitionCases()
 
         # Walk through all of the unique code blocks and spit out the
         # corresponding case statement elements
         for case,transitions in cases.iteritems():
             # Iterative over all the multiple transitions that share
             # the same code
-            for trans in transitions:
-                code('  case HASH_FUN($trans):')
+            for state, event in transitions:
+                code('  case HASH_FUN(${ident}_State_${state}, '
+                     '${ident}_Event_${event}):')
             code('    $case\n')
 
         code('''
@@ -284,13 +284,25 @@ $klass ${{self.c_ident}}$parent
             code.dedent()
             code('}')
 
-        # create a clone member
+        # create a clone member and route allocations through the pool
         if self.isMessage:
             code('''
 MsgPtr
 clone() const
 {
-     return std::shared_ptr<Message>(new ${{self.c_ident}}(*this));
+     return MsgPtr(new ${{self.c_ident}}(*this));
+}
+
+static void *
+operator new(size_t size)
+{
+    return MessagePool<${{self.c_ident}}>::allocate(size);
+}
+
+static void
+operator delete(void *p, size_t size)
+{
+    MessagePool<${{self.c_ident}}>::release(p, size);
 }
 ''')
         else:
@@ -38,6 +38,8 @@ from SimpleMemory import *
 class MemoryMode(Enum): vals = ['invalid', 'atomic', 'timing',
                                 'atomic_noncaching']
 
+class MemoryStoreFormat(Enum): vals = ['gzip', 'chunked']
+
 class System(MemObject):
     type = 'System'
     cxx_header = "sim/system.hh"
@@ -65,6 +67,54 @@ class System(MemObject):
     mmap_using_noreserve = Param.Bool(False, "mmap the backing store " \
                                           "without reserving swap")
 
+    # Large memories put a lot of pressure on the host TLB. Huge pages
+    # are taken from the host hugetlbfs pool if possible, and
+    # otherwise requested as transparent huge pages.
+    mmap_using_hugepages = Param.Bool(False, "mmap the backing store " \
+                                          "using huge pages")
+
+    # The backing store can be placed in a named shared memory object
+    # (e.g. /dev/shm/<name> on Linux) rather than in anonymous memory,
+    # enabling other processes to access the memory image. The name is
+    # a single path component, optionally preceded by a '/'. The object
+    # starts out empty, and is removed on exit unless asked to keep it.
+    shared_backstore = Param.String("", "shared memory object name for " \
+                                        "the backing store")
+    shared_backstore_keep = Param.Bool(False, "keep the shared backing " \
+                                              "store object on exit")
+
+    # On multi-socket hosts, the backing store of each memory can be
+    # bound to the host NUMA node of the thread running its event
+    # queue. The list is indexed by event queue, and a negative node
+    # leaves the placement to the host.
+    backing_store_numa_nodes = VectorParam.Int([], "host NUMA node for " \
+                                                   "each event queue")
+
+    # The memory image is checkpointed either as a single gzip stream,
+    # or as independently compressed chunks that are written and read
+    # in parallel, with all-zero pages left out. A compression level of
+    # 0 keeps the chunked image uncompressed and page aligned, allowing
+    # it to be mapped on restore and faulted in lazily. The checkpoint
+    # file then has to stay unchanged for as long as the simulation
+    # runs.
+    store_format = Param.MemoryStoreFormat('gzip', "format used when " \
+                                               "checkpointing memory")
+    store_chunk_size = Param.MemorySize('1MB', "size of each independently " \
+                                            "compressed chunk")
+    store_compression_level = Param.Int(1, "zlib compression level of " \
+                                            "chunked stores, 0 to disable")
+    store_threads = Param.Unsigned(0, "host threads for chunked stores, " \
+                                      "0 to use all host cores")
+
+    # Chunked stores can be written as deltas, only holding the pages
+    # written since the previous checkpoint (or the checkpoint we
+    # restored from), and referring to it for the rest. Restoring a
+    # delta transparently restores the chain it builds on. Note that
+    # writes that bypass the memory system, e.g. from KVM CPUs, are
+    # not seen by the dirty-page tracking.
+    store_delta = Param.Bool(False, "write memory checkpoints as deltas " \
+                                    "against the previous checkpoint")
+
     # The memory ranges are to be populated when creating the system
     # such that these can be passed from the I/O subsystem through an
     # I/O bridge or cache
@@ -90,7 +90,12 @@ System::System(Params *p)
       kernel(nullptr),
       loadAddrMask(p->load_addr_mask),
       loadAddrOffset(p->load_offset),
-      physmem(name() + ".physmem", p->memories, p->mmap_using_noreserve),
+      physmem(name() + ".physmem", p->memories, p->mmap_using_noreserve,
+              p->mmap_using_hugepages, p->shared_backstore,
+              p->shared_backstore_keep, p->backing_store_numa_nodes,
+              p->store_format, p->store_chunk_size,
+              p->store_compression_level, p->store_threads,
+              p->store_delta),
       memoryMode(p->mem_mode),
       _cacheLineSize(p->cache_line_size),
       workItemsBegin(0),
@@ -0,0 +1,254 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Authors: agent
+ */
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "base/cprintf.hh"
+#include "base/misc.hh"
+#include "mem/abstract_mem.hh"
+#include "mem/packet.hh"
+#include "mem/physical.hh"
+#include "mem/request.hh"
+#include "params/AbstractMemory.hh"
+#include "params/SrcClockDomain.hh"
+#include "params/VoltageDomain.hh"
+#include "sim/clock_domain.hh"
+#include "sim/eventq.hh"
+#include "sim/serialize.hh"
+#include "sim/sim_object.hh"
+#include "sim/voltage_domain.hh"
+#include "unittest/unittest.hh"
+
+using namespace std;
+
+// UnitTest::setCase keeps the pointer it is given, so hold on to the
+// case name until the next one is set
+static string caseName;
+
+static void
+setCase(const string &name)
+{
+    caseName = name;
+    UnitTest::setCase(caseName.c_str());
+}
+
+namespace {
+
+const uint64_t memSize = 1024 * 1024;
+
+// A memory that does nothing but own a backing store
+class TestMemory : public AbstractMemory
+{
+  public:
+    TestMemory(const Params *p) : AbstractMemory(p) { }
+};
+
+class NullResolver : public SimObjectResolver
+{
+  public:
+    SimObject *resolveSimObject(const string &name) { return NULL; }
+};
+
+ClockDomain *
+makeClockDomain()
+{
+    VoltageDomainParams *vd_params = new VoltageDomainParams;
+    vd_params->name = "voltage_domain";
+    vd_params->eventq_index = 0;
+    vd_params->voltage.push_back(1.0);
+
+    SrcClockDomainParams *cd_params = new SrcClockDomainParams;
+    cd_params->name = "clk_domain";
+    cd_params->eventq_index = 0;
+    cd_params->clock.push_back(1000);
+    cd_params->voltage_domain = vd_params->create();
+    cd_params->domain_id = -1;
+    cd_params->init_perf_level = 0;
+    return cd_params->create();
+}
+
+// Like all SimObjects, the memories live until the end of the test
+AbstractMemory *
+makeMemory(ClockDomain *clk_domain)
+{
+    AbstractMemoryParams *params = new AbstractMemoryParams;
+    params->name = "mem";
+    params->eventq_index = 0;
+    params->clk_domain = clk_domain;
+    params->default_p_state = Enums::UNDEFINED;
+    params->power_model = NULL;
+    params->range = AddrRange(0, memSize - 1);
+    params->null = false;
+    params->in_addr_map = true;
+    params->kvm_map = false;
+    params->conf_table_reported = false;
+    return new TestMemory(params);
+}
+
+// A physical memory with a single backing store, writing delta
+// checkpoints
+class TestStore
+{
+  public:
+    TestStore(ClockDomain *clk_domain, int compression_level)
+        : physmem("physmem", vector<AbstractMemory*>{
+                      makeMemory(clk_domain) },
+                  false, false, "", false, vector<int>(), Enums::chunked,
+                  8 * sysconf(_SC_PAGESIZE), compression_level, 1, true)
+    { }
+
+    void
+    write(Addr addr, uint8_t value, unsigned size)
+    {
+        vector<uint8_t> data(size, value);
+        Request req(addr, size, 0, 0);
+        Packet pkt(&req, MemCmd::WriteReq);
+        pkt.dataStatic(data.data());
+        physmem.functionalAccess(&pkt);
+    }
+
+    const uint8_t *
+    contents() const
+    {
+        return physmem.getBackingStore().front().pmem;
+    }
+
+    void
+    checkpoint(const string &dir)
+    {
+        mkdir(dir.c_str(), 0775);
+        CheckpointIn::setDir(dir);
+        ofstream cp(dir + "/" + CheckpointIn::baseFilename);
+        physmem.serializeSection(cp, "physmem");
+    }
+
+    void
+    restore(const string &dir)
+    {
+        NullResolver resolver;
+        CheckpointIn cp(dir, resolver);
+        physmem.unserializeSection(cp, "physmem");
+    }
+
+  private:
+    PhysicalMemory physmem;
+};
+
+uint64_t
+fileSize(const string &path)
+{
+    struct stat st;
+    return stat(path.c_str(), &st) ? 0 : st.st_size;
+}
+
+} // anonymous namespace
+
+int
+main()
+{
+    char tmpl[] = "/tmp/physmemdeltatestXXXXXX";
+    if (!mkdtemp(tmpl))
+        fatal("Can't create a temporary directory: %s\n", strerror(errno));
+    const string dir = tmpl;
+    const string store = "/physmem.store0.pmem";
+    vector<string> checkpoints;
+
+    // requests are stamped with the current tick
+    curEventQueue(getEventQueue(0));
+
+    ClockDomain *clk_domain = makeClockDomain();
+
+    // uncompressed stores are mapped lazily when restored, compressed
+    // ones are read in
+    for (int level : { 0, 6 }) {
+        const string base = csprintf("%s/cpt%d.0", dir, level);
+        const string delta = csprintf("%s/cpt%d.1", dir, level);
+        const string delta2 = csprintf("%s/cpt%d.2", dir, level);
+        checkpoints.insert(checkpoints.end(), { base, delta, delta2 });
+
+        setCase(csprintf("Base checkpoint, level %d", level));
+        TestStore mem(clk_domain, level);
+        mem.write(0x1000, 0xaa, 0x2000);
+        mem.write(0x40000, 0xbb, 100);
+        mem.write(memSize - 8, 0xcc, 8);
+        mem.checkpoint(base);
+        vector<uint8_t> base_contents(mem.contents(),
+                                      mem.contents() + memSize);
+
+        setCase(csprintf("Delta checkpoint, level %d", level));
+        // zeroing a page has to be stored as well
+        mem.write(0x1000, 0, 0x1000);
+        mem.write(0x40010, 0xdd, 16);
+        mem.write(0x80000, 0xee, 0x1000);
+        mem.checkpoint(delta);
+        EXPECT_TRUE(fileSize(delta + store) != 0);
+        if (level != 0)
+            EXPECT_TRUE(fileSize(delta + store) < fileSize(base + store));
+
+        setCase(csprintf("Restore base, level %d", level));
+        TestStore restored_base(clk_domain, level);
+        restored_base.restore(base);
+        EXPECT_EQ(memcmp(restored_base.contents(), base_contents.data(),
+                         memSize), 0);
+
+        setCase(csprintf("Restore delta, level %d", level));
+        TestStore restored_delta(clk_domain, level);
+        restored_delta.restore(delta);
+        EXPECT_EQ(memcmp(restored_delta.contents(), mem.contents(),
+                         memSize), 0);
+
+        setCase(csprintf("Delta of a restored delta, level %d", level));
+        // the next delta is relative to the checkpoint restored from
+        restored_delta.write(0xc0000, 0x11, 64);
+        restored_delta.checkpoint(delta2);
+        TestStore restored_delta2(clk_domain, level);
+        restored_delta2.restore(delta2);
+        EXPECT_EQ(memcmp(restored_delta2.contents(),
+                         restored_delta.contents(), memSize), 0);
+    }
+
+    setCase("Cleanup");
+    for (const auto &cpt : checkpoints) {
+        EXPECT_EQ(unlink((cpt + store).c_str()), 0);
+        EXPECT_EQ(unlink((cpt + "/" + CheckpointIn::baseFilename).c_str()),
+                  0);
+        EXPECT_EQ(rmdir(cpt.c_str()), 0);
+    }
+    EXPECT_EQ(rmdir(dir.c_str()), 0);
+
+    return UnitTest::printResults();
+}
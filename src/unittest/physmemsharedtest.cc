@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Authors: agent
+ */
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "base/cprintf.hh"
+#include "mem/abstract_mem.hh"
+#include "mem/packet.hh"
+#include "mem/physical.hh"
+#include "mem/request.hh"
+#include "params/AbstractMemory.hh"
+#include "params/SrcClockDomain.hh"
+#include "params/VoltageDomain.hh"
+#include "sim/clock_domain.hh"
+#include "sim/eventq.hh"
+#include "sim/voltage_domain.hh"
+#include "unittest/unittest.hh"
+
+using namespace std;
+using UnitTest::setCase;
+
+namespace {
+
+const uint64_t memSize = 1024 * 1024;
+
+// A memory that does nothing but own a backing store
+class TestMemory : public AbstractMemory
+{
+  public:
+    TestMemory(const Params *p) : AbstractMemory(p) { }
+};
+
+ClockDomain *
+makeClockDomain()
+{
+    VoltageDomainParams *vd_params = new VoltageDomainParams;
+    vd_params->name = "voltage_domain";
+    vd_params->eventq_index = 0;
+    vd_params->voltage.push_back(1.0);
+
+    SrcClockDomainParams *cd_params = new SrcClockDomainParams;
+    cd_params->name = "clk_domain";
+    cd_params->eventq_index = 0;
+    cd_params->clock.push_back(1000);
+    cd_params->voltage_domain = vd_params->create();
+    cd_params->domain_id = -1;
+    cd_params->init_perf_level = 0;
+    return cd_params->create();
+}
+
+// Like all SimObjects, the memories live until the end of the test
+AbstractMemory *
+makeMemory(ClockDomain *clk_domain)
+{
+    AbstractMemoryParams *params = new AbstractMemoryParams;
+    params->name = "mem";
+    params->eventq_index = 0;
+    params->clk_domain = clk_domain;
+    params->default_p_state = Enums::UNDEFINED;
+    params->power_model = NULL;
+    params->range = AddrRange(0, memSize - 1);
+    params->null = false;
+    params->in_addr_map = true;
+    params->kvm_map = false;
+    params->conf_table_reported = false;
+    return new TestMemory(params);
+}
+
+// A physical memory with its backing store in a shared memory object
+class TestStore
+{
+  public:
+    TestStore(ClockDomain *clk_domain, const string &name, bool keep)
+        : physmem("physmem", vector<AbstractMemory*>{
+                      makeMemory(clk_domain) },
+                  false, false, name, keep, vector<int>(), Enums::gzip,
+                  8 * sysconf(_SC_PAGESIZE), 1, 1, false)
+    { }
+
+    void
+    write(Addr addr, uint8_t value, unsigned size)
+    {
+        vector<uint8_t> data(size, value);
+        Request req(addr, size, 0, 0);
+        Packet pkt(&req, MemCmd::WriteReq);
+        pkt.dataStatic(data.data());
+        physmem.functionalAccess(&pkt);
+    }
+
+    const uint8_t *
+    contents() const
+    {
+        return physmem.getBackingStore().front().pmem;
+    }
+
+  private:
+    PhysicalMemory physmem;
+};
+
+// Attach to a shared memory object as another process would, and
+// return a copy of what it holds, or nothing if it does not exist
+vector<uint8_t>
+attach(const string &name)
+{
+    vector<uint8_t> image;
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd == -1)
+        return image;
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void *addr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (addr != MAP_FAILED) {
+            image.assign((uint8_t *)addr, (uint8_t *)addr + st.st_size);
+            munmap(addr, st.st_size);
+        }
+    }
+    close(fd);
+    return image;
+}
+
+bool
+exists(const string &name)
+{
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd == -1)
+        return errno != ENOENT;
+    close(fd);
+    return true;
+}
+
+} // anonymous namespace
+
+int
+main()
+{
+    const string name = csprintf("/physmemsharedtest.%d", getpid());
+
+    // requests are stamped with the current tick
+    curEventQueue(getEventQueue(0));
+
+    ClockDomain *clk_domain = makeClockDomain();
+
+    {
+        setCase("Attach while running");
+        TestStore mem(clk_domain, name, false);
+        mem.write(0x1000, 0xaa, 0x2000);
+        mem.write(memSize - 8, 0xbb, 8);
+        vector<uint8_t> image = attach(name);
+        EXPECT_EQ(image.size(), memSize);
+        EXPECT_TRUE(image.size() == memSize &&
+                    memcmp(image.data(), mem.contents(), memSize) == 0);
+    }
+
+    setCase("Removed on exit");
+    EXPECT_FALSE(exists(name));
+
+    vector<uint8_t> kept;
+    {
+        setCase("Kept on exit");
+        TestStore mem(clk_domain, name, true);
+        mem.write(0x4000, 0xcc, 0x1000);
+        mem.write(0x80000, 0xdd, 64);
+        kept.assign(mem.contents(), mem.contents() + memSize);
+    }
+    vector<uint8_t> image = attach(name);
+    EXPECT_EQ(image, kept);
+    EXPECT_EQ(kept[0x4000], 0xcc);
+
+    {
+        setCase("Reattach starts out zeroed");
+        // a new run reusing the name does not see the old image
+        TestStore mem(clk_domain, name, false);
+        EXPECT_EQ(attach(name), vector<uint8_t>(memSize, 0));
+        EXPECT_EQ(vector<uint8_t>(mem.contents(), mem.contents() + memSize),
+                  vector<uint8_t>(memSize, 0));
+    }
+    EXPECT_FALSE(exists(name));
+
+    return UnitTest::printResults();
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Authors: agent
+ */
+
+#include <cstdlib>
+
+#include "mem/stack_dist_calc.hh"
+#include "unittest/unittest.hh"
+
+int
+main(int argc, char *argv[])
+{
+    UnitTest::setCase("Simple reuse");
+    {
+        StackDistCalc calc;
+
+        EXPECT_EQ(calc.calcStackDistAndUpdate(0x0).first,
+                  StackDistCalc::Infinity);
+        EXPECT_EQ(calc.calcStackDistAndUpdate(0x40).first,
+                  StackDistCalc::Infinity);
+        EXPECT_EQ(calc.calcStackDistAndUpdate(0x80).first,
+                  StackDistCalc::Infinity);
+        // two distinct addresses since the last access
+        EXPECT_EQ(calc.calcStackDistAndUpdate(0x0).first, 2);
+        // immediate reuse
+        EXPECT_EQ(calc.calcStackDistAndUpdate(0x0).first, 0);
+        EXPECT_EQ(calc.calcStackDistAndUpdate(0x40).first, 2);
+        EXPECT_EQ(calc.getStackSize(), 3);
+    }
+
+    UnitTest::setCase("Removal and marking");
+    {
+        StackDistCalc calc;
+
+        calc.calcStackDistAndUpdate(0x0);
+        calc.calcStackDistAndUpdate(0x40);
+        calc.calcStackDistAndUpdate(0x80);
+
+        // mark without modifying the stack
+        auto r = calc.calcStackDist(0x40, true);
+        EXPECT_EQ(r.first, 1);
+        EXPECT_FALSE(r.second);
+        EXPECT_TRUE(calc.calcStackDist(0x40, true).second);
+
+        // remove the marked entry
+        r = calc.calcStackDistAndUpdate(0x40, false);
+        EXPECT_EQ(r.first, 1);
+        EXPECT_TRUE(r.second);
+        EXPECT_EQ(calc.getStackSize(), 2);
+        EXPECT_EQ(calc.calcStackDist(0x40).first, StackDistCalc::Infinity);
+        EXPECT_EQ(calc.calcStackDist(0x0).first, 1);
+    }
+
+    UnitTest::setCase("Random accesses across tree compactions");
+    {
+        // the verification stack panics on any mismatch
+        StackDistCalc calc(true);
+
+        srand(1);
+        for (int i = 0; i < 20000; ++i)
+            calc.calcStackDistAndUpdate((rand() % 700) * 64);
+        EXPECT_EQ(calc.getStackSize(), 700);
+    }
+
+    return UnitTest::printResults();
+}
@@ -151,6 +151,7 @@ generic_configs = (
     'o3-timing-mp',
 
     'rubytest',
+    'rubytest-garnet',
     'memcheck',
     'memtest',
     'memtest-filter',
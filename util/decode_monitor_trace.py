@@ -0,0 +1,89 @@
+#!/usr/bin/env python
+
+# Copyright (c) 2026 agent
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# Authors: agent
+
+# This script is used to dump the ring buffer of transactions written
+# by a CommMonitor (see the trace_file parameter) to ASCII format.
+#
+# The ASCII trace format uses one line per record, oldest first, on
+# the format type,cmd,addr,size,master,tick,latency, where type is
+# req or resp, and the latency is only non-zero for responses. For
+# example:
+# req,1,128,64,0,4000,0
+# resp,2,128,64,0,9000,5000
+
+import struct
+import sys
+
+HEADER = struct.Struct("<8sIIQ")
+RECORD = struct.Struct("<QQQIHBB")
+
+def main():
+    if len(sys.argv) != 3:
+        print "Usage: ", sys.argv[0], " <ring buffer input> <ASCII output>"
+        exit(-1)
+
+    try:
+        trace = open(sys.argv[1], 'rb')
+    except IOError:
+        print "Failed to open ", sys.argv[1], " for reading"
+        exit(-1)
+
+    try:
+        ascii_out = open(sys.argv[2], 'w')
+    except IOError:
+        print "Failed to open ", sys.argv[2], " for writing"
+        exit(-1)
+
+    magic, record_size, capacity, written = \
+        HEADER.unpack(trace.read(HEADER.size))
+    if magic != "gem5cmr1" or record_size != RECORD.size:
+        print "Not a CommMonitor ring buffer: ", sys.argv[1]
+        exit(-1)
+
+    # once the buffer has wrapped, the oldest record is the one that
+    # is overwritten next
+    count = min(written, capacity)
+    first = written % capacity if written > capacity else 0
+
+    print "Reading %d of %d records" % (count, written)
+
+    for i in range(count):
+        trace.seek(HEADER.size + ((first + i) % capacity) * RECORD.size)
+        tick, addr, latency, size, master, cmd, is_resp = \
+            RECORD.unpack(trace.read(RECORD.size))
+        ascii_out.write("%s,%d,%d,%d,%d,%d,%d\n" %
+                        ("resp" if is_resp else "req", cmd, addr, size,
+                         master, tick, latency))
+
+    trace.close()
+    ascii_out.close()
+
+if __name__ == "__main__":
+    main()
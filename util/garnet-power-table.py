@@ -0,0 +1,224 @@
+#!/usr/bin/env python
+
+# Copyright (c) 2026 agent
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# Authors: agent
+
+# This script writes the per-event energy table of the inline power model
+# of garnet2.0 (src/mem/ruby/network/garnet2.0/NetworkPower.hh) for the
+# network configured in a config.ini. The energies are computed once by
+# DSENT, with the router and link models of the given DSENT
+# configuration files, e.g.:
+#
+#   util/garnet-power-table.py m5out/config.ini \
+#       ext/dsent/configs/router.cfg ext/dsent/configs/electrical-link.cfg \
+#       garnet-power.txt
+#
+# The config.ini can come from a short run of the configuration to be
+# studied. The table is then passed to gem5 with --garnet-power-table,
+# which reports the router and link power with every stats dump.
+#
+# This script assumes it is executed from the gem5 root.
+
+from ConfigParser import ConfigParser
+import os
+import re
+import sys
+import tempfile
+
+router_energies = [
+    ("buffer_write", "Energy>>Router:WriteBuffer"),
+    ("buffer_read", "Energy>>Router:ReadBuffer"),
+    ("sw_input_arbiter", "Energy>>Router:ArbitrateSwitch->ArbitrateStage1"),
+    ("sw_output_arbiter", "Energy>>Router:ArbitrateSwitch->ArbitrateStage2"),
+    ("crossbar", "Energy>>Router:TraverseCrossbar->Multicast1"),
+    ("clock", "Energy>>Router:DistributeClock"),
+    ("leakage", "NddPower>>Router:Leakage"),
+]
+
+link_energies = [
+    ("flit", "Energy>>RepeatedLink:Send"),
+    ("leakage", "NddPower>>RepeatedLink:Leakage"),
+]
+
+def compileDsent():
+    src_dir = 'ext/dsent'
+    build_dir = 'build/ext/dsent'
+
+    if not os.path.exists(build_dir):
+        os.makedirs(build_dir)
+    os.chdir(build_dir)
+
+    from subprocess import call
+    if call(['cmake', '../../../%s' % src_dir]) or call(['make']):
+        print("Failed to compile DSENT")
+        sys.exit(1)
+
+    os.chdir("../../../")
+    sys.path.append("build/ext/dsent")
+
+# Copy a DSENT configuration file, making it print the given energies and
+# overriding some of its parameters. Later keys replace earlier ones.
+def writeDsentConfig(config_file, energies, overrides):
+    (fd, name) = tempfile.mkstemp(prefix='garnet-power-', suffix='.cfg')
+    out = os.fdopen(fd, 'w')
+    out.write(open(config_file).read())
+    out.write("\n")
+    for key, value in overrides:
+        out.write("%s = %s\n" % (key, value))
+    out.write("EvaluateString = \\\n")
+    for key, query in energies:
+        out.write("    print \"%s\" $(%s); \\\n" % (key, query))
+    out.write("\n")
+    out.close()
+    return name
+
+def getTechVoltage(config_file):
+    tech_file = None
+    for line in open(config_file):
+        m = re.match(r'^\s*ElectricalTechModelFilename\s*=\s*(\S+)', line)
+        if m:
+            tech_file = m.group(1)
+    if tech_file is None:
+        print("ERROR: no technology model in '%s'" % config_file)
+        sys.exit(1)
+
+    for line in open(tech_file):
+        m = re.match(r'^\s*Vdd\s*=\s*(\S+)', line)
+        if m:
+            return float(m.group(1))
+
+    print("ERROR: no Vdd in '%s'" % tech_file)
+    sys.exit(1)
+
+def getClock(obj, config):
+    if config.get(obj, "type") == "SrcClockDomain":
+        return config.getint(obj, "clock")
+
+    if config.get(obj, "type") == "DerivedClockDomain":
+        source = config.get(obj, "clk_domain")
+        divider = config.getint(obj, "clk_divider")
+        return getClock(source, config)  / divider
+
+    source = config.get(obj, "clk_domain")
+    return getClock(source, config)
+
+# The clock periods in config.ini are in ticks of 1ps
+def getFrequency(obj, config):
+    return int(1e12 / getClock(obj, config))
+
+def main():
+    if len(sys.argv) != 5:
+        print("Usage: %s <config.ini> <router config file> "
+              "<link config file> <output table>" % sys.argv[0])
+        sys.exit(1)
+
+    (config_file, router_config, link_config, table_file) = sys.argv[1:]
+
+    config = ConfigParser()
+    if not config.read(config_file):
+        print("ERROR: config file '%s' not found" % config_file)
+        sys.exit(1)
+
+    network = "system.ruby.network"
+    if not config.has_section(network) or \
+       config.get(network, "type") != "GarnetNetwork":
+        print("ERROR: garnet2.0 network not used in '%s'" % config_file)
+        sys.exit(1)
+
+    num_vnets = config.getint(network, "number_of_virtual_networks")
+    vcs_per_vnet = config.getint(network, "vcs_per_vnet")
+    buffers_per_vc = config.getint(network, "buffers_per_data_vc")
+    flit_size_bits = 8 * config.getint(network, "ni_flit_size")
+
+    routers = config.get(network, "routers").split()
+    int_links = config.get(network, "int_links").split()
+    ext_links = config.get(network, "ext_links").split()
+
+    # Every internal link is an outport of its source and an inport of its
+    # destination, every external link both for its router
+    ports = dict((router, [0, 0]) for router in routers)
+    for link in int_links:
+        ports[config.get(link, "src_node")][1] += 1
+        ports[config.get(link, "dst_node")][0] += 1
+    for link in ext_links:
+        ports[config.get(link, "int_node")][0] += 1
+        ports[config.get(link, "int_node")][1] += 1
+
+    compileDsent()
+    import dsent
+
+    voltage = getTechVoltage(router_config)
+    if getTechVoltage(link_config) != voltage:
+        print("ERROR: the router and link models use different voltages")
+        sys.exit(1)
+
+    table = open(table_file, 'w')
+    table.write("# garnet2.0 energies computed by DSENT for %s\n" %
+                config_file)
+    table.write("voltage %g\n" % voltage)
+
+    # Routers with the same ports share their energies, computed at the
+    # frequency of the first of them
+    dsent_config = writeDsentConfig(router_config, router_energies, [])
+    dsent.initialize(dsent_config)
+    done = set()
+    for router in routers:
+        (inports, outports) = ports[router]
+        if (inports, outports) in done:
+            continue
+        done.add((inports, outports))
+
+        outputs = dict(dsent.computeRouterPowerAndArea(
+            getFrequency(router, config), inports, outports, num_vnets,
+            vcs_per_vnet, buffers_per_vc, flit_size_bits))
+        table.write("router %d %d %s\n" % (inports, outports,
+            " ".join("%s=%g" % (key, outputs[key])
+                     for key, query in router_energies)))
+    dsent.finalize()
+    os.remove(dsent_config)
+
+    # All links are assumed to be alike, as in their garnet2.0 model
+    link = (int_links + ext_links)[0]
+    if link in int_links:
+        link_obj = link + ".network_link"
+    else:
+        link_obj = link + ".network_links0"
+
+    dsent_config = writeDsentConfig(link_config, link_energies,
+                                    [("NumberBits", flit_size_bits)])
+    dsent.initialize(dsent_config)
+    outputs = dict(dsent.computeLinkPower(getFrequency(link_obj, config)))
+    table.write("link %s\n" % " ".join("%s=%g" % (key, outputs[key])
+                                        for key, query in link_energies))
+    dsent.finalize()
+    os.remove(dsent_config)
+
+    table.close()
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,144 @@
+#!/usr/bin/env python
+
+# Copyright (c) 2026 agent
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# Authors: agent
+
+# This script measures the host throughput of the garnet2.0 network on
+# its own, using the synthetic traffic generator
+# (configs/example/garnet_synth_traffic.py) on a mesh. For every
+# injection rate it runs each gem5 binary given on the command line a
+# number of times and reports the median host time, e.g.:
+#
+#   util/garnet-synth-bench.py -r 8 -i 0.02,0.1,0.3 \
+#       build/Garnet_standalone/gem5.opt.base \
+#       build/Garnet_standalone/gem5.opt
+#
+# The number of packets received is checked to match across binaries so
+# that only identical simulated work is compared. Other networks can be
+# measured with --network, e.g. the analytical one, whose average packet
+# latency can then be compared against garnet's.
+
+import optparse
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+
+parser = optparse.OptionParser(usage="%prog [options] <gem5 binary>...")
+
+parser.add_option('-c', '--count', type='int', default=3,
+                  help="Number of runs per binary and injection rate")
+parser.add_option('-r', '--mesh-rows', type='int', default=8,
+                  help="Rows of the (square) mesh")
+parser.add_option('-i', '--injection-rates', default="0.02,0.1,0.3",
+                  help="Comma separated injection rates "
+                  "(packets/node/cycle)")
+parser.add_option('-s', '--sim-cycles', type='int', default=100000,
+                  help="Cycles to simulate per run")
+parser.add_option('-n', '--network', default="garnet2.0",
+                  help="Network model, as for garnet_synth_traffic.py")
+parser.add_option('--synthetic', default="uniform_random",
+                  help="Traffic pattern")
+parser.add_option('-a', '--args', default="",
+                  help="Extra arguments passed to garnet_synth_traffic.py")
+
+(options, args) = parser.parse_args()
+
+if len(args) < 1:
+    print "Error: Expecting at least one gem5 binary"
+    sys.exit(1)
+
+script = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                      os.pardir, 'configs', 'example',
+                      'garnet_synth_traffic.py')
+
+def read_stats(stats_file):
+    stats = {}
+    for line in open(stats_file):
+        m = re.match(r'^(host_seconds|sim_ticks|'
+                     r'system\.ruby\.network\.packets_received'
+                     r'(?:::total)?|'
+                     r'system\.ruby\.network\.average_packet_latency)'
+                     r'\s+(\S+)', line)
+        if m:
+            stats[m.group(1).split('.')[-1].replace('::total', '')] = \
+                float(m.group(2))
+    return stats
+
+def median(values):
+    values = sorted(values)
+    return values[len(values) / 2]
+
+nodes = options.mesh_rows * options.mesh_rows
+
+print "%-8s %-50s %12s %12s %12s %8s" % ("rate", "binary", "host_seconds",
+                                         "packets", "latency", "speedup")
+
+for rate in [float(r) for r in options.injection_rates.split(',')]:
+    results = []
+    packets = None
+
+    for binary in args:
+        host_seconds = []
+        for i in range(options.count):
+            outdir = tempfile.mkdtemp(prefix='garnet-bench-')
+            cmd = [binary, '-d', outdir, script,
+                   '--network=%s' % options.network, '--topology=Mesh_XY',
+                   '--mesh-rows=%d' % options.mesh_rows,
+                   '--num-cpus=%d' % nodes, '--num-dirs=%d' % nodes,
+                   '--synthetic=%s' % options.synthetic,
+                   '--injectionrate=%f' % rate,
+                   '--sim-cycles=%d' % options.sim_cycles] + \
+                  options.args.split()
+            with open(os.devnull, 'w') as devnull:
+                status = subprocess.call(cmd, stdout=devnull, stderr=devnull)
+            if status != 0:
+                print "Error: %s failed, output kept in %s" % (binary, outdir)
+                sys.exit(1)
+
+            stats = read_stats(os.path.join(outdir, 'stats.txt'))
+            shutil.rmtree(outdir)
+
+            received = stats.get('packets_received', 0)
+            if packets is None:
+                packets = received
+            elif received != packets:
+                print "Warning: %s received %d packets, expected %d" % \
+                    (binary, received, packets)
+
+            host_seconds.append(stats['host_seconds'])
+            latency = stats.get('average_packet_latency', 0)
+
+        results.append((binary, median(host_seconds), latency))
+
+    for binary, seconds, latency in results:
+        print "%-8.3f %-50s %12.2f %12d %12.1f %8.2f" % \
+            (rate, binary, seconds, packets, latency,
+             results[0][1] / seconds)
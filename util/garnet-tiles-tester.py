@@ -0,0 +1,129 @@
+#!/usr/bin/env python
+
+# Copyright (c) 2026 agent
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# Authors: agent
+
+# Test script for the tiled garnet2.0 network.
+#
+# Given a gem5 binary, this script runs the synthetic traffic generator
+# (configs/example/garnet_synth_traffic.py) on a mesh, once with the
+# whole network on one event queue and once split into tiles on
+# separate event queues, and diffs the stats of the two runs. Apart
+# from the host statistics they are expected to be identical, e.g.:
+#
+#   util/garnet-tiles-tester.py -t 4 build/Garnet_standalone/gem5.opt
+#
+# The script exits with a non-zero status if the stats differ.
+
+import optparse
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+parser = optparse.OptionParser(usage="%prog [options] <gem5 binary>")
+
+parser.add_option('-t', '--tiles', type='int', default=4,
+                  help="Number of tiles of the parallel run")
+parser.add_option('-r', '--mesh-rows', type='int', default=8,
+                  help="Rows of the (square) mesh")
+parser.add_option('-i', '--injection-rate', type='float', default=0.1,
+                  help="Injection rate (packets/node/cycle)")
+parser.add_option('-s', '--sim-cycles', type='int', default=20000,
+                  help="Cycles to simulate")
+parser.add_option('--synthetic', default="uniform_random",
+                  help="Traffic pattern")
+parser.add_option('-a', '--args', default="",
+                  help="Extra arguments passed to garnet_synth_traffic.py")
+
+(options, args) = parser.parse_args()
+
+if len(args) != 1:
+    print "Error: Expecting a gem5 binary"
+    sys.exit(1)
+
+script = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                      os.pardir, 'configs', 'example',
+                      'garnet_synth_traffic.py')
+
+def read_stats(stats_file):
+    stats = []
+    for line in open(stats_file):
+        fields = line.split()
+        if len(fields) < 2 or fields[0].startswith('host_'):
+            continue
+        stats.append((fields[0], fields[1]))
+    return stats
+
+def run(tiles):
+    outdir = tempfile.mkdtemp(prefix='garnet-tiles-')
+    nodes = options.mesh_rows * options.mesh_rows
+    cmd = [args[0], '-d', outdir, script,
+           '--network=garnet2.0', '--topology=Mesh_XY',
+           '--mesh-rows=%d' % options.mesh_rows,
+           '--num-cpus=%d' % nodes, '--num-dirs=%d' % nodes,
+           '--synthetic=%s' % options.synthetic,
+           '--injectionrate=%f' % options.injection_rate,
+           '--sim-cycles=%d' % options.sim_cycles,
+           '--garnet-tiles=%d' % tiles] + options.args.split()
+    with open(os.devnull, 'w') as devnull:
+        status = subprocess.call(cmd, stdout=devnull, stderr=devnull)
+    if status != 0:
+        print "Error: run with %d tile(s) failed, output kept in %s" % \
+            (tiles, outdir)
+        sys.exit(1)
+
+    stats = read_stats(os.path.join(outdir, 'stats.txt'))
+    shutil.rmtree(outdir)
+    return stats
+
+serial = run(1)
+tiled = run(options.tiles)
+
+if not serial:
+    print "Error: the serial run dumped no stats"
+    sys.exit(1)
+
+differences = 0
+for (name, value), (tiled_name, tiled_value) in zip(serial, tiled):
+    if name != tiled_name or value != tiled_value:
+        print "%s %s != %s %s" % (name, value, tiled_name, tiled_value)
+        differences += 1
+
+if len(serial) != len(tiled):
+    print "Serial run dumped %d stats, tiled run %d" % \
+        (len(serial), len(tiled))
+    differences += 1
+
+if differences:
+    print "FAILED: %d stats differ with %d tiles" % \
+        (differences, options.tiles)
+    sys.exit(1)
+
+print "PASSED: %d stats match with %d tiles" % (len(serial), options.tiles)
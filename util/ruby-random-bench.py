@@ -0,0 +1,129 @@
+#!/usr/bin/env python
+
+# Copyright (c) 2026 agent
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# Authors: agent
+
+# This script measures the host throughput of the Ruby random tester
+# (configs/example/ruby_random_test.py). It runs the tester a number
+# of times for each gem5 binary given on the command line and reports
+# the median host time and tick rate, which makes it easy to compare
+# a change to the Ruby memory system against a baseline build, e.g.:
+#
+#   util/ruby-random-bench.py build/X86_MESI_Two_Level/gem5.opt.base \
+#                             build/X86_MESI_Two_Level/gem5.opt
+#
+# All binaries are expected to be built for the same protocol so that
+# the simulated work is identical; the simulated ticks are checked to
+# match across runs.
+#
+# The same approach compares the two transition dispatch flavours SLICC
+# can generate (the SLICC_DISPATCH build option), e.g. for MOESI_hammer:
+#
+#   scons build/X86_MOESI_hammer/gem5.opt SLICC_DISPATCH=switch
+#   cp build/X86_MOESI_hammer/gem5.opt build/X86_MOESI_hammer/gem5.switch
+#   scons build/X86_MOESI_hammer/gem5.opt SLICC_DISPATCH=table
+#   util/ruby-random-bench.py build/X86_MOESI_hammer/gem5.switch \
+#                             build/X86_MOESI_hammer/gem5.opt
+
+import optparse
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+
+parser = optparse.OptionParser(usage="%prog [options] <gem5 binary>...")
+
+parser.add_option('-c', '--count', type='int', default=5,
+                  help="Number of runs per binary")
+parser.add_option('-l', '--maxloads', type='int', default=100000,
+                  help="Loads per tester CPU before the run ends")
+parser.add_option('-n', '--num-cpus', type='int', default=8,
+                  help="Number of tester CPUs")
+parser.add_option('-a', '--args', default="",
+                  help="Extra arguments passed to ruby_random_test.py")
+
+(options, args) = parser.parse_args()
+
+if len(args) < 1:
+    print "Error: Expecting at least one gem5 binary"
+    sys.exit(1)
+
+script = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                      os.pardir, 'configs', 'example', 'ruby_random_test.py')
+
+def read_stats(stats_file):
+    stats = {}
+    for line in open(stats_file):
+        m = re.match(r'^(host_seconds|host_tick_rate|sim_ticks)\s+(\S+)',
+                     line)
+        if m:
+            stats[m.group(1)] = float(m.group(2))
+    return stats
+
+def median(values):
+    values = sorted(values)
+    return values[len(values) / 2]
+
+results = []
+sim_ticks = None
+
+for binary in args:
+    host_seconds = []
+    tick_rates = []
+    for i in range(options.count):
+        outdir = tempfile.mkdtemp(prefix='ruby-bench-')
+        cmd = [binary, '-d', outdir, script,
+               '--maxloads=%d' % options.maxloads,
+               '--num-cpus=%d' % options.num_cpus] + options.args.split()
+        with open(os.devnull, 'w') as devnull:
+            status = subprocess.call(cmd, stdout=devnull, stderr=devnull)
+        if status != 0:
+            print "Error: %s failed, output kept in %s" % (binary, outdir)
+            sys.exit(1)
+
+        stats = read_stats(os.path.join(outdir, 'stats.txt'))
+        shutil.rmtree(outdir)
+
+        if sim_ticks is None:
+            sim_ticks = stats['sim_ticks']
+        elif stats['sim_ticks'] != sim_ticks:
+            print "Warning: %s simulated %d ticks, expected %d" % \
+                (binary, stats['sim_ticks'], sim_ticks)
+
+        host_seconds.append(stats['host_seconds'])
+        tick_rates.append(stats['host_tick_rate'])
+
+    results.append((binary, median(host_seconds), median(tick_rates)))
+
+print "%-50s %12s %16s %8s" % ("binary", "host_seconds", "host_tick_rate",
+                               "speedup")
+for binary, seconds, rate in results:
+    print "%-50s %12.2f %16.0f %8.2f" % (binary, seconds, rate,
+                                         results[0][1] / seconds)
@@ -0,0 +1,126 @@
+#!/usr/bin/env python
+
+# Copyright (c) 2026 agent
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# Authors: agent
+
+# This script measures how long it takes gem5 to build the ruby network
+# for large topologies, and how much memory that needs. Each run
+# simulates only a handful of cycles with the synthetic traffic generator
+# (configs/example/garnet_synth_traffic.py), so the host time and peak
+# resident set size are dominated by startup, which includes computing
+# the routing tables in Topology::createLinks(), e.g.:
+#
+#   util/ruby-topology-bench.py -m 8,16,32 -f 64,256,1024 \
+#       build/Garnet_standalone/gem5.opt.base \
+#       build/Garnet_standalone/gem5.opt
+
+import optparse
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+parser = optparse.OptionParser(usage="%prog [options] <gem5 binary>...")
+
+parser.add_option('-c', '--count', type='int', default=3,
+                  help="Number of runs per binary and topology")
+parser.add_option('-m', '--mesh-rows', default="8,16,32",
+                  help="Comma separated rows of the (square) meshes")
+parser.add_option('-f', '--fat-tree-leaves', default="64,256,1024",
+                  help="Comma separated leaf counts of the fat trees")
+parser.add_option('-s', '--sim-cycles', type='int', default=10,
+                  help="Cycles to simulate per run")
+parser.add_option('-a', '--args', default="",
+                  help="Extra arguments passed to garnet_synth_traffic.py")
+
+(options, args) = parser.parse_args()
+
+if len(args) < 1:
+    print "Error: Expecting at least one gem5 binary"
+    sys.exit(1)
+
+script = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                      os.pardir, 'configs', 'example',
+                      'garnet_synth_traffic.py')
+
+def median(values):
+    values = sorted(values)
+    return values[len(values) / 2]
+
+def run(binary, topology_args, nodes):
+    outdir = tempfile.mkdtemp(prefix='topology-bench-')
+    cmd = [binary, '-d', outdir, script, '--network=garnet2.0',
+           '--num-cpus=%d' % nodes, '--num-dirs=%d' % nodes,
+           '--injectionrate=0.01',
+           '--sim-cycles=%d' % options.sim_cycles] + \
+          topology_args + options.args.split()
+
+    # wait4() returns the resource usage of this run alone, the peak
+    # resident set size is in kB on Linux
+    start = time.time()
+    with open(os.devnull, 'w') as devnull:
+        proc = subprocess.Popen(cmd, stdout=devnull, stderr=devnull)
+        pid, status, rusage = os.wait4(proc.pid, 0)
+    seconds = time.time() - start
+    maxrss = rusage.ru_maxrss
+
+    if status != 0:
+        print "Error: %s failed, output kept in %s" % (binary, outdir)
+        sys.exit(1)
+    shutil.rmtree(outdir)
+
+    return seconds, maxrss
+
+topologies = []
+for rows in [int(r) for r in options.mesh_rows.split(',') if r]:
+    topologies.append(("Mesh_XY %dx%d" % (rows, rows), rows * rows,
+                       ['--topology=Mesh_XY', '--mesh-rows=%d' % rows]))
+for leaves in [int(l) for l in options.fat_tree_leaves.split(',') if l]:
+    topologies.append(("FatTree %d" % leaves, leaves,
+                       ['--topology=FatTree']))
+
+print "%-16s %-50s %12s %12s %8s" % ("topology", "binary", "host_seconds",
+                                     "maxrss_kB", "speedup")
+
+for name, nodes, topology_args in topologies:
+    results = []
+    for binary in args:
+        host_seconds = []
+        maxrss = 0
+        for i in range(options.count):
+            seconds, rss = run(binary, topology_args, nodes)
+            host_seconds.append(seconds)
+            maxrss = max(maxrss, rss)
+        results.append((binary, median(host_seconds), maxrss))
+
+    for binary, seconds, maxrss in results:
+        print "%-16s %-50s %12.2f %12d %8.2f" % (name, binary, seconds,
+                                                 maxrss,
+                                                 results[0][1] / seconds)